@@ -26,6 +26,10 @@
 #include <brisk/core/internal/SmallVector.hpp>
 #include <brisk/core/Log.hpp>
 #include <brisk/core/Threading.hpp>
+#include <array>
+#include <map>
+#include <set>
+#include <unordered_map>
 
 namespace Brisk {
 
@@ -933,12 +937,45 @@ public:
     /**
      * @brief Notify that the variable has changed
      * This triggers update of all dependant values.
+     * Inside a CoalesceScope the notification is postponed until the scope ends.
      *
      * @param range address range
      * @return int Number of handlers called
      */
     int notifyRange(BindingAddress range);
 
+    /**
+     * @brief Notify that the variable has changed, bypassing any CoalesceScope.
+     * Used by triggers, whose argument is only valid during the call.
+     * @return int Number of handlers called
+     */
+    template <typename T>
+    int notifyImmediately(T* variable) {
+        return dispatchRange(toBindingAddress(variable));
+    }
+
+    /**
+     * @brief Collects notifications made on the current thread while alive.
+     *
+     * Each distinct address range is notified once, in order of first notification, when the
+     * outermost scope ends. Many writes to the same property within a frame then cost one handler
+     * invocation. Scopes may be nested; only the outermost one dispatches.
+     */
+    class CoalesceScope {
+    public:
+        CoalesceScope();
+        ~CoalesceScope();
+
+        CoalesceScope(const CoalesceScope&)            = delete;
+        CoalesceScope& operator=(const CoalesceScope&) = delete;
+
+    private:
+        friend class Bindings;
+        bool m_outermost;
+        std::vector<BindingAddress> m_pending;
+        std::set<std::pair<const uint8_t*, const uint8_t*>> m_seen;
+    };
+
     /**
      * @brief Notify that the variable has changed.
      * This triggers update of all dependant values.
@@ -1143,42 +1180,66 @@ private:
 
     void removeIndirectDependencies(Region* region);
 
+    int dispatchRange(BindingAddress range);
+
+    void insertEntry(Region& region, Entry entry);
+
+    void killEntry(Region& region, Entry& entry, bool updateConnections);
+
+    void compact(Region& region);
+
+    template <typename Pred>
+    void eraseEntries(Region& region, Pred&& pred);
+
+    // Filter over source addresses with handlers, checked without locking by notifyRange
+    constexpr static size_t filterSize    = 4096;
+    constexpr static size_t filterGranule = 16;
+    constexpr static size_t filterMaxSpan = 64; // Ranges spanning more granules bypass the filter
+
+    static size_t filterSlot(uintptr_t granule) noexcept {
+        return (granule ^ (granule >> 12)) & (filterSize - 1);
+    }
+
+    void updateFilter(BindingAddress address, int delta) noexcept;
+    bool mayHaveHandlers(BindingAddress range) const noexcept;
+
     bool isRegisteredRegion(BindingAddress region) const;
 
     bool isFullyWithinRegion(BindingAddress region) const;
 
     struct Entry {
+        BindingAddress srcAddress;
         uint64_t id;
-        Handler handler;
+        RC<const Handler> handler; // Shared so that it outlives the entry while being called; null if dead
         Region* destRegion;
         BindingAddress destAddress;
         BindType type;
         std::string_view destDesc;
         std::string_view srcDesc;
         RC<Scheduler> srcQueue;
-        uint32_t counter;
-    };
-
-    struct BindingAddressCmp {
-        bool operator()(BindingAddress lh, BindingAddress rh) const noexcept {
-            return lh.min < rh.min;
-        }
+        uint32_t counter = 0;
     };
 
     struct Region {
         Region(BindingAddress region, RC<Scheduler> queue) : region(region), queue(std::move(queue)) {}
 
         BindingAddress region;
-        std::multimap<BindingAddress, Entry, BindingAddressCmp> entries;
-        bool entriesChanged = false;
+        std::vector<Entry> entries; // Sorted by source address, then by connection id
+        uint32_t deadEntries = 0;
+        bool entriesChanged  = false;
         RC<Scheduler> queue;
-
-        void disconnectIf(std::function<bool(const std::pair<BindingAddress, Entry>&)> pred);
+        // Regions holding handlers that write into this region, with the number of such handlers
+        SmallVector<std::pair<Region*, uint32_t>, 1> writers;
     };
 
     uint32_t m_counter = 0;
     std::map<const uint8_t*, RC<Region>> m_regions;
+    // Regions holding the handlers of each connection
+    std::unordered_map<uint64_t, SmallVector<std::pair<Region*, const uint8_t*>, 2>> m_connections;
     std::vector<uint64_t> m_stack;
+    size_t m_numHandlers = 0;
+    std::array<std::atomic_uint32_t, filterSize> m_filter{};
+    std::atomic_uint32_t m_wideSources{ 0 };
 
     bool inStack(uint64_t id);
 };
@@ -1188,7 +1249,7 @@ extern AutoSingleton<Bindings> bindings;
 template <typename... Args>
 inline int Trigger<Args...>::trigger(Args... args) {
     this->arg          = Type{ std::move(args)... };
-    int handlersCalled = bindings->notify(this);
+    int handlersCalled = bindings->notifyImmediately(this);
     this->arg          = std::nullopt;
     return handlersCalled;
 }
@@ -1562,8 +1623,10 @@ public:
         return std::static_pointer_cast<const Derived>(Base::shared_from_this());
     }
 
+    using SharedAllocator = ArenaAllocator<std::byte>;
+
     static void* operator new(size_t sz) {
-        void* ptr = alignedAlloc(sz, cacheAlignment);
+        void* ptr = MemoryArena::allocate(sz, cacheAlignment);
         RC<Scheduler> sched;
         BRISK_CLANG_PRAGMA(GCC diagnostic push)
         BRISK_CLANG_PRAGMA(GCC diagnostic ignored "-Wpointer-bool-conversion")
@@ -1577,9 +1640,9 @@ public:
         return ptr;
     }
 
-    static void operator delete(void* ptr) {
+    static void operator delete(void* ptr, size_t sz) {
         bindings->unregisterRegion(reinterpret_cast<uint8_t*>(ptr));
-        alignedFree(ptr);
+        MemoryArena::deallocate(ptr, sz);
     }
 
 protected:
@@ -266,6 +266,54 @@ using u8strings = std::vector<string>;
  */
 [[nodiscard]] expected<bytes, IOError> readBytes(const fs::path& file_name);
 
+/**
+ * @class MappedFile
+ * @brief Read-only memory mapping of a file.
+ *
+ * The mapped contents remain valid for the lifetime of the object.
+ * Pages are loaded on demand by the operating system and are shared
+ * between all users of the same mapping, which makes this class
+ * suitable for large files that are accessed sparsely.
+ */
+class MappedFile {
+public:
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    /**
+     * @brief Returns the mapped file contents.
+     */
+    bytes_view data() const noexcept {
+        return { m_data, m_size };
+    }
+
+    /**
+     * @brief Returns the size of the mapped file in bytes.
+     */
+    size_t size() const noexcept {
+        return m_size;
+    }
+
+private:
+    friend expected<RC<MappedFile>, IOError> mapFile(const fs::path& file_name);
+    MappedFile() noexcept = default;
+    const uint8_t* m_data = nullptr;
+    size_t m_size         = 0;
+};
+
+/**
+ * @brief Maps the entire file into memory for reading.
+ *
+ * Unlike `readBytes`, this function doesn't copy the file contents,
+ * the returned object references pages managed by the operating system.
+ *
+ * @param file_name The path to the file to be mapped.
+ * @return An `expected` object containing the mapped file if the
+ *         operation is successful, or an I/O error if it fails.
+ */
+[[nodiscard]] expected<RC<MappedFile>, IOError> mapFile(const fs::path& file_name);
+
 /**
  * @brief Reads the entire file as a UTF-8 encoded string.
  *
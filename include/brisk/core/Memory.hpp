@@ -21,6 +21,7 @@
 #pragma once
 
 #include "Brisk.h"
+#include <cstddef>
 #include <cstdlib>
 #include <new>
 #include <algorithm>
@@ -177,4 +178,126 @@ struct AlignedAllocation {
     }
 #endif
 };
+/**
+ * @brief Slab allocator for large numbers of small objects that are built and destroyed together.
+ *
+ * Blocks are carved out of large chunks and recycled through per-size free lists, so building and
+ * tearing down a big widget tree does not hit the general-purpose allocator for every object.
+ * Classes opt in by deriving from `ArenaAllocation` (or, for `BindingObject`, automatically); their
+ * instances are placed in the arena that is current on the allocating thread (see `Scope`) and
+ * on the heap otherwise.
+ *
+ * Blocks may outlive the arena object: the chunks are released once the arena has been destroyed
+ * and the last of its blocks has been freed. Freeing is thread-safe.
+ */
+class MemoryArena {
+public:
+    /// Minimum alignment of blocks allocated in an arena
+    constexpr static size_t alignment    = 16;
+    /// Blocks that must be aligned more strictly always go to the heap
+    constexpr static size_t maxAlignment = cacheAlignment;
+    /// Larger allocations always go to the heap
+    constexpr static size_t maxBlockSize = 4096;
+
+    explicit MemoryArena(size_t chunkSize = 256 * 1024);
+    ~MemoryArena();
+
+    MemoryArena(const MemoryArena&)            = delete;
+    MemoryArena& operator=(const MemoryArena&) = delete;
+
+    struct Statistics {
+        size_t chunks        = 0; ///< Number of chunks allocated
+        size_t bytesReserved = 0; ///< Total size of the chunks
+        size_t liveBlocks    = 0; ///< Blocks allocated and not yet freed
+    };
+
+    Statistics statistics() const;
+
+    /**
+     * @brief Allocates memory from the current arena, or from the heap if there is none.
+     *
+     * @param size Size of the block in bytes.
+     * @param blockAlignment Alignment of the block, a power of two.
+     * @return Pointer to the block. Must be freed with `deallocate` passing the same size.
+     */
+    [[nodiscard]] static void* allocate(size_t size, size_t blockAlignment = defaultMemoryAlignment);
+
+    /**
+     * @brief Frees a block returned by `allocate`.
+     *
+     * @param ptr Pointer to the block.
+     * @param size The size passed to `allocate`.
+     */
+    static void deallocate(void* ptr, size_t size) noexcept;
+
+    /// Returns the arena used for allocations on the calling thread, or nullptr
+    static MemoryArena* current() noexcept;
+
+    /**
+     * @brief Makes an arena current on the calling thread for the lifetime of the scope.
+     *
+     * Passing nullptr makes allocations inside the scope go to the heap. Scopes can be nested.
+     */
+    class Scope {
+    public:
+        explicit Scope(MemoryArena* arena) noexcept;
+        ~Scope();
+
+        Scope(const Scope&)            = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        MemoryArena* m_saved;
+    };
+
+    struct State;
+
+private:
+    State* m_state;
+};
+
+/**
+ * @brief Standard allocator that allocates from the current `MemoryArena`.
+ *
+ * Used for the control blocks of shared pointers to arena-allocated objects.
+ */
+template <typename T>
+struct ArenaAllocator {
+    using value_type = T;
+
+    ArenaAllocator() noexcept = default;
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>&) noexcept {}
+
+    [[nodiscard]] T* allocate(size_t n) {
+        return static_cast<T*>(MemoryArena::allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        MemoryArena::deallocate(ptr, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>&) const noexcept {
+        return true;
+    }
+};
+
+/**
+ * @brief Provides `new` and `delete` operators that allocate from the current `MemoryArena`.
+ *
+ * `rcnew` also allocates the shared pointer control block of such objects from the arena.
+ */
+struct ArenaAllocation {
+    using SharedAllocator = ArenaAllocator<std::byte>;
+
+    static void* operator new(size_t size) {
+        return MemoryArena::allocate(size);
+    }
+
+    static void operator delete(void* ptr, size_t size) noexcept {
+        MemoryArena::deallocate(ptr, size);
+    }
+};
 } // namespace Brisk
@@ -46,7 +46,12 @@ namespace Internal {
 struct RCNew {
     template <typename T>
     RC<T> operator*(T* rawPtr) const {
-        return RC<T>(rawPtr);
+        if constexpr (requires { typename T::SharedAllocator; }) {
+            // Keep the control block next to the object, e.g. in a MemoryArena
+            return RC<T>(rawPtr, std::default_delete<T>{}, typename T::SharedAllocator{});
+        } else {
+            return RC<T>(rawPtr);
+        }
     }
 };
 
@@ -420,6 +420,66 @@ enum class ThreadPriority {
  */
 void setThreadPriority(ThreadPriority priority);
 
+/**
+ * @brief Fixed-size pool of worker threads for fork-join parallelism and background tasks.
+ *
+ * Unlike `async`, the pool doesn't depend on the main loop and may be used from any thread.
+ * A pool with zero threads runs all work on the calling thread.
+ */
+class WorkerPool {
+public:
+    /**
+     * @brief Starts the worker threads.
+     *
+     * @param numThreads Number of threads in addition to the calling thread.
+     */
+    explicit WorkerPool(size_t numThreads);
+
+    /**
+     * @brief Stops the worker threads. Must not be called while parallelFor is running.
+     */
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&)            = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * @brief Returns the number of worker threads.
+     */
+    size_t threadCount() const noexcept;
+
+    /**
+     * @brief Calls fn(i) for each i in [0, count) and waits for all calls to finish.
+     *
+     * The calling thread takes part in the work, so parallelFor may be called from
+     * within another parallelFor. The first exception thrown by fn is rethrown
+     * after all calls have finished.
+     *
+     * @param count Number of calls.
+     * @param fn Function to call. Calls may run concurrently and in any order.
+     */
+    void parallelFor(size_t count, const function<void(size_t)>& fn);
+
+    /**
+     * @brief Queues fn to run on one of the worker threads and returns immediately.
+     *
+     * Exceptions thrown by fn are logged and suppressed. Tasks that haven't started when the
+     * pool is destroyed are discarded. A pool with zero threads calls fn before returning.
+     *
+     * @param fn Function to call.
+     */
+    void submit(VoidFunc fn);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+/**
+ * @brief Returns the shared worker pool, sized to the number of hardware threads.
+ */
+WorkerPool& workerPool();
+
 namespace Internal {
 
 template <typename T>
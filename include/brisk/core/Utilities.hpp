@@ -894,6 +894,61 @@ struct ClonablePtr {
     T* m_ptr;
 };
 
+/**
+ * @brief Owning pointer that starts out empty and deep-copies the object on copy.
+ *
+ * The object is default-constructed on the first call to getOrCreate.
+ */
+template <typename T>
+struct LazyClonablePtr {
+    LazyClonablePtr() noexcept = default;
+
+    ~LazyClonablePtr() {
+        delete m_ptr;
+    }
+
+    LazyClonablePtr(LazyClonablePtr&& ptr) noexcept {
+        swap(ptr);
+    }
+
+    LazyClonablePtr(const LazyClonablePtr& ptr) : m_ptr(ptr.m_ptr ? new T(*ptr.m_ptr) : nullptr) {}
+
+    LazyClonablePtr& operator=(LazyClonablePtr&& ptr) noexcept {
+        swap(ptr);
+        return *this;
+    }
+
+    LazyClonablePtr& operator=(const LazyClonablePtr& ptr) {
+        LazyClonablePtr(ptr).swap(*this);
+        return *this;
+    }
+
+    explicit operator bool() const noexcept {
+        return m_ptr != nullptr;
+    }
+
+    const T* get() const noexcept {
+        return m_ptr;
+    }
+
+    T* get() noexcept {
+        return m_ptr;
+    }
+
+    T& getOrCreate() {
+        if (!m_ptr) [[unlikely]]
+            m_ptr = new T{};
+        return *m_ptr;
+    }
+
+    void swap(LazyClonablePtr& other) noexcept {
+        std::swap(m_ptr, other.m_ptr);
+    }
+
+private:
+    T* m_ptr = nullptr;
+};
+
 /**
  * @brief A utility structure to provide automatic singleton management.
  *
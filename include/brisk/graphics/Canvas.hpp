@@ -68,6 +68,17 @@ public:
      */
     explicit Canvas(RawCanvas& canvas);
 
+    /**
+     * @brief Constructs a Canvas that draws to another RenderContext starting from the current state of
+     * an existing Canvas.
+     *
+     * The saved states of @p canvas are not copied.
+     *
+     * @param context The rendering context used for drawing operations.
+     * @param canvas The Canvas whose state is copied.
+     */
+    Canvas(RenderContext& context, const Canvas& canvas);
+
     /**
      * @brief Provides access to the underlying RawCanvas object.
      *
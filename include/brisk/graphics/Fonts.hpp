@@ -2,6 +2,7 @@
 #include <brisk/core/internal/InlineVector.hpp>
 #include <brisk/core/Stream.hpp>
 #include <brisk/core/Hash.hpp>
+#include <future>
 #include <mutex>
 #include "internal/OpenType.hpp"
 #include "Image.hpp"
@@ -220,6 +221,8 @@ namespace Internal {
 struct FontFace;
 struct GlyphData;
 struct TextRun;
+struct CodepointFallback;
+class GlyphDiskCache;
 
 struct TextRun {
     TextDirection direction;
@@ -365,6 +368,8 @@ struct Font;
 struct ShapedRuns;
 using PrerenderedText = ShapedRuns;
 
+class WorkerPool;
+
 enum class ShapedRunsState {
     Logical,
     Visual,
@@ -375,8 +380,9 @@ struct ShapedRuns {
     ShapedRunsState state = ShapedRunsState::Logical;
     LayoutOptions options = LayoutOptions::Default;
     RectangleF bounds(GlyphRunBounds boundsType = GlyphRunBounds::Text) const;
-    PrerenderedText prerender(const Font& font, float maxWidth) &&;
-    PrerenderedText prerender(const Font& font, float maxWidth) const&;
+    // With a pool, paragraphs of long texts are broken into lines in parallel. The result is the same
+    PrerenderedText prerender(const Font& font, float maxWidth, WorkerPool* pool = nullptr) &&;
+    PrerenderedText prerender(const Font& font, float maxWidth, WorkerPool* pool = nullptr) const&;
 
     void applyOffset(PointF offset);
     void align(PointF pos, float alignment_x, float alignment_y);
@@ -387,10 +393,27 @@ struct ShapedRuns {
 private:
     static size_t extractLine(GlyphRuns& output, GlyphRuns& input, float maxWidth);
     static void formatLine(std::span<GlyphRun> input, float y, int lineNum, float tabWidth);
+    static GlyphRuns formatParagraphs(GlyphRuns& input, const Font& font, float maxWidth, WorkerPool& pool);
     static RectangleF bounds(std::span<const GlyphRun> runs,
                              GlyphRunBounds boundsType = GlyphRunBounds::Text);
 };
 
+/**
+ * @brief Result of advance-only text measurement.
+ *
+ * The text is divided into segments at line break opportunities. Segment @c i spans
+ * codepoints [breaks[i], breaks[i + 1]) and advances the pen by @c advances[i].
+ */
+struct TextMeasurement {
+    std::vector<int32_t> breaks; // Line break opportunities, including 0 and the text length
+    std::vector<float> advances; // Horizontal advance of each segment
+    float height = 0.f;          // Height of the text when laid out without wrapping
+
+    // Width of the text laid out on a single line
+    float width() const noexcept;
+    SizeF size() const noexcept;
+};
+
 using OpenTypeFeatureFlags = inline_vector<OpenTypeFeatureFlag, 7>;
 
 struct Font {
@@ -485,6 +508,8 @@ struct OSFont {
     FontWeight weight;
     std::string styleName;
     fs::path path;
+    // Unicode coverage summary (ulUnicodeRange1..4 bits from the OS/2 table)
+    std::array<uint32_t, 4> unicodeRanges{};
 };
 
 namespace Internal {
@@ -500,13 +525,54 @@ public:
     ~FontManager();
 
     void addMergedFont(FontFamily fontFamily, std::initializer_list<FontFamily> families);
+    // Faces are parsed on first use. Data that FreeType can't read is reported then, and the face is
+    // treated as missing
     void addFont(FontFamily fontFamily, FontStyle style, FontWeight weight, bytes_view data,
                  bool makeCopy = true, FontFlags flags = FontFlags::Default);
+
+    /**
+     * @brief Registers a face whose data is produced on first use.
+     *
+     * The loader is called at most once, when text in this face is first measured, shaped or
+     * rendered, so compressed or embedded fonts that are never used are never unpacked.
+     * The returned data must remain valid for the lifetime of the FontManager.
+     */
+    void addFont(FontFamily fontFamily, FontStyle style, FontWeight weight, function<bytes_view()> loader,
+                 FontFlags flags = FontFlags::Default);
     [[nodiscard]] bool addFontByName(FontFamily fontFamily, std::string_view fontName);
     [[nodiscard]] bool addSystemFont(FontFamily fontFamily);
     [[nodiscard]] status<IOError> addFontFromFile(FontFamily family, FontStyle style, FontWeight weight,
                                                   const fs::path& path);
     [[nodiscard]] std::vector<OSFont> installedFonts(bool rescan = false) const;
+
+    // Starts scanning installed fonts on the shared worker pool. installedFonts() waits for the scan.
+    // Applications that look fonts up by name can call this at startup to have the index ready
+    void scanInstalledFonts();
+    // Returns true once installedFonts() can return without scanning
+    [[nodiscard]] bool installedFontsReady() const;
+
+    // Folders scanned by installedFonts. Defaults to fontFolders()
+    void setFontFolders(std::vector<fs::path> folders);
+    // File used to persist the font index between runs. Empty path disables the index
+    void setFontIndexPath(fs::path path);
+    // Pool used to shape and lay out long texts. nullptr selects the shared workerPool()
+    void setWorkerPool(WorkerPool* pool);
+
+    /**
+     * @brief Enables the persistent cache of rasterized glyphs.
+     *
+     * Glyphs found in the cache file are not rasterized again. Newly rasterized glyphs are
+     * written to the file by flushGlyphCache() and when the FontManager is destroyed.
+     *
+     * @param path Cache file. Empty path disables the cache (default).
+     * @param maxSize Maximum size of the cache file in bytes.
+     */
+    void setGlyphCachePath(fs::path path, uintmax_t maxSize = defaultGlyphCacheSize);
+
+    // Writes glyphs rasterized since the last flush to the glyph cache file
+    void flushGlyphCache();
+
+    constexpr static uintmax_t defaultGlyphCacheSize = 16 * 1024 * 1024;
     std::vector<FontStyleAndWeight> fontFamilyStyles(FontFamily fontFamily) const;
 
     FontMetrics metrics(const Font& font) const;
@@ -515,6 +581,15 @@ public:
     PrerenderedText prerender(const Font& font, const TextWithOptions& text, float width = HUGE_VALF) const;
     RectangleF bounds(const Font& font, const TextWithOptions& text) const;
 
+    /**
+     * @brief Measures text without building glyph runs.
+     *
+     * Advances of simple left-to-right segments are cached per font face and size, so repeated
+     * measurement of similar labels avoids shaping. Text containing control characters (line feeds,
+     * tabs) is measured through the full layout and reported as a single segment.
+     */
+    TextMeasurement measure(const Font& font, const TextWithOptions& text) const;
+
     using FontKey = std::tuple<FontFamily, FontStyle, FontWeight>;
 
     FontKey faceToKey(Internal::FontFace* face) const;
@@ -547,13 +622,21 @@ private:
     uint32_t m_cacheTimeMs;
     inline_vector<FontFamily, maxFontsInMergedFonts> fontList(FontFamily ff) const;
     mutable std::vector<OSFont> m_osFonts;
+    mutable std::shared_future<std::vector<OSFont>> m_osFontsScan;
+    std::vector<fs::path> m_fontFolders;
+    fs::path m_fontIndexPath;
+    WorkerPool* m_workerPool = nullptr;
+    std::unique_ptr<Internal::GlyphDiskCache> m_glyphDiskCache;
+    mutable std::map<fs::path, WeakRC<MappedFile>> m_mappedFiles;
+    RC<MappedFile> mapFontFile(const fs::path& path) const;
+    mutable std::map<FontKey, std::unique_ptr<Internal::CodepointFallback>> m_codepointFallback;
     Internal::FontFace* lookup(const Font& font) const;
-    std::pair<Internal::FontFace*, GlyphID> lookupCodepoint(const Font& font, char32_t codepoint,
-                                                            bool fallbackToUndef) const;
+    Internal::CodepointFallback& codepointFallback(const Font& font) const;
     FontMetrics getMetrics(const Font& font) const;
     static RectangleF glyphBounds(const Internal::Glyph& g, const Internal::GlyphData& d);
     ShapedRuns shapeRuns(const Font& font, const TextWithOptions& text,
-                         const std::vector<Internal::TextRun>& textRuns) const;
+                         const std::vector<Internal::TextRun>& textRuns, int32_t begin, int32_t end,
+                         const FontMetrics& metrics) const;
     std::vector<Internal::TextRun> assignFontsToTextRuns(
         const Font& font, std::u32string_view text, const std::vector<Internal::TextRun>& textRuns) const;
     std::vector<Internal::TextRun> splitControls(std::u32string_view text,
@@ -561,6 +644,10 @@ private:
     PrerenderedText doPrerender(const Font& font, const TextWithOptions& text, float width = HUGE_VALF) const;
     ShapedRuns doShapeCached(const Font& font, const TextWithOptions& text) const;
     ShapedRuns doShape(const Font& font, const TextWithOptions& text) const;
+    ShapedRuns doShapeParallel(const Font& font, const TextWithOptions& text,
+                               const std::vector<int32_t>& chunks) const;
+    WorkerPool& layoutPool() const;
+    TextMeasurement doMeasure(const Font& font, const TextWithOptions& text) const;
 };
 
 extern std::optional<FontManager> fonts;
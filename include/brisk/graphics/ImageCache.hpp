@@ -0,0 +1,135 @@
+/*
+ * Brisk
+ *
+ * Cross-platform application framework
+ * --------------------------------------------------------------
+ *
+ * Copyright (C) 2024 Brisk Developers
+ *
+ * This file is part of the Brisk library.
+ *
+ * Brisk is dual-licensed under the GNU General Public License, version 2 (GPL-2.0+),
+ * and a commercial license. You may use, modify, and distribute this software under
+ * the terms of the GPL-2.0+ license if you comply with its conditions.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * If you do not wish to be bound by the GPL-2.0+ license, you must purchase a commercial
+ * license. For commercial licensing options, please visit: https://brisklib.com
+ */
+#pragma once
+
+#include <brisk/graphics/ImageFormats.hpp>
+#include <brisk/core/Hash.hpp>
+#include <future>
+#include <list>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+namespace Brisk {
+
+/**
+ * @brief Returns the identity of an encoded image, used as the source key of ImageCache.
+ */
+inline uint64_t imageSourceId(bytes_view encoded) {
+    return fastHash(encoded);
+}
+
+/**
+ * @brief Cache of decoded images shared by everything that displays them.
+ *
+ * Images are keyed by the identity of their source, the pixel format and the size they were decoded
+ * for. A request is served by a cached decode of the same source that covers the requested size and
+ * is less than twice as large, or by a decode at the original size if the image is no larger than
+ * requested. The GPU texture of an image is owned by the Image object, so sharing an image also shares
+ * its upload.
+ *
+ * When the cached images exceed the budget, the least recently used ones are evicted. Images that
+ * are referenced outside the cache, such as the ones currently displayed, are pinned: evicting them
+ * wouldn't free any memory. Concurrent requests for the same image are decoded only once.
+ *
+ * @threadsafe All methods are thread-safe.
+ */
+class ImageCache final {
+public:
+    struct Statistics {
+        size_t hits        = 0; ///< Requests served without decoding
+        size_t misses      = 0; ///< Requests that decoded the image
+        size_t evictions   = 0; ///< Images removed to stay within the budget
+        size_t entries     = 0; ///< Number of cached images
+        size_t bytes       = 0; ///< Total size of the cached images
+        size_t pinnedBytes = 0; ///< Part of bytes taken by images referenced outside the cache
+    };
+
+    /**
+     * @brief Creates an empty cache.
+     *
+     * @param budget Maximum total size of unpinned images in bytes.
+     */
+    explicit ImageCache(size_t budget);
+
+    ImageCache(const ImageCache&)            = delete;
+    ImageCache& operator=(const ImageCache&) = delete;
+
+    /**
+     * @brief Returns the decoded image, decoding and caching it on a miss.
+     *
+     * @param source Identity of the image, see imageSourceId.
+     * @param encoded The encoded image. It is only read on a miss.
+     * @param minSize Minimum size as in imageDecode(bytes_view, Size, ImageFormat). An empty size
+     * requests the original size.
+     * @param format Pixel format of the decoded image.
+     */
+    expected<RC<Image>, ImageIOError> decode(uint64_t source, bytes_view encoded, Size minSize = {},
+                                             ImageFormat format = ImageFormat::RGBA);
+
+    /**
+     * @brief Returns the cached image or nullptr. Doesn't decode.
+     */
+    RC<Image> find(uint64_t source, Size minSize = {}, ImageFormat format = ImageFormat::RGBA);
+
+    /**
+     * @brief Changes the budget, evicting images if needed.
+     */
+    void setBudget(size_t budget);
+
+    size_t budget() const;
+
+    /**
+     * @brief Removes all images that aren't pinned.
+     */
+    void clear();
+
+    Statistics statistics() const;
+
+private:
+    struct Entry {
+        uint64_t source;
+        ImageFormat format;
+        bool original; // Decoded at the original size
+        RC<Image> image;
+    };
+
+    using PendingKey = std::tuple<uint64_t, int32_t, int32_t, ImageFormat>;
+
+    mutable std::mutex m_mutex;
+    size_t m_budget;
+    size_t m_bytes = 0;
+    Statistics m_statistics;
+    std::list<Entry> m_lru; // Most recently used first
+    std::unordered_multimap<uint64_t, std::list<Entry>::iterator> m_index;
+    std::map<PendingKey, std::shared_future<expected<RC<Image>, ImageIOError>>> m_pending;
+
+    RC<Image> findLocked(uint64_t source, Size minSize, ImageFormat format);
+    void removeLocked(std::list<Entry>::iterator entry);
+    void evictLocked();
+};
+
+/**
+ * @brief Returns the process-wide image cache. Its budget is 256 MiB by default.
+ */
+ImageCache& imageCache();
+
+} // namespace Brisk
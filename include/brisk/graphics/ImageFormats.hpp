@@ -142,6 +142,21 @@ inline ColorSubsampling defaultColorSubsampling = ColorSubsampling::S420;
 [[nodiscard]] expected<RC<Image>, ImageIOError> jpegDecode(bytes_view bytes,
                                                            ImageFormat format = ImageFormat::Unknown);
 
+/**
+ * @brief Decodes a JPEG image, letting the decoder scale it down.
+ *
+ * The decoder picks the smallest of its scaling factors (down to 1/8) that keeps the image at least
+ * as large as minSize in both dimensions. This is much cheaper than decoding at full size and
+ * resizing afterwards.
+ *
+ * @param bytes A view of the byte data representing a JPEG image.
+ * @param minSize Minimum size of the decoded image. The image is never upscaled.
+ * @param format Optional image format to use for decoding (returns original format if not specified).
+ * @return An expected result containing a reference-counted pointer to the decoded image or an ImageIOError.
+ */
+[[nodiscard]] expected<RC<Image>, ImageIOError> jpegDecode(bytes_view bytes, Size minSize,
+                                                           ImageFormat format = ImageFormat::Unknown);
+
 /**
  * @brief Decodes a WEBP image from the provided byte data.
  *
@@ -166,4 +181,18 @@ inline ColorSubsampling defaultColorSubsampling = ColorSubsampling::S420;
 [[nodiscard]] expected<RC<Image>, ImageIOError> imageDecode(bytes_view bytes,
                                                             ImageFormat format = ImageFormat::Unknown);
 
+/**
+ * @brief Decodes an image scaled down to the smallest size that covers minSize.
+ *
+ * The aspect ratio is preserved and images smaller than minSize are returned at their original
+ * size. JPEG images are scaled by the decoder first, so only the remaining fraction is resized.
+ *
+ * @param bytes A view of the byte data representing the image.
+ * @param minSize Minimum size of the decoded image in both dimensions.
+ * @param format Optional image format to use for decoding (returns original format if not specified).
+ * @return An expected result containing a reference-counted pointer to the decoded image or an ImageIOError.
+ */
+[[nodiscard]] expected<RC<Image>, ImageIOError> imageDecode(bytes_view bytes, Size minSize,
+                                                            ImageFormat format = ImageFormat::Unknown);
+
 } // namespace Brisk
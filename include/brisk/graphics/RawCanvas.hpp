@@ -132,6 +132,24 @@ using GeometryGlyphs = std::vector<GeometryGlyph>;
 
 GeometryGlyphs pathLayout(SpriteResources& sprites, const RasterizedPath& path);
 
+/**
+ * @brief Text with glyph sprites and geometry resolved, ready to be drawn repeatedly.
+ *
+ * Drawing prepared text neither loads glyphs nor builds geometry, so callers that draw the same
+ * text every frame can keep it between frames. Sprites are held by reference, so glyphs stay
+ * valid even if the font manager evicts them from its cache.
+ */
+struct PreparedText {
+    SpriteResources sprites;
+    GeometryGlyphs glyphs;
+    GlyphRuns decorations; // Runs with text decoration
+};
+
+/**
+ * @brief Resolves the glyph sprites and geometry of the text.
+ */
+PreparedText prepareText(const PrerenderedText& text);
+
 class Canvas;
 
 class RawCanvas {
@@ -151,8 +169,11 @@ public:
                        RenderStateExArgs args);
     RawCanvas& drawTexture(RectangleF rect, const ImageHandle& tex, const Matrix2D& matrix,
                            RenderStateExArgs args);
-    RawCanvas& drawText(SpriteResources sprites, std::span<GeometryGlyph> glyphs, RenderStateExArgs args);
-    RawCanvas& drawMask(SpriteResources sprites, std::span<GeometryGlyph> glyphs, RenderStateExArgs args);
+    RawCanvas& drawText(const PreparedText& text, RenderStateExArgs args);
+    RawCanvas& drawText(SpriteResources sprites, std::span<const GeometryGlyph> glyphs,
+                        RenderStateExArgs args);
+    RawCanvas& drawMask(SpriteResources sprites, std::span<const GeometryGlyph> glyphs,
+                        RenderStateExArgs args);
 
     RawCanvas& drawLine(PointF p1, PointF p2, float thickness, const ColorF& color,
                         LineEnd end = LineEnd::Butt);
@@ -198,6 +219,11 @@ public:
         return drawText(run, RenderStateExArgs{ std::make_tuple(args...) });
     }
 
+    template <typename... Args>
+    RawCanvas& drawText(const PreparedText& text, const Args&... args) {
+        return drawText(text, RenderStateExArgs{ std::make_tuple(args...) });
+    }
+
     /// Draw text at the given point
     RawCanvas& drawText(PointF pos, const TextWithOptions& text, const Font& f, const ColorF& textColor);
 
@@ -256,11 +282,16 @@ public:
         return m_state;
     }
 
+    RenderContext& context() const noexcept {
+        return m_context;
+    }
+
 protected:
     friend class Canvas;
     RenderContext& m_context;
     State m_state;
     void prepareStateInplace(RenderStateEx& state);
     RenderStateEx prepareState(RenderStateEx&& state);
+    void drawDecorations(std::span<const GlyphRun> runs, RenderStateExArgs args);
 };
 } // namespace Brisk
@@ -239,6 +239,57 @@ private:
     bool flush();
 };
 
+/**
+ * @class RecordingContext
+ * @brief Stores rendering commands so that they can be issued to another context later.
+ *
+ * Recording doesn't touch render resources, so it can be done on any thread. Replaying the commands
+ * produces the same command stream as drawing to the target context directly.
+ */
+class RecordingContext final : public RenderContext {
+public:
+    using RenderContext::command;
+
+    /**
+     * @brief Records a rendering command.
+     * @param cmd The render state command.
+     * @param data Associated data.
+     */
+    void command(RenderStateEx&& cmd, std::span<const float> data = {}) final;
+
+    /**
+     * @brief Returns 0, the recording doesn't batch commands.
+     */
+    int numBatches() const final;
+
+    struct Command {
+        RenderStateEx state;
+        uint32_t dataOffset; ///< Offset of the command data in data()
+        uint32_t dataSize;   ///< Size of the command data in floats
+    };
+
+    /**
+     * @brief Returns the recorded commands.
+     */
+    std::span<const Command> commands() const noexcept;
+
+    /**
+     * @brief Returns the data of all recorded commands.
+     */
+    std::span<const float> data() const noexcept;
+
+    /**
+     * @brief Issues the recorded commands to the target in the order they were recorded and clears the
+     * recording.
+     * @param target The context to issue the commands to.
+     */
+    void replay(RenderContext& target);
+
+private:
+    std::vector<Command> m_commands; ///< Recorded commands.
+    std::vector<float> m_data;       ///< Data of the recorded commands.
+};
+
 /**
  * @class WindowRenderTarget
  * @brief Represents a render target for window-based rendering.
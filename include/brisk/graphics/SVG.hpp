@@ -15,6 +15,10 @@ struct SVGImpl;
  *
  * This class provides functionality to load an SVG image from a string and
  * render it as a raster image with a specified size and background color.
+ *
+ * SVGImage objects created from the same source share the parsed document. Rendered images are kept
+ * in a process-wide cache keyed by source, size and background, so icons drawn repeatedly at the
+ * same sizes are rasterized once.
  */
 struct SVGImage {
 public:
@@ -41,10 +45,23 @@ public:
      * @param size The desired size of the output image.
      * @param background The background color to use (default is transparent).
      *
-     * @return A smart pointer to an Image object representing the rendered image.
+     * @return A smart pointer to an Image object representing the rendered image, or nullptr if the
+     * SVG couldn't be parsed. The image may be shared with other callers and must not be modified.
      */
     RC<Image> render(Size size, ColorF background = ColorF(0.f, 0.f)) const;
 
+    /**
+     * @brief Sets the maximum total size of rendered images kept for reuse, in bytes.
+     *
+     * The default is 16 MiB. Zero disables the cache.
+     */
+    static void setCacheBudget(size_t budget);
+
+    /**
+     * @brief Returns the maximum total size of rendered images kept for reuse, in bytes.
+     */
+    static size_t cacheBudget();
+
 private:
     RC<Internal::SVGImpl> m_impl; ///< Pointer to the internal SVG implementation.
 };
@@ -25,6 +25,7 @@
 #include <brisk/core/Binding.hpp>
 #include <memory>
 #include <deque>
+#include <unordered_map>
 #include <brisk/core/internal/Function.hpp>
 #include <brisk/core/internal/Generation.hpp>
 #include <atomic>
@@ -97,7 +98,9 @@ struct EventMouseButton : public EventMouse {
 /**
  * @brief Struct representing a mouse moved event.
  */
-struct EventMouseMoved : public EventMouse {};
+struct EventMouseMoved : public EventMouse {
+    std::vector<PointF> history; ///< Positions of the earlier moves merged into this event, oldest first.
+};
 
 /**
  * @brief Struct representing a mouse wheel event.
@@ -354,6 +357,11 @@ struct Event : public EventVariant {
      */
     void passThrough();
 
+    /**
+     * @brief Moves the points of mouse and drag events by the given offset.
+     */
+    void translate(PointF offset);
+
     static inline const Rectangle anywhere{ -32768, -32768, 32768, 32768 };
 
     bool pressed(Rectangle rect, MouseButton btn = MouseButton::Left,
@@ -389,6 +397,10 @@ struct Event : public EventVariant {
 
 /**
  * @brief Struct for managing hit test information for widgets.
+ *
+ * Entries are collected with add() while the widget tree updates its geometry. build() then sorts
+ * them by priority (lower z-index first, children before their parents) and buckets them into a
+ * uniform grid, so that point queries only look at the entries overlapping the query cell.
  */
 struct HitTestMap {
     void add(std::shared_ptr<Widget> w, Rectangle rect, bool anywhere);
@@ -400,7 +412,30 @@ struct HitTestMap {
         bool anywhere;                ///< Indicates if the widget is valid anywhere.
     };
 
-    std::vector<HTEntry> list; ///< List of hit test entries.
+    /**
+     * @brief Sorts the entries by priority and builds the spatial index.
+     * @details Called once per geometry update. Queries call it on demand if entries were added since.
+     */
+    void build() const;
+
+    /**
+     * @brief Returns all entries in priority order.
+     */
+    const std::vector<HTEntry>& entries() const;
+
+    /**
+     * @brief Finds the first entry in priority order that accepts the point.
+     * @param pt The point to check.
+     * @param offset Index of the first entry to consider.
+     * @param respect_anywhere Whether to respect the "anywhere" flag.
+     * @return Index of the entry, or -1 if no live widget accepts the point.
+     */
+    int indexAt(Point pt, int offset, bool respect_anywhere) const;
+
+    /**
+     * @brief Returns the priority index of the widget, if it has an entry.
+     */
+    optional<size_t> indexOf(const Widget* widget) const;
 
     /**
      * @brief Retrieves the widget at the specified coordinates.
@@ -426,9 +461,21 @@ struct HitTestMap {
         bool inTabGroup       = false;
         bool mouseTransparent = false;
         Rectangle scissors    = Event::anywhere;
+        Point offset          = { 0, 0 }; ///< Offset of the current widget's coordinates from the window
     } state;
 
     int tabGroupId = 0;
+
+private:
+    mutable std::vector<HTEntry> m_list; ///< Insertion order until built, priority order after
+    mutable bool m_built = true;
+    mutable Rectangle m_bounds{};
+    mutable Size m_cellSize{ 1, 1 };
+    mutable Size m_gridSize{ 0, 0 };
+    mutable std::vector<uint32_t> m_cellStart; ///< Offsets into m_cellItems, one per cell plus one
+    mutable std::vector<uint32_t> m_cellItems; ///< Entry indices per cell, ascending
+    mutable std::vector<uint32_t> m_anywhere;  ///< Indices of entries with the anywhere flag
+    mutable std::unordered_map<const Widget*, uint32_t> m_order;
 };
 
 /**
@@ -440,6 +487,7 @@ struct InputQueue {
     std::weak_ptr<const Widget> activeHint;
     std::vector<std::weak_ptr<Widget>> capturingMouse; ///< List of widgets capturing the mouse input.
     std::vector<std::weak_ptr<Widget>> capturingKeys;  ///< List of widgets capturing keyboard input.
+    std::vector<std::weak_ptr<Widget>> hovered;        ///< Widgets put in the hover state by the mouse.
     std::vector<std::weak_ptr<Widget>> tabList;
     std::weak_ptr<Widget> autoFocus;
     std::weak_ptr<Widget> dragSource;
@@ -455,14 +503,16 @@ struct InputQueue {
     std::deque<Event> events;
     std::vector<Event> injectedEvents;
     function<void(Event&)> unhandledEvent;
-    bool passThroughFlag = false;
+    bool passThroughFlag     = false;
+    bool coalesceMouseEvents = true; ///< Merges consecutive mouse moves and wheel events in addEvent.
     std::weak_ptr<Widget> passedThroughBy;
     optional<EventMouse> lastMouseEvent;
     optional<EventInput> lastInputEvent;
     std::shared_ptr<Widget>
         eventTarget; ///< The target widget of the event currently processed, unaffected by bubbling.
 
-    PointF mousePos{ -1.f, -1.f }; ///< Mouse position relative to the window.
+    PointF mousePos{ -1.f, -1.f };  ///< Mouse position relative to the window.
+    PointF eventOffset{ 0.f, 0.f }; ///< Offset of the delivered event's coordinates from the window.
     KeyModifiers keyModifiers{ KeyModifiers::None };
     Trigger<> trigMousePos;
     Trigger<> trigKeyModifiers;
@@ -660,6 +710,10 @@ struct InputQueue {
 
     /**
      * Adds an event to the queue to be processed in the next call to processEvent.
+     * @details If coalesceMouseEvents is set, a mouse move directly following another move with the same
+     * modifiers replaces it, keeping the earlier positions in EventMouseMoved::history. A wheel event is
+     * added to the delta of the pending wheel event of the same orientation if only wheel events were queued
+     * since. Button, key and other events are never merged, so their order relative to moves is kept.
      * @param event The event to add.
      */
     void addEvent(Event event);
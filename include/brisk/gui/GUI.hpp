@@ -59,7 +59,9 @@ constexpr inline FontFamily Monospace   = static_cast<FontFamily>(1);
 constexpr inline FontFamily GoNoto      = static_cast<FontFamily>(2);
 constexpr inline FontFamily DefaultFont = Lato;
 
+// Registers the embedded fonts with the global FontManager once. Font data is unpacked on first use
 void registerBuiltinFonts();
+void registerBuiltinFonts(FontManager& manager);
 
 class Widget;
 
@@ -78,6 +80,7 @@ using BindingFunc = function<void(Widget*)>;
 
 class Stylesheet;
 struct Rules;
+struct CompiledRules;
 
 using OnClick     = WithLifetime<Callback<>>;
 using OnItemClick = Callback<size_t>;
@@ -290,6 +293,7 @@ struct Resolve {
 struct WidgetProps {};
 
 class LayoutEngine;
+struct KeyedChildren;
 
 struct WidgetArgumentAccept {
     void operator()(std::shared_ptr<Widget>);
@@ -539,6 +543,44 @@ inline void applier(Target* target, const ArgVal<Tag::PropArg<PropertyType>, U>&
 
 using StyleVarType = std::variant<std::monostate, ColorF, EdgesL, float, int>;
 
+namespace Internal {
+
+/**
+ * @brief Widget data that most widgets never set and that layout, hit testing and painting rarely read.
+ *
+ * Allocated on the first write. Until then, reads see the default values. Each block is registered as a
+ * binding region of its own, so the properties stored here can be bound like the ones stored in Widget.
+ */
+struct WidgetCold {
+    std::string description;
+    std::string hint;
+    bool isHintExclusive    = false;
+    mutable bool hintShown  = false;
+    EventDelegate* delegate = nullptr;
+    Trigger<> onClick;
+    Trigger<> onDoubleClick;
+    Painter painter;
+
+    float backgroundColorTransition      = 0;
+    float borderColorTransition          = 0;
+    float colorTransition                = 0;
+    float shadowColorTransition          = 0;
+    EasingFunction backgroundColorEasing = &easeLinear;
+    EasingFunction borderColorEasing     = &easeLinear;
+    EasingFunction colorEasing           = &easeLinear;
+    EasingFunction shadowColorEasing     = &easeLinear;
+
+    std::vector<StyleVarType> styleVars;
+    std::set<WidgetGroup*> groups;
+
+    static const WidgetCold defaults;
+
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr, size_t size);
+};
+
+} // namespace Internal
+
 class WIDGET Widget : public BindingObject<Widget, &uiThread> {
 public:
     using Ptr                 = std::shared_ptr<Widget>;
@@ -599,10 +641,35 @@ public:
 
     Value<Trigger<>> trigRebuild();
 
+    /**
+     * @brief Adds a child identified by a key. Intended to be called by a builder on its target.
+     *
+     * When the builder runs again, the child added under the same key by its previous run is moved to the
+     * current position instead of being recreated, so it keeps its state, and @p create is not called.
+     * Children whose keys are not added again are removed. Keys must be unique within one builder run.
+     *
+     * Outside a builder of this widget the child is always created.
+     *
+     * @param create Returns the new child as `Widget*` or `RC<Widget>`.
+     * @returns The reused or created child.
+     */
+    template <std::invocable Fn>
+    Widget* applyKeyed(std::string_view key, Fn&& create) {
+        if (Widget* reused = reuseKeyed(key))
+            return reused;
+        return addKeyed(key, create());
+    }
+
+    struct KeyedChild {
+        uint32_t index; ///< Relative to BuilderData::position
+        std::string key;
+    };
+
     struct BuilderData {
         Builder builder;
         uint32_t position;
         uint32_t count;
+        std::vector<KeyedChild> keyed; ///< Children added by applyKeyed
     };
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -780,10 +847,26 @@ public:
 
     bool isVisible() const noexcept;
 
+    /**
+     * @brief Returns the widget rectangle in the widget's own coordinates.
+     * @details Content of a scrolled widget keeps the coordinates it was laid out at; the scroll offset
+     * is applied when painting and hit-testing. Outside of scrolled widgets these are window coordinates.
+     */
     Rectangle rect() const noexcept;
 
     Rectangle clientRect() const noexcept;
 
+    /**
+     * @brief Returns the offset from the widget's own coordinates to the window coordinates.
+     * @details Sums the offsets of the enclosing scrolled widgets.
+     */
+    Point windowOffset() const noexcept;
+
+    /**
+     * @brief Returns the widget rectangle in window coordinates.
+     */
+    Rectangle windowRect() const noexcept;
+
     ////////////////////////////////////////////////////////////////////////////////
     // Style & layout
     ////////////////////////////////////////////////////////////////////////////////
@@ -812,13 +895,26 @@ public:
 
     template <StyleVarTag Tag>
     void set(Tag, typename Tag::Type value) {
-        if (Tag::id >= m_styleVars.size()) {
-            m_styleVars.resize(Tag::id + 1, std::monostate{});
+        std::vector<StyleVarType>& styleVars = writableCold().styleVars;
+        if (Tag::id >= styleVars.size()) {
+            styleVars.resize(Tag::id + 1, std::monostate{});
         }
-        if (assign(m_styleVars[Tag::id], value))
+        if (assign(styleVars[Tag::id], value))
             requestRestyle();
     }
 
+    /// Rarely used data; returns the defaults if nothing has been written yet
+    const Internal::WidgetCold& cold() const noexcept {
+        if (const Internal::WidgetCold* cold = m_cold.get()) [[unlikely]]
+            return *cold;
+        return Internal::WidgetCold::defaults;
+    }
+
+    /// Rarely used data, allocated on first call
+    Internal::WidgetCold& writableCold() {
+        return m_cold.getOrCreate();
+    }
+
     void apply(const Rules& rules);
 
     void apply(const Attributes& arg);
@@ -914,43 +1010,26 @@ public:
     using enum PropFlags;
 
     friend struct Rules;
+    friend struct CompiledRules;
 
 protected:
     friend struct InputQueue;
     friend class Stylesheet;
     friend class WidgetTree;
 
-    WidgetTree* m_tree = nullptr;
-
     RC<const Stylesheet> m_stylesheet;
-    Painter m_painter;
 
     optional<PointF> m_mousePos;
 
-    bool m_inConstruction : 1       = true;
-    bool m_constructed : 1          = false;
-    bool m_isPopup : 1              = false; // affected by closeNearestPopup
-    bool m_processClicks : 1        = true;
-    bool m_styleApplying : 1        = false;
-    bool m_ignoreChildrenOffset : 1 = false;
-
-    // functions
-    Trigger<> m_onClick;
-    Trigger<> m_onDoubleClick;
-
-    mutable bool m_hintShown = false;
     function<void(Widget*)> m_reapplyStyle;
+    LazyClonablePtr<Internal::WidgetCold> m_cold;
 
     // strings
-    std::string m_description;
     std::string m_type;
     std::string m_id;
-    std::string m_hint;
     std::string_view m_role;
     Classes m_classes;
 
-    Rectangle m_rect{ 0, 0, 0, 0 };
-    Rectangle m_clientRect{ 0, 0, 0, 0 };
     EdgesF m_computedMargin{ 0, 0, 0, 0 };
     EdgesF m_computedPadding{ 0, 0, 0, 0 };
     EdgesF m_computedBorderWidth{ 0, 0, 0, 0 };
@@ -964,14 +1043,6 @@ protected:
     Internal::Transition<ColorF> m_borderColor{ Palette::transparent };
     Internal::Transition<ColorF> m_color{ Palette::white };
     Internal::Transition<ColorF> m_shadowColor{ Palette::black.multiplyAlpha(0.4f) };
-    float m_backgroundColorTransition      = 0;
-    float m_borderColorTransition          = 0;
-    float m_colorTransition                = 0;
-    float m_shadowColorTransition          = 0;
-    EasingFunction m_backgroundColorEasing = &easeLinear;
-    EasingFunction m_borderColorEasing     = &easeLinear;
-    EasingFunction m_colorEasing           = &easeLinear;
-    EasingFunction m_shadowColorEasing     = &easeLinear;
 
     // point/size
     PointL m_absolutePosition{ undef, undef }; // for popup only
@@ -982,10 +1053,6 @@ protected:
     PointL m_translate{ 0, 0 }; // translation relative to own size
     SizeL m_gap                    = { 0, 0 };
 
-    // pointers
-    Widget* m_parent               = nullptr;
-    EventDelegate* m_delegate      = nullptr;
-
     // float
     mutable float m_regenerateTime = 0.0;
     mutable float m_relayoutTime   = 0.0;
@@ -993,7 +1060,6 @@ protected:
     OptFloat m_flexGrow            = undef;
     OptFloat m_flexShrink          = undef;
     OptFloat m_aspect              = undef;
-    float m_opacity                = 1.f;
 
     // int
     int m_corners                  = +CornerFlags::All;
@@ -1008,7 +1074,6 @@ protected:
     Internal::Resolve<Length> m_wordSpacing{ 0_px, 0.f };
 
     // uint8_t
-    mutable WidgetState m_state         = WidgetState::None;
     FontFamily m_fontFamily             = DefaultFont;
     FontStyle m_fontStyle               = FontStyle::Normal;
     FontWeight m_fontWeight             = FontWeight::Regular;
@@ -1019,36 +1084,25 @@ protected:
     AlignItems m_alignItems             = AlignItems::Stretch;
     Layout m_layout                     = Layout::Horizontal;
     LayoutOrder m_layoutOrder           = LayoutOrder::Direct;
-    Placement m_placement               = Placement::Normal;
-    ZOrder m_zorder                     = ZOrder::Normal;
-    WidgetClip m_clip                   = WidgetClip::All;
-    Overflow m_overflow                 = Overflow::Hidden;
     AlignContent m_alignContent         = AlignContent::FlexStart;
     Wrap m_flexWrap                     = Wrap::NoWrap;
     BoxSizingPerAxis m_boxSizing        = BoxSizingPerAxis::BorderBox;
     AlignToViewport m_alignToViewport   = AlignToViewport::None;
     TextAlign m_textAlign               = TextAlign::Start;
     TextAlign m_textVerticalAlign       = TextAlign::Center;
-    MouseInteraction m_mouseInteraction = MouseInteraction::Inherit;
 
     bool m_tabStop                      = false;
     bool m_tabGroup                     = false;
-    bool m_visible                      = true;
-    bool m_hidden                       = false;
     bool m_autofocus                    = false;
-    bool m_mousePassThrough             = false;
     bool m_autoMouseCapture             = true;
     bool m_mouseAnywhere                = false;
     bool m_focusCapture                 = false;
     bool m_stateTriggersRestyle         = false;
-    bool m_isHintExclusive              = false;
 
     std::bitset<Internal::propStateBits * Internal::numProperties> m_propStates;
     Internal::PropState getPropState(size_t index) const noexcept;
     void setPropState(size_t index, Internal::PropState state) noexcept;
 
-    std::vector<StyleVarType> m_styleVars;
-
     enum class RestyleState {
         None,
         NeedRestyleForChildren,
@@ -1056,6 +1110,29 @@ protected:
     };
     RestyleState m_restyleState = RestyleState::NeedRestyle;
 
+    // Read by every layout, hit test and paint traversal. Kept together, next to the private fields of the
+    // same kind, so that walking the tree touches few cache lines per widget.
+    WidgetTree* m_tree                  = nullptr;
+    Widget* m_parent                    = nullptr;
+    Rectangle m_rect{ 0, 0, 0, 0 };
+    Rectangle m_clientRect{ 0, 0, 0, 0 };
+    float m_opacity                     = 1.f;
+    mutable WidgetState m_state         = WidgetState::None;
+    Placement m_placement               = Placement::Normal;
+    ZOrder m_zorder                     = ZOrder::Normal;
+    WidgetClip m_clip                   = WidgetClip::All;
+    Overflow m_overflow                 = Overflow::Hidden;
+    MouseInteraction m_mouseInteraction = MouseInteraction::Inherit;
+    bool m_visible                      = true;
+    bool m_hidden                       = false;
+    bool m_mousePassThrough             = false;
+    bool m_inConstruction : 1           = true;
+    bool m_constructed : 1              = false;
+    bool m_isPopup : 1                  = false; // affected by closeNearestPopup
+    bool m_processClicks : 1            = true;
+    bool m_styleApplying : 1            = false;
+    bool m_ignoreChildrenOffset : 1     = false;
+
     struct StyleApplying {
         explicit StyleApplying(Widget* widget) : widget(widget) {
             widget->m_styleApplying = true;
@@ -1085,6 +1162,11 @@ protected:
 
     virtual void revealChild(Widget*);
     void updateGeometry();
+    /**
+     * @brief Moves the children, except those ignoring the offset, by the given offset.
+     * @details The children keep their rectangles. The offset only changes the paint and hit-test
+     * transform, so a scroll step does not visit the descendants.
+     */
     bool setChildrenOffset(Point newOffset);
     SizeF measuredDimensions() const noexcept;
     [[nodiscard]] virtual SizeF measure(AvailableSize size) const;
@@ -1105,13 +1187,17 @@ protected:
     void paintHint(Canvas& canvas) const;
     void paintFocusFrame(Canvas& canvas) const;
     void paintChildren(Canvas& canvas) const;
+    bool paintChildrenParallel(Canvas& canvas, WorkerPool& pool, RectangleF scissors) const;
 
     ///////////////////////////////////////////////////////////////////////////////
 
     Size viewportSize() const noexcept;
     void setRect(Rectangle rect);
 
-    void rebuildOne(Builder builder);
+    void rebuildOne(Builder builder, Internal::KeyedChildren* previous = nullptr);
+    Widget* reuseKeyed(std::string_view key);
+    Widget* addKeyed(std::string_view key, Ptr widget);
+    Widget* addKeyed(std::string_view key, Widget* widget);
 
     virtual Ptr getContextWidget();
 
@@ -1124,7 +1210,6 @@ protected:
 
     virtual void onVisible();
     virtual void onHidden();
-    virtual void onRefresh();
     virtual void onStateChanged(WidgetState oldState, WidgetState newState);
 
     virtual void onEvent(Event& event);
@@ -1153,7 +1238,15 @@ protected:
     OptConstRef<T> getterCurrent() const noexcept;
 
     template <typename T>
-    float Widget::* transitionField(Internal::Transition<T> Widget::* field) const noexcept;
+    float Internal::WidgetCold::* transitionField(Internal::Transition<T> Widget::* field) const noexcept;
+    template <typename T>
+    EasingFunction Internal::WidgetCold::* easingField(
+        Internal::Transition<T> Widget::* field) const noexcept;
+
+    /// Starts a transition of @p field in the tree's animation scheduler, or jumps to @p value if the
+    /// duration is zero or the widget is not attached to a tree
+    bool transitionTo(Internal::Transition<ColorF>& field, ColorF value, float duration,
+                      EasingFunction easing);
 
     void requestUpdates(PropFlags flags);
 
@@ -1176,20 +1269,19 @@ private:
     bool m_hasLayout : 1 { false };
     bool m_previouslyHasLayout : 1 { false };
 
-    Trigger<> m_rebuildTrigger{};
-
     WidgetPtrs m_widgets;
+    ClonablePtr<Internal::LayoutEngine> m_layoutEngine;
+
+    Trigger<> m_rebuildTrigger{};
     std::vector<BuilderData> m_builders;
-    std::set<WidgetGroup*> m_groups;
 
     friend struct WidgetGroup;
 
     explicit Widget(Construction construction);
     void childAdded(Widget* w);
-    int32_t applyLayoutRecursively(RectangleF rectangle);
+    int32_t applyLayoutRecursively(RectangleF rectangle, bool force);
 
     friend class Internal::LayoutEngine;
-    ClonablePtr<Internal::LayoutEngine> m_layoutEngine;
 
     void removeFromGroup(WidgetGroup* group);
 
@@ -1198,8 +1290,11 @@ private:
     void childRemoved(Ptr child);
 
     void processVisibility(bool isVisible);
-    void reposition(Point relativeOffset);
-    void refreshTree();
+    Point offsetOf(const Widget& child) const noexcept;
+    bool isPlacedInWindow() const noexcept;
+    int32_t placeInWindow();
+    void paintChild(Canvas& canvas, const Widget& child) const;
+    void deliverEvent(Event& event);
     void paintTree(RawCanvas& canvas);
 
     void doRestyle();
@@ -1233,11 +1328,11 @@ public:
     GUIProperty<3, AlignSelf, AffectLayout, &This::m_alignSelf> alignSelf;
     GUIProperty<4, PointL, AffectLayout, &This::m_anchor> anchor;
     GUIProperty<5, OptFloat, AffectLayout, &This::m_aspect> aspect;
-    GUIProperty<6, EasingFunction, None, &This::m_backgroundColorEasing> backgroundColorEasing;
-    GUIProperty<7, float, None, &This::m_backgroundColorTransition> backgroundColorTransition;
+    GUIProperty<6, EasingFunction, None, &Internal::WidgetCold::backgroundColorEasing> backgroundColorEasing;
+    GUIProperty<7, float, None, &Internal::WidgetCold::backgroundColorTransition> backgroundColorTransition;
     GUIProperty<8, ColorF, Transition, &This::m_backgroundColor> backgroundColor;
-    GUIProperty<9, EasingFunction, None, &This::m_borderColorEasing> borderColorEasing;
-    GUIProperty<10, float, None, &This::m_borderColorTransition> borderColorTransition;
+    GUIProperty<9, EasingFunction, None, &Internal::WidgetCold::borderColorEasing> borderColorEasing;
+    GUIProperty<10, float, None, &Internal::WidgetCold::borderColorTransition> borderColorTransition;
     GUIProperty<11, ColorF, Transition, &This::m_borderColor> borderColor;
     GUIProperty<12, Length, Resolvable | Inheritable, &This::m_borderRadius, &CornersL::x1y1, &CornersF::x1y1>
         borderRadiusTopLeft;
@@ -1252,8 +1347,8 @@ public:
     GUIProperty<18, Length, AffectLayout, &This::m_borderWidth, &EdgesL::x2, &EdgesF::x2> borderWidthRight;
     GUIProperty<19, Length, AffectLayout, &This::m_borderWidth, &EdgesL::y2, &EdgesF::y2> borderWidthBottom;
     GUIProperty<20, WidgetClip, None, &This::m_clip> clip;
-    GUIProperty<21, EasingFunction, None, &This::m_colorEasing> colorEasing;
-    GUIProperty<22, float, None, &This::m_colorTransition> colorTransition;
+    GUIProperty<21, EasingFunction, None, &Internal::WidgetCold::colorEasing> colorEasing;
+    GUIProperty<22, float, None, &Internal::WidgetCold::colorTransition> colorTransition;
     GUIProperty<23, ColorF, Transition | Inheritable, &This::m_color> color;
     GUIProperty<24, int, None, &This::m_corners> corners;
     GUIProperty<25, Cursor, None, &This::m_cursor> cursor;
@@ -1295,8 +1390,8 @@ public:
     GUIProperty<57, Placement, AffectLayout, &This::m_placement> placement;
     GUIProperty<58, Length, Resolvable | Inheritable, &This::m_shadowSize> shadowSize;
     GUIProperty<59, ColorF, Resolvable | Transition, &This::m_shadowColor> shadowColor;
-    GUIProperty<60, float, Resolvable, &This::m_shadowColorTransition> shadowColorTransition;
-    GUIProperty<61, EasingFunction, Resolvable, &This::m_shadowColorEasing> shadowColorEasing;
+    GUIProperty<60, float, Resolvable, &Internal::WidgetCold::shadowColorTransition> shadowColorTransition;
+    GUIProperty<61, EasingFunction, Resolvable, &Internal::WidgetCold::shadowColorEasing> shadowColorEasing;
     GUIProperty<62, Length, AffectLayout | Resolvable | AffectFont | Inheritable, &This::m_tabSize> tabSize;
     GUIProperty<63, TextAlign, Inheritable, &This::m_textAlign> textAlign;
     GUIProperty<64, TextAlign, Inheritable, &This::m_textVerticalAlign> textVerticalAlign;
@@ -1318,17 +1413,17 @@ public:
     GUIProperty<78, bool, None, &This::m_autoMouseCapture> autoMouseCapture;
     GUIProperty<79, bool, None, &This::m_mouseAnywhere> mouseAnywhere;
     GUIProperty<80, bool, None, &This::m_focusCapture> focusCapture;
-    GUIProperty<81, std::string, None, &This::m_description> description;
+    GUIProperty<81, std::string, None, &Internal::WidgetCold::description> description;
     GUIProperty<82, bool, None, &This::m_tabStop> tabStop;
     GUIProperty<83, bool, None, &This::m_tabGroup> tabGroup;
     GUIProperty<84, bool, None, &This::m_autofocus> autofocus;
-    GUIProperty<85, Trigger<>, None, &This::m_onClick> onClick;
-    GUIProperty<86, Trigger<>, None, &This::m_onDoubleClick> onDoubleClick;
-    GUIProperty<87, EventDelegate*, None, &This::m_delegate> delegate;
-    GUIProperty<88, std::string, None, &This::m_hint> hint;
+    GUIProperty<85, Trigger<>, None, &Internal::WidgetCold::onClick> onClick;
+    GUIProperty<86, Trigger<>, None, &Internal::WidgetCold::onDoubleClick> onDoubleClick;
+    GUIProperty<87, EventDelegate*, None, &Internal::WidgetCold::delegate> delegate;
+    GUIProperty<88, std::string, None, &Internal::WidgetCold::hint> hint;
     GUIProperty<89, std::shared_ptr<const Stylesheet>, AffectStyle, &This::m_stylesheet> stylesheet;
-    GUIProperty<90, Painter, None, &This::m_painter> painter;
-    GUIProperty<91, bool, None, &This::m_isHintExclusive> isHintExclusive;
+    GUIProperty<90, Painter, None, &Internal::WidgetCold::painter> painter;
+    GUIProperty<91, bool, None, &Internal::WidgetCold::isHintExclusive> isHintExclusive;
 
     GUIPropertyCompound<92, CornersL, &This::m_borderRadius, decltype(borderRadiusTopLeft),
                         decltype(borderRadiusTopRight), decltype(borderRadiusBottomLeft),
@@ -20,7 +20,10 @@
  */
 #pragma once
 #include "GUI.hpp"
+#include <atomic>
 #include <bit>
+#include <mutex>
+#include <brisk/core/Hash.hpp>
 
 namespace Brisk {
 
@@ -101,20 +104,18 @@ struct StyleProperty {
     {
         using Type = typename Tag::Type;
         name       = Tag::name();
-        apply      = [](RuleOp op, const StyleValuePtr& rule, Widget* widget, WidgetState state) {
-            if ((widget->state() & state) == state) {
-                if constexpr (PropertyTag<Tag>) {
-                    if constexpr (MatchesExtraTypes<Inherit, Tag>) {
-                        if (op == RuleOp::Inherit) {
-                            applier(widget, ArgVal<Tag, Inherit>{ inherit });
-                            return;
-                        }
+        apply      = [](RuleOp op, const StyleValuePtr& rule, Widget* widget) {
+            if constexpr (PropertyTag<Tag>) {
+                if constexpr (MatchesExtraTypes<Inherit, Tag>) {
+                    if (op == RuleOp::Inherit) {
+                        applier(widget, ArgVal<Tag, Inherit>{ inherit });
+                        return;
                     }
                 }
-                Type value;
-                get(value, op, rule, widget);
-                applier(widget, ArgVal<Tag>{ value });
             }
+            Type value;
+            get(value, op, rule, widget);
+            applier(widget, ArgVal<Tag>{ value });
         };
         toString = [](RuleOp op, const StyleValuePtr& rule) -> std::string {
             if (op == RuleOp::Inherit) {
@@ -145,7 +146,7 @@ struct StyleProperty {
         };
     }
 
-    using fn_apply = void (*)(RuleOp, const StyleValuePtr&, Widget*, WidgetState);
+    using fn_apply = void (*)(RuleOp, const StyleValuePtr&, Widget*);
     std::string_view name;
     fn_apply apply;
     using fn_toString = std::string (*)(RuleOp, const StyleValuePtr&);
@@ -163,6 +164,7 @@ const StyleProperty* styleProperty() {
 } // namespace Internal
 
 struct Rules;
+struct CompiledRules;
 
 struct Rule {
     template <typename Tag, typename U>
@@ -212,7 +214,8 @@ struct Rule {
     }
 
     void applyTo(Widget* widget) const {
-        m_property->apply(m_op, m_storage, widget, m_state);
+        if ((widget->state() & m_state) == m_state)
+            apply(widget);
     }
 
     std::string toString() const {
@@ -242,6 +245,13 @@ struct Rule {
 
 private:
     friend struct Rules;
+    friend struct CompiledRules;
+
+    // Applies the rule regardless of the widget state
+    void apply(Widget* widget) const {
+        m_property->apply(m_op, m_storage, widget);
+    }
+
     const Internal::StyleProperty* m_property;
     Internal::StyleValuePtr m_storage;
     WidgetState m_state;
@@ -338,8 +348,59 @@ concept Selector = requires(const Sel sel, Widget* w, MatchFlags f) {
     { sel.matches(w, f) } noexcept -> std::same_as<bool>;
 };
 
+// Kinds of simple selectors used to index stylesheets, from the most selective
+enum class KeyKind : uint8_t {
+    Id,
+    Class,
+    Type,
+    Role,
+    Count,
+};
+
+constexpr size_t operator+(KeyKind kind) noexcept {
+    return static_cast<size_t>(kind);
+}
+
+struct Key {
+    KeyKind kind;
+    std::string_view value;
+};
+
+// A widget can match a selector only if it has one of its keys. Empty if any widget can match
+using Keys = SmallVector<Key, 1>;
+
+// Widest part of the tree a selector depends on
+enum class Scope : uint8_t {
+    Self,   // type, id, role, classes and state of the widget, and the root flag
+    Parent, // the same properties of the widget and of its parent
+    Tree,   // anything else, e.g. the position among siblings
+};
+
+template <typename Sel>
+Keys selectorKeys(const Sel& sel) {
+    if constexpr (requires { sel.keys(); })
+        return sel.keys();
+    else
+        return {};
+}
+
+template <typename Sel>
+constexpr Scope selectorScope() {
+    if constexpr (requires { Sel::scope; })
+        return Sel::scope;
+    else
+        return Scope::Tree;
+}
+
+template <typename... Sel>
+constexpr Scope widestScope() {
+    return std::max({ Scope::Self, selectorScope<Sel>()... });
+}
+
 // *
 struct Universal {
+    constexpr static Scope scope = Scope::Self;
+
     bool matches(Widget*, MatchFlags) const noexcept {
         return true;
     }
@@ -347,6 +408,8 @@ struct Universal {
 
 // :root
 struct Root {
+    constexpr static Scope scope = Scope::Self;
+
     bool matches(Widget*, MatchFlags flags) const noexcept {
         return flags && MatchFlags::IsRoot;
     }
@@ -357,6 +420,7 @@ struct State {
     explicit State(WidgetState state) noexcept : state(state) {}
 
     WidgetState state;
+    constexpr static Scope scope = Scope::Self;
 
     bool matches(Widget* widget, MatchFlags) const noexcept {
         return (widget->state() & state) == state;
@@ -368,6 +432,11 @@ struct Type {
     explicit Type(std::string_view type) noexcept : type(type) {}
 
     std::string type;
+    constexpr static Scope scope = Scope::Self;
+
+    Keys keys() const {
+        return { Key{ KeyKind::Type, type } };
+    }
 
     bool matches(Widget* widget, MatchFlags) const noexcept {
         return widget->type() == type;
@@ -379,6 +448,11 @@ struct Role {
     explicit Role(std::string_view role) noexcept : role(role) {}
 
     std::string role;
+    constexpr static Scope scope = Scope::Self;
+
+    Keys keys() const {
+        return { Key{ KeyKind::Role, role } };
+    }
 
     bool matches(Widget* widget, MatchFlags) const noexcept {
         return widget->role.get() == role;
@@ -390,6 +464,11 @@ struct Id {
     explicit Id(std::string_view id) noexcept : id(id) {}
 
     std::string id;
+    constexpr static Scope scope = Scope::Self;
+
+    Keys keys() const {
+        return { Key{ KeyKind::Id, id } };
+    }
 
     bool matches(Widget* widget, MatchFlags) const noexcept {
         return widget->id.get() == id;
@@ -401,6 +480,11 @@ struct Class {
     explicit Class(std::string_view className) noexcept : className(className) {}
 
     std::string className;
+    constexpr static Scope scope = Scope::Self;
+
+    Keys keys() const {
+        return { Key{ KeyKind::Class, className } };
+    }
 
     bool matches(Widget* widget, MatchFlags) const noexcept {
         if (std::find(widget->classes.get().begin(), widget->classes.get().end(), className) ==
@@ -417,6 +501,7 @@ struct Parent {
     Parent(Sel&& selector) noexcept : selector(std::move(selector)) {}
 
     Sel selector;
+    constexpr static Scope scope = selectorScope<Sel>() == Scope::Self ? Scope::Parent : Scope::Tree;
 
     bool matches(Widget* widget, MatchFlags flags) const noexcept {
         return widget->parent() && selector.matches(widget->parent(), MatchFlags::None);
@@ -428,12 +513,32 @@ struct All {
     All(Selectors&&... selectors) noexcept : selectors(std::move(selectors)...) {}
 
     std::tuple<Selectors...> selectors;
+    constexpr static Scope scope = widestScope<Selectors...>();
+
+    // Every selector must match, so the keys of the most selective one are enough
+    Keys keys() const {
+        Keys result;
+        std::apply(
+            [&](const auto&... sel) {
+                (choose(result, selectorKeys(sel)), ...);
+            },
+            selectors);
+        return result;
+    }
 
     bool matches(Widget* widget, MatchFlags flags) const noexcept {
         return matchesInternal(std::index_sequence_for<Selectors...>{}, widget, flags);
     }
 
 private:
+    static void choose(Keys& best, Keys keys) {
+        if (keys.empty())
+            return;
+        if (best.empty() || keys.size() < best.size() ||
+            (keys.size() == best.size() && keys.front().kind < best.front().kind))
+            best = std::move(keys);
+    }
+
     template <size_t... Idx>
     bool matchesInternal(std::index_sequence<Idx...>, Widget* widget, MatchFlags flags) const noexcept {
         return (std::get<Idx>(selectors).matches(widget, flags) && ...);
@@ -450,12 +555,30 @@ struct Any {
     Any(Selectors&&... selectors) noexcept : selectors(std::move(selectors)...) {}
 
     std::tuple<Selectors...> selectors;
+    constexpr static Scope scope = widestScope<Selectors...>();
+
+    // Any selector may match, so all of them must be keyed
+    Keys keys() const {
+        Keys result;
+        bool keyed = true;
+        std::apply(
+            [&](const auto&... sel) {
+                (append(result, keyed, selectorKeys(sel)), ...);
+            },
+            selectors);
+        return keyed ? result : Keys{};
+    }
 
     bool matches(Widget* widget, MatchFlags flags) const noexcept {
         return matchesInternal(std::index_sequence_for<Selectors...>{}, widget, flags);
     }
 
 private:
+    static void append(Keys& result, bool& keyed, const Keys& keys) {
+        keyed = keyed && !keys.empty();
+        result.insert(result.end(), keys.begin(), keys.end());
+    }
+
     template <size_t... Idx>
     bool matchesInternal(std::index_sequence<Idx...>, Widget* widget, MatchFlags flags) const noexcept {
         return (std::get<Idx>(selectors).matches(widget, flags) || ...);
@@ -472,6 +595,7 @@ struct Not {
     Not(Sel&& sel) noexcept : sel(std::move(sel)) {}
 
     Sel sel;
+    constexpr static Scope scope = selectorScope<Sel>();
 
     bool matches(Widget* widget, MatchFlags flags) const noexcept {
         return !sel.matches(widget, flags);
@@ -549,8 +673,13 @@ inline Not<std::remove_cvref_t<Selector1>> operator!(Selector1&& x) {
 
 struct Selector {
     template <Selectors::Selector Sel>
-    Selector(Sel&& sel) : sel(std::make_shared<std::remove_cvref_t<Sel>>(std::move(sel))) {
-        match = [](const void* p, Widget* w, MatchFlags flags) {
+    Selector(Sel&& sel) {
+        auto stored = std::make_shared<std::remove_cvref_t<Sel>>(std::move(sel));
+        // Keys refer to the strings of the stored selector
+        indexKeys  = Selectors::selectorKeys(*stored);
+        matchScope = Selectors::selectorScope<std::remove_cvref_t<Sel>>();
+        this->sel  = std::move(stored);
+        match      = [](const void* p, Widget* w, MatchFlags flags) {
             return reinterpret_cast<const std::remove_cvref_t<Sel>*>(p)->matches(w, flags);
         };
     }
@@ -559,10 +688,20 @@ struct Selector {
         return match(sel.get(), widget, flags);
     }
 
+    const Selectors::Keys& keys() const noexcept {
+        return indexKeys;
+    }
+
+    Selectors::Scope scope() const noexcept {
+        return matchScope;
+    }
+
 private:
     std::shared_ptr<void> sel;
     using fn_match = bool (*)(const void*, Widget*, MatchFlags);
     fn_match match;
+    Selectors::Keys indexKeys;
+    Selectors::Scope matchScope;
 };
 
 struct Rules {
@@ -597,11 +736,67 @@ struct Rules {
     bool operator!=(const Rules&) const noexcept = default;
 };
 
+// Sorted rules with the rule in effect for each property resolved for each combination of the widget
+// states the rules depend on. A combination is resolved when a widget is first styled in it, after which
+// applying the rules takes no state checks and skips overridden rules.
+struct CompiledRules {
+    explicit CompiledRules(Rules rules);
+    ~CompiledRules();
+    CompiledRules(const CompiledRules&)            = delete;
+    CompiledRules& operator=(const CompiledRules&) = delete;
+
+    const Rules rules;
+
+    // Rules in effect for a widget in `state`, one per property, in the order of `rules`
+    std::span<const Rule* const> resolve(WidgetState state) const;
+
+    void applyTo(Widget* widget) const;
+
+    // Identifies rules by their properties, values and states. Rule sets with equal keys compile to the
+    // same tables
+    static std::string key(const Rules& rules);
+
+private:
+    using Variant = std::vector<const Rule*>;
+
+    const Variant& variant(uint32_t packed) const;
+
+    WidgetState m_stateMask = WidgetState::None; // States any rule depends on
+    // Indexed by the bits of m_stateMask packed together, null until resolved
+    std::unique_ptr<std::atomic<const Variant*>[]> m_variants;
+};
+
 struct Style {
     Selector selector;
     Rules rules;
 };
 
+namespace Internal {
+
+// Styles grouped by the keys of their selectors, and the rules matched for recently seen widgets or rule
+// sets.
+// Built on first use; a stylesheet should not be modified after it has been applied.
+struct StylesheetIndex {
+    StylesheetIndex() noexcept = default;
+
+    // Copies start with an empty index
+    StylesheetIndex(const StylesheetIndex&) noexcept {}
+
+    StylesheetIndex& operator=(const StylesheetIndex&) noexcept;
+
+    using KeyMap = std::unordered_map<std::string, std::vector<uint32_t>, StringHash, std::equal_to<>>;
+
+    std::mutex mutex;
+    bool built        = false;
+    size_t styleCount = 0;
+    std::array<KeyMap, +Selectors::KeyKind::Count> keyed;
+    std::vector<uint32_t> unkeyed;
+    std::unordered_map<std::string, std::shared_ptr<const CompiledRules>, StringHash, std::equal_to<>>
+        matched;
+};
+
+} // namespace Internal
+
 class Stylesheet : public std::vector<Style> {
 public:
     template <std::same_as<Style>... Args>
@@ -619,8 +814,15 @@ public:
 
     void stylize(Widget* widget, bool isRoot) const;
 
+    // Returns the merged rules of all styles matching the widget, including inherited ones.
+    // Widgets that look the same to all candidate selectors share the result.
+    std::shared_ptr<const CompiledRules> match(Widget* widget, bool isRoot) const;
+
 private:
-    void stylizeInternal(Rules& rules, Widget* widget, bool isRoot) const;
+    void stylizeInternal(Rules& rules, Selectors::Scope& scope, Widget* widget, bool isRoot) const;
+    void buildIndex() const;
+
+    mutable Internal::StylesheetIndex m_index;
 };
 
 template <typename T, int index>
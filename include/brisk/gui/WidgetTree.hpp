@@ -24,6 +24,7 @@
 #include <memory>
 #include <brisk/core/internal/Function.hpp>
 #include <brisk/core/Binding.hpp>
+#include <brisk/gui/internal/Animation.hpp>
 #include <brisk/graphics/Geometry.hpp>
 #include <stack>
 
@@ -37,8 +38,6 @@ struct WidgetGroup {
 
     ~WidgetGroup();
 
-    virtual void beforeRefresh() {}
-
     virtual void beforeFrame() {}
 
     virtual void beforeLayout(bool dirty) {}
@@ -50,16 +49,51 @@ struct WidgetGroup {
 
 using Drawable = function<void(Canvas&)>;
 
+class WorkerPool;
+
+namespace Internal {
+/// Receives the layers requested on this thread while a subtree is recorded in parallel
+extern thread_local std::vector<Drawable>* layerSink;
+} // namespace Internal
+
+/// Layout work done during the last frame
+struct LayoutStats {
+    uint32_t visited = 0; ///< Widgets whose rectangles were recomputed
+    uint32_t changed = 0; ///< Widgets whose rectangles actually changed
+};
+
 class WidgetTree {
 public:
+    WidgetTree() = default;
+    ~WidgetTree();
+
     std::shared_ptr<Widget> root() const noexcept;
     void setRoot(std::shared_ptr<Widget> root);
     void rescale();
     void onLayoutUpdated();
     uint32_t layoutCounter() const noexcept;
+    const LayoutStats& layoutStats() const noexcept;
 
     Rectangle viewportRectangle;
 
+    /// Arena for the widgets this tree builds: its builders and the root component of a window.
+    /// Null by default, which allocates them on the heap
+    const RC<MemoryArena>& arena() const noexcept;
+    void setArena(RC<MemoryArena> arena);
+
+    /// Makes the tree's arena current, if the tree has one
+    [[nodiscard]] MemoryArena::Scope arenaScope() const noexcept;
+
+    /// Pool used to record the paint commands of sibling subtrees in parallel. Null by default, which
+    /// paints on the calling thread. With a pool, paint() of widgets in different subtrees may run
+    /// concurrently; the resulting command stream is the same
+    WorkerPool* paintPool() const noexcept;
+    void setPaintPool(WorkerPool* pool);
+
+    /// Colour transitions running in this tree. Advanced once per frame by updateAndPaint; the tree
+    /// needs further frames only while the scheduler is active
+    const Internal::AnimationScheduler& animations() const noexcept;
+
     void updateAndPaint(Canvas& canvas);
     void requestLayer(Drawable drawable);
 
@@ -74,17 +108,26 @@ private:
     void requestAnimationFrame(std::weak_ptr<Widget> widget);
     void requestRebuild(std::weak_ptr<Widget> widget);
     void requestUpdateGeometry();
+    void requestWindowPlacement();
+    void updateWindowPlacement();
     void attach(Widget* widget);
     void detach(Widget* widget);
     void addGroup(WidgetGroup* group);
     void removeGroup(WidgetGroup* group);
+    // Declared before the root, which detaches its widgets from the scheduler when destroyed
+    Internal::AnimationScheduler m_animations;
     std::shared_ptr<Widget> m_root;
     std::vector<std::weak_ptr<Widget>> m_animationQueue;
     std::vector<std::weak_ptr<Widget>> m_rebuildQueue;
     std::vector<Drawable> m_layer;
-    uint32_t m_layoutCounter       = 0;
-    double m_refreshTime           = 0;
-    bool m_updateGeometryRequested = false;
+    uint32_t m_layoutCounter        = 0;
+    LayoutStats m_layoutStats;
+    bool m_updateGeometryRequested  = false;
+    bool m_windowPlacementRequested = false;
+    // Widgets whose position depends on the offset of scrolled ancestors
+    std::set<Widget*> m_windowPlaced;
     std::set<WidgetGroup*> m_groups;
+    RC<MemoryArena> m_arena;
+    WorkerPool* m_paintPool = nullptr;
 };
 } // namespace Brisk
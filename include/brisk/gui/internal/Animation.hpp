@@ -63,47 +63,80 @@ float easeLinear(float t);
 
 namespace Internal {
 
+class AnimationScheduler;
+
 template <typename T>
 struct Transition {
     Transition(T value) : current(value), stopValue(value) {}
 
-    constexpr static float disabled = -1;
-    float startTime                 = disabled;
+    /// A copy is never scheduled and starts at the target value of the original
+    Transition(const Transition& other) : current(other.stopValue), stopValue(other.stopValue) {}
+
+    Transition& operator=(const Transition&) = delete;
+
     T current;
-    T startValue;
     T stopValue;
 
-    bool set(T value, float transitionDuration) {
-        if (transitionDuration == 0) {
-            if (value == current)
-                return false;
-            current   = value;
-            stopValue = value;
-            startTime = disabled;
-            return true;
-        } else {
-            startTime  = frameStartTime;
-            startValue = current;
-            stopValue  = value;
-            return true;
-        }
-    }
-
-    void tick(float transitionDuration, EasingFunction easing) {
-        if (isActive()) {
-            float elapsed = frameStartTime - startTime;
-            if (elapsed >= transitionDuration) {
-                startTime = disabled;
-                current   = stopValue;
-            } else {
-                current = mix(easing(elapsed / transitionDuration), startValue, stopValue);
-            }
-        }
+    /// Jumps to @p value. Must not be called while the transition is scheduled
+    bool set(T value) {
+        if (value == current && value == stopValue)
+            return false;
+        current   = value;
+        stopValue = value;
+        return true;
     }
 
     bool isActive() const noexcept {
-        return startTime >= 0;
+        return slot >= 0;
     }
+
+private:
+    friend class AnimationScheduler;
+    int32_t slot = -1; ///< Index in the scheduler's arrays, -1 when not running
+};
+
+/// Advances running colour transitions against the frame timestamp.
+///
+/// Transitions live in struct-of-arrays storage and are advanced together once per frame, so the
+/// per-frame cost depends on the number of running transitions, not the number of widgets.
+/// Finished transitions leave the scheduler, which becomes idle when none are left
+class AnimationScheduler {
+public:
+    AnimationScheduler()                          = default;
+    AnimationScheduler(const AnimationScheduler&) = delete;
+
+    /// Moves @p transition towards @p value over @p duration seconds, starting at @p time from its
+    /// current value. A zero duration jumps to @p value and cancels the running transition.
+    /// Returns false if the transition already had this target
+    bool set(Transition<ColorF>& transition, ColorF value, double time, float duration,
+             EasingFunction easing);
+
+    /// Jumps to the target value and removes @p transition from the scheduler
+    void finish(Transition<ColorF>& transition);
+
+    /// Advances all transitions to @p time and writes back values that changed.
+    /// Returns the number of transitions whose current value changed
+    size_t tick(double time);
+
+    /// Returns true if any transition is running, i.e. another frame is needed
+    bool active() const noexcept;
+
+    /// Number of running transitions
+    size_t size() const noexcept;
+
+    /// Time at which the last running transition completes, or 0 if none is running
+    double finishTime() const noexcept;
+
+private:
+    void remove(size_t index);
+
+    std::vector<double> m_start;
+    std::vector<float> m_rate; ///< Reciprocal of the duration
+    std::vector<float> m_progress;
+    std::vector<EasingFunction> m_easing;
+    std::vector<ColorF> m_from;
+    std::vector<ColorF> m_to;
+    std::vector<Transition<ColorF>*> m_targets;
 };
 } // namespace Internal
 } // namespace Brisk
@@ -60,7 +60,7 @@ protected:
 
     std::optional<RepeatState> m_repeatState;
     void onEvent(Event& event) override;
-    void onRefresh() override;
+    void onAnimationFrame() override;
     virtual void onClicked();
     void doClick();
     Ptr cloneThis() override;
@@ -26,6 +26,19 @@
 
 namespace Brisk {
 
+namespace Internal {
+struct ImageDecodeTask;
+} // namespace Internal
+
+/**
+ * @brief Displays a raster image.
+ *
+ * Images given as encoded bytes are decoded on the shared worker pool once the widget has been laid
+ * out, scaled down to the displayed size. Decoded images are shared with other widgets through
+ * imageCache(). Only the background is painted until the image is ready.
+ * If the widget grows beyond the decoded size, the image is decoded again while the previous texture
+ * is still shown. A decode that hasn't started yet is skipped when the widget is destroyed.
+ */
 class WIDGET ImageView : public Widget {
 public:
     using Base                                   = Widget;
@@ -33,8 +46,7 @@ public:
 
     template <WidgetArgument... Args>
     ImageView(bytes_view image, const Args&... args)
-        : ImageView(Construction{ widgetType }, imageDecode(image, ImageFormat::RGBA).value(),
-                    std::tuple{ args... }) {
+        : ImageView(Construction{ widgetType }, image, std::tuple{ args... }) {
         endConstruction();
     }
 
@@ -44,13 +56,29 @@ public:
         endConstruction();
     }
 
+    /**
+     * @brief Returns the displayed image or nullptr if it hasn't been decoded yet.
+     */
+    const ImageHandle& texture() const noexcept;
+
 protected:
     ImageHandle m_texture;
+    RC<const bytes> m_encoded;
+    uint64_t m_source = 0;     // imageSourceId of m_encoded
+    Size m_decodedFor{ 0, 0 }; // Minimum size passed to the last decode
+    bool m_fullSize = false;   // m_texture has the original size, decoding again won't add detail
+    RC<Internal::ImageDecodeTask> m_decoding;
 
     void paint(Canvas& canvas) const override;
+    void onLayoutUpdated() override;
+    void onAnimationFrame() override;
     Ptr cloneThis() override;
+    void setTexture(RC<Image> image);
+    // Starts a decode if the widget is larger than the size the image was decoded for
+    void decodeIfTooSmall();
 
     ImageView(Construction construction, ImageHandle texture, ArgumentsView<ImageView> args);
+    ImageView(Construction construction, bytes_view image, ArgumentsView<ImageView> args);
 };
 
 class WIDGET SVGImageView final : public Widget {
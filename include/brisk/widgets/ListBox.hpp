@@ -22,6 +22,7 @@
 
 #include "ValueWidget.hpp"
 #include "Item.hpp"
+#include "VirtualList.hpp"
 
 namespace Brisk {
 
@@ -39,6 +40,7 @@ protected:
     void onEvent(Event& event) override;
     void onChanged() override;
     std::shared_ptr<Item> findSelected() const;
+    std::shared_ptr<VirtualList> virtualList() const;
     void append(Widget::Ptr widget) override;
     Ptr cloneThis() override;
     explicit ListBox(Construction construction, ArgumentsView<ListBox> args);
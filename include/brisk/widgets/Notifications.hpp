@@ -95,7 +95,8 @@ public:
 protected:
     RC<Notifications> m_notifications;
     void receive(RC<NotificationView> view);
-    void onRefresh() override;
+    void onAnimationFrame() override;
+    void onVisible() override;
     Ptr cloneThis() override;
 };
 } // namespace Brisk
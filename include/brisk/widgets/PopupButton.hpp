@@ -42,7 +42,6 @@ public:
 protected:
     using Button::close;
     void onClicked() override;
-    void onRefresh() override;
     void onChildAdded(Widget* w) override;
     Ptr cloneThis() override;
     explicit PopupButton(Construction construction, ArgumentsView<PopupButton> args);
@@ -46,7 +46,7 @@ protected:
     void onEvent(Event& event) override;
     void onLayoutUpdated() override;
     bool setScrollOffset(float value);
-    void updateOffsets();
+    virtual void updateOffsets();
     void createScrollBar();
     void revealChild(Widget* child) override;
 
@@ -103,6 +103,7 @@ public:
     std::array<WidthGroup, 32> columns;
 
 protected:
+    void assignColumns(Widget* row);
     Ptr cloneThis() override;
 
     explicit Table(Construction construction, ArgumentsView<Table> args);
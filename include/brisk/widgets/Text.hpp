@@ -57,12 +57,28 @@ protected:
     };
 
     struct Cached {
-        SizeF textSize;
         ShapedRuns prerendered;
     };
 
     Cached updateCache(const CacheKey&);
     CacheWithInvalidation<Cached, CacheKey, Text, &Text::updateCache> m_cache{ this };
+    // Measured without shaping into glyph runs, so layout doesn't prerender text that is never painted
+    SizeF updateTextSize(const CacheKey&);
+    CacheWithInvalidation<SizeF, CacheKey, Text, &Text::updateTextSize> m_textSize{ this };
+    uint32_t m_textVersion = 0; // Incremented when m_cache is invalidated
+
+    struct GeometryKey {
+        uint32_t textVersion = UINT32_MAX;
+        RectangleF rect; // Relative to the whole-pixel origin of the client rect
+        float alignX;
+        float alignY;
+        bool operator==(const GeometryKey&) const noexcept = default;
+    };
+
+    // Aligned glyph geometry, reused by paint until the text, font or layout rect changes
+    mutable GeometryKey m_geometryKey;
+    mutable optional<PreparedText> m_geometry;
+    const PreparedText& preparedText(RectangleF rect) const;
 
     void paint(Canvas& canvas) const override;
     optional<std::string> textContent() const override;
@@ -0,0 +1,195 @@
+/*
+ * Brisk
+ *
+ * Cross-platform application framework
+ * --------------------------------------------------------------
+ *
+ * Copyright (C) 2024 Brisk Developers
+ *
+ * This file is part of the Brisk library.
+ *
+ * Brisk is dual-licensed under the GNU General Public License, version 2 (GPL-2.0+),
+ * and a commercial license. You may use, modify, and distribute this software under
+ * the terms of the GPL-2.0+ license if you comply with its conditions.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * If you do not wish to be bound by the GPL-2.0+ license, you must purchase a commercial
+ * license. For commercial licensing options, please visit: https://brisklib.com
+ */
+#pragma once
+
+#include "ScrollBox.hpp"
+
+namespace Brisk {
+
+/**
+ * @brief Data source for VirtualList.
+ *
+ * The model reports the number of items and the extent of each item along the list orientation.
+ * Row widgets are created on demand and reused for different items as the list scrolls, so bind()
+ * must fully overwrite whatever a previous call has set.
+ */
+class ListModel {
+public:
+    virtual ~ListModel() = default;
+
+    /// Number of items in the model.
+    virtual size_t count() const = 0;
+
+    /// Extent of the item along the list orientation, in GUI pixels.
+    virtual float extent(size_t index) const = 0;
+
+    /// Returns true if every item has the extent of the first one.
+    /// Lets the list skip building the offset table.
+    virtual bool uniformExtent() const {
+        return false;
+    }
+
+    /// Creates a row widget that is not bound to any item yet.
+    virtual Widget::Ptr create() = 0;
+
+    /// Makes row display the item at index.
+    virtual void bind(Widget* row, size_t index) = 0;
+};
+
+/**
+ * @brief ListModel built from a fixed item extent and a pair of functions.
+ */
+class UniformListModel final : public ListModel {
+public:
+    using CreateFn = function<Widget::Ptr()>;
+    using BindFn   = function<void(Widget*, size_t)>;
+
+    UniformListModel(size_t count, float extent, CreateFn create, BindFn bind)
+        : m_count(count), m_extent(extent), m_create(std::move(create)), m_bind(std::move(bind)) {}
+
+    size_t count() const final {
+        return m_count;
+    }
+
+    float extent(size_t index) const final {
+        return m_extent;
+    }
+
+    bool uniformExtent() const final {
+        return true;
+    }
+
+    Widget::Ptr create() final {
+        return m_create();
+    }
+
+    void bind(Widget* row, size_t index) final {
+        m_bind(row, index);
+    }
+
+    void setCount(size_t count) {
+        m_count = count;
+    }
+
+private:
+    size_t m_count;
+    float m_extent;
+    CreateFn m_create;
+    BindFn m_bind;
+};
+
+/**
+ * @brief Scrollable list that materializes only the rows intersecting the viewport.
+ *
+ * Rows are placed absolutely and recycled on scroll: a row that leaves the viewport (plus overscan)
+ * is rebound to an item that enters it. Memory and per-frame cost depend on the viewport size only,
+ * not on the number of items. The list has no intrinsic size, so give it dimensions or flexGrow.
+ *
+ * Call reset() after the model contents change.
+ */
+class WIDGET VirtualList : public ScrollBox {
+public:
+    using Base                                   = ScrollBox;
+    constexpr static std::string_view widgetType = "virtuallist";
+
+    template <WidgetArgument... Args>
+    explicit VirtualList(RC<ListModel> model, const Args&... args)
+        : VirtualList(Construction{ widgetType }, Orientation::Vertical, std::move(model),
+                      std::tuple{ args... }) {
+        endConstruction();
+    }
+
+    template <WidgetArgument... Args>
+    explicit VirtualList(Orientation orientation, RC<ListModel> model, const Args&... args)
+        : VirtualList(Construction{ widgetType }, orientation, std::move(model), std::tuple{ args... }) {
+        endConstruction();
+    }
+
+    /// Rebuilds the offset table and rebinds every materialized row.
+    void reset();
+
+    /// Scrolls so that the item at index becomes the first visible one.
+    void scrollToItem(size_t index);
+
+    /// Scrolls the minimum amount needed to make the item at index fully visible.
+    void revealItem(size_t index);
+
+    /// Returns the row currently bound to the item at index, or nullptr if it is not materialized.
+    Widget::Ptr rowFor(size_t index) const;
+
+    /// Returns the index of the item row is bound to.
+    optional<size_t> itemIndex(const Widget* row) const;
+
+    /// Range of materialized items, [first, last).
+    std::pair<size_t, size_t> materializedRange() const noexcept;
+
+    /// Number of row widgets owned by the list, bound or spare.
+    size_t rowCount() const noexcept;
+
+protected:
+    RC<ListModel> m_model;
+    int m_overscan = 4;
+
+    void onModelChanged();
+    void onLayoutUpdated() override;
+    void updateOffsets() override;
+    void childrenAdded() override;
+    Ptr cloneThis() override;
+
+    explicit VirtualList(Construction construction, Orientation orientation, RC<ListModel> model,
+                         ArgumentsView<VirtualList> args);
+
+private:
+    constexpr static size_t unbound = SIZE_MAX;
+
+    // Prefix sums of item extents in GUI pixels, empty for uniform models
+    std::vector<double> m_offsets;
+    double m_uniformExtent = 0;
+    // Item index bound to each row; rows follow the non-row children in widgets()
+    std::vector<size_t> m_slots;
+    size_t m_slotsBegin = 0;
+    size_t m_count      = 0;
+    size_t m_first      = 0;
+    size_t m_last       = 0;
+    double m_anchor     = 0; // device pixels
+    bool m_dirty        = true;
+
+    double itemStart(size_t index) const;
+    size_t itemAt(double position) const;
+    void updateRows();
+    void placeRow(Widget* row, size_t index, double scale);
+
+public:
+    BRISK_PROPERTIES_BEGIN
+    Property<VirtualList, RC<ListModel>, &VirtualList::m_model, nullptr, nullptr,
+             &VirtualList::onModelChanged>
+        model;
+    Property<VirtualList, int, &VirtualList::m_overscan, nullptr, nullptr, &VirtualList::onModelChanged>
+        overscan;
+    BRISK_PROPERTIES_END
+};
+
+inline namespace Arg {
+constexpr inline Argument<Tag::PropArg<decltype(VirtualList::model)>> model{};
+constexpr inline Argument<Tag::PropArg<decltype(VirtualList::overscan)>> overscan{};
+} // namespace Arg
+
+} // namespace Brisk
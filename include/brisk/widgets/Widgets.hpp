@@ -60,3 +60,4 @@
 #include "ToggleButton.hpp"
 #include "ValueWidget.hpp"
 #include "Viewport.hpp"
+#include "VirtualList.hpp"
@@ -27,6 +27,8 @@ namespace Brisk {
 
 AutoSingleton<Bindings> bindings;
 
+static thread_local Bindings::CoalesceScope* coalesceScope = nullptr;
+
 int Bindings::addHandler(const RegionList& srcRegions, uint64_t id, Handler handler,
                          BindingAddresses srcAddresses, Region* destRegion, BindingAddress destAddress,
                          BindType type, std::string_view destDesc, std::string_view srcDesc,
@@ -34,47 +36,117 @@ int Bindings::addHandler(const RegionList& srcRegions, uint64_t id, Handler hand
 
     BRISK_ASSERT(srcRegions.size() == srcAddresses.size());
 
-    if (srcAddresses.size() == 1) [[likely]] {
-        // Handle single address case efficiently
-        Region& region         = *srcRegions.front();
-        BindingAddress address = srcAddresses.front();
-
-        region.entriesChanged  = true;
-        region.entries.insert(std::pair<BindingAddress, Entry>{
-            address,
-            Entry{
-                .id          = id,
-                .handler     = std::move(handler), // Use move semantics for handler
-                .destRegion  = destRegion,
-                .destAddress = destAddress,
-                .type        = type,
-                .destDesc    = destDesc,
-                .srcDesc     = srcDesc,
-                .srcQueue    = std::move(srcQueue),
-            },
+    // All source addresses of a connection share one handler
+    RC<const Handler> sharedHandler = std::make_shared<const Handler>(std::move(handler));
+    for (size_t i = 0; i < srcAddresses.size(); ++i) {
+        insertEntry(*srcRegions[i], Entry{
+                                        .srcAddress  = srcAddresses[i],
+                                        .id          = id,
+                                        .handler     = sharedHandler,
+                                        .destRegion  = destRegion,
+                                        .destAddress = destAddress,
+                                        .type        = type,
+                                        .destDesc    = destDesc,
+                                        .srcDesc     = srcDesc,
+                                        .srcQueue    = srcQueue,
+                                    });
+    }
+    return srcAddresses.size();
+}
+
+void Bindings::insertEntry(Region& region, Entry entry) {
+    // Connection ids grow monotonically, so entries stay sorted by source address and then by id
+    auto it = std::upper_bound(region.entries.begin(), region.entries.end(), entry.srcAddress.min,
+                               [](const uint8_t* min, const Entry& e) BRISK_INLINE_LAMBDA {
+                                   return min < e.srcAddress.min;
+                               });
+    updateFilter(entry.srcAddress, +1);
+    m_connections[entry.id].push_back({ &region, entry.srcAddress.min });
+    if (Region* dest = entry.destRegion) {
+        auto w = std::find_if(dest->writers.begin(), dest->writers.end(), [&](const auto& p) {
+            return p.first == &region;
         });
-    } else [[unlikely]] {
-        // Handle multiple source addresses
-        for (size_t i = 0; i < srcAddresses.size(); ++i) {
-            Region& region         = *srcRegions[i];
-            BindingAddress address = srcAddresses[i];
-            region.entriesChanged  = true;
-            region.entries.insert(std::pair<BindingAddress, Entry>{
-                address,
-                Entry{
-                    .id          = id,
-                    .handler     = handler, // Copy handler (no move)
-                    .destRegion  = destRegion,
-                    .destAddress = destAddress,
-                    .type        = type,
-                    .destDesc    = destDesc,
-                    .srcDesc     = srcDesc,
-                    .srcQueue    = srcQueue,
-                },
-            });
+        if (w != dest->writers.end())
+            ++w->second;
+        else
+            dest->writers.push_back({ &region, 1 });
+    }
+    ++m_numHandlers;
+    region.entries.insert(it, std::move(entry));
+    region.entriesChanged = true;
+}
+
+void Bindings::killEntry(Region& region, Entry& entry, bool updateConnections) {
+    updateFilter(entry.srcAddress, -1);
+    if (updateConnections) {
+        auto c = m_connections.find(entry.id);
+        if (c != m_connections.end()) {
+            auto r = std::find(c->second.begin(), c->second.end(),
+                               std::pair{ &region, entry.srcAddress.min });
+            if (r != c->second.end())
+                c->second.erase(r);
+            if (c->second.empty())
+                m_connections.erase(c);
         }
     }
-    return srcAddresses.size();
+    if (Region* dest = entry.destRegion) {
+        auto w = std::find_if(dest->writers.begin(), dest->writers.end(), [&](const auto& p) {
+            return p.first == &region;
+        });
+        if (w != dest->writers.end() && --w->second == 0)
+            dest->writers.erase(w);
+    }
+    --m_numHandlers;
+    // Dead entries keep their position and are skipped until the region is compacted
+    entry.handler = nullptr;
+    ++region.deadEntries;
+}
+
+void Bindings::compact(Region& region) {
+    if (region.deadEntries * 2 <= region.entries.size())
+        return;
+    std::erase_if(region.entries, [](const Entry& entry) BRISK_INLINE_LAMBDA {
+        return !entry.handler;
+    });
+    region.deadEntries    = 0;
+    region.entriesChanged = true;
+}
+
+template <typename Pred>
+void Bindings::eraseEntries(Region& region, Pred&& pred) {
+    for (Entry& entry : region.entries) {
+        if (entry.handler && pred(entry)) [[unlikely]]
+            killEntry(region, entry, true);
+    }
+    compact(region);
+}
+
+void Bindings::updateFilter(BindingAddress address, int delta) noexcept {
+    const uintptr_t first = reinterpret_cast<uintptr_t>(address.min) / filterGranule;
+    const uintptr_t last  = reinterpret_cast<uintptr_t>(std::max(address.max, address.min + 1) - 1) /
+                           filterGranule;
+    if (last - first >= filterMaxSpan) {
+        m_wideSources.fetch_add(delta, std::memory_order_relaxed);
+        return;
+    }
+    for (uintptr_t g = first; g <= last; ++g) {
+        m_filter[filterSlot(g)].fetch_add(delta, std::memory_order_relaxed);
+    }
+}
+
+bool Bindings::mayHaveHandlers(BindingAddress range) const noexcept {
+    if (m_wideSources.load(std::memory_order_relaxed)) [[unlikely]]
+        return true;
+    const uintptr_t first = reinterpret_cast<uintptr_t>(range.min) / filterGranule;
+    const uintptr_t last =
+        reinterpret_cast<uintptr_t>(std::max(range.max, range.min + 1) - 1) / filterGranule;
+    if (last - first >= filterMaxSpan) [[unlikely]]
+        return true;
+    for (uintptr_t g = first; g <= last; ++g) {
+        if (m_filter[filterSlot(g)].load(std::memory_order_relaxed))
+            return true;
+    }
+    return false;
 }
 
 bool Bindings::isRegisteredRegion(BindingAddress range) const {
@@ -98,15 +170,39 @@ void Bindings::unregisterRegion(const uint8_t* rangeBegin) {
     if (it == m_regions.end()) {
         BRISK_ASSERT(false); // Assert if the region is not found
     }
-    removeIndirectDependencies(it->second.get());
-    const BindingAddress range = it->second->region;
+    Region* region = it->second.get();
+    eraseEntries(*region, [](const Entry&) BRISK_INLINE_LAMBDA {
+        return true;
+    });
+    removeIndirectDependencies(region);
+    if (CoalesceScope* scope = coalesceScope) [[unlikely]] {
+        // The memory may be reused by another object before the scope dispatches
+        std::erase_if(scope->m_pending, [region](BindingAddress range) {
+            return region->region.contains(range.min);
+        });
+        std::erase_if(scope->m_seen, [region](const std::pair<const uint8_t*, const uint8_t*>& range) {
+            return region->region.contains(range.first);
+        });
+    }
     m_regions.erase(it);
 }
 
 int Bindings::notifyRange(BindingAddress range) {
+    // Fast path: most writes have no handlers and need neither the lock nor the region lookup
+    if (!mayHaveHandlers(range)) [[likely]]
+        return 0;
+    if (CoalesceScope* scope = coalesceScope) [[unlikely]] {
+        if (scope->m_seen.insert({ range.min, range.max }).second)
+            scope->m_pending.push_back(range);
+        return 0;
+    }
+    return dispatchRange(range);
+}
+
+int Bindings::dispatchRange(BindingAddress range) {
     int handlersCalled = 0;
     std::lock_guard lk(m_mutex);
-    ++m_counter;
+    const uint32_t counter = ++m_counter;
 
     RC<Region> region = lookupRegion(range);
     BRISK_ASSERT_MSG("notifyRange: region is not registered", region);
@@ -114,34 +210,36 @@ int Bindings::notifyRange(BindingAddress range) {
     do {
         region->entriesChanged = false;
 
-        auto first             = region->entries.begin();
-        auto last              = region->entries.lower_bound(BindingAddress{ range.max, range.max });
+        auto last = std::lower_bound(region->entries.begin(), region->entries.end(), range.max,
+                                     [](const Entry& e, const uint8_t* max) BRISK_INLINE_LAMBDA {
+                                         return e.srcAddress.min < max;
+                                     });
 
-        for (auto it = first; it != last; ++it) {
-            Entry& entry = it->second;
-            if (!it->first.intersects(range)) {
+        for (auto it = region->entries.begin(); it != last; ++it) {
+            Entry& entry = *it;
+            if (!entry.handler || !entry.srcAddress.intersects(range)) {
                 continue;
             }
-            if (inStack(entry.id) || entry.counter == m_counter) {
+            if (inStack(entry.id) || entry.counter == counter) {
                 // Skip handlers that are already processed
                 continue;
             }
-
+            entry.counter             = counter;
+            RC<const Handler> handler = entry.handler;
             {
                 m_stack.push_back(entry.id);
                 SCOPE_EXIT {
                     m_stack.pop_back();
                 };
                 unlock_guard ulk(m_mutex);
-                entry.handler(); // Execute the handler
+                (*handler)(); // Execute the handler
             }
-            entry.counter = m_counter;
             ++handlersCalled;
 
             if (region->entriesChanged) {
-                // If m_entries have changed during a call to handler(), we can no longer
-                // iterate through it with the current iterators.
-                // Exit the loop and start from the beginning of m_entries.
+                // If entries have changed during a call to handler(), we can no longer
+                // iterate through them with the current iterators.
+                // Exit the loop and start from the beginning of entries.
                 // Handlers that have already been called are skipped based on the counter value.
                 break;
             }
@@ -151,6 +249,20 @@ int Bindings::notifyRange(BindingAddress range) {
     return handlersCalled;
 }
 
+Bindings::CoalesceScope::CoalesceScope() : m_outermost(coalesceScope == nullptr) {
+    if (m_outermost)
+        coalesceScope = this;
+}
+
+Bindings::CoalesceScope::~CoalesceScope() {
+    if (!m_outermost)
+        return;
+    coalesceScope = nullptr;
+    for (BindingAddress range : m_pending) {
+        bindings->notifyRange(range);
+    }
+}
+
 static bool addressesContain(const BindingAddresses& a, BindingAddress r) {
     return std::find(a.begin(), a.end(), r) != a.end();
 }
@@ -186,11 +298,7 @@ void Bindings::enqueueInto(RC<Scheduler> queue, VoidFunc fn, ExecuteImmediately
 
 size_t Bindings::numHandlers() const noexcept {
     std::lock_guard lk(m_mutex);
-    size_t result = 0;
-    for (const auto& [k, region] : m_regions) {
-        result += region->entries.size();
-    }
-    return result;
+    return m_numHandlers;
 }
 
 size_t Bindings::numRegions() const noexcept {
@@ -203,70 +311,77 @@ bool Bindings::inStack(uint64_t id) {
 }
 
 void Bindings::removeConnection(uint64_t id) {
-    for (const auto& [k, region] : m_regions) {
-        region->disconnectIf([id](const std::pair<BindingAddress, Entry>& it) BRISK_INLINE_LAMBDA {
-            return it.second.id == id;
-        });
+    auto conn = m_connections.find(id);
+    if (conn == m_connections.end())
+        return;
+    SmallVector<std::pair<Region*, const uint8_t*>, 2> locations = std::move(conn->second);
+    m_connections.erase(conn);
+    for (const auto& [region, min] : locations) {
+        // Binary search by (source address, id) instead of scanning the region
+        auto byKey = [](const Entry& entry, std::pair<const uint8_t*, uint64_t> key) BRISK_INLINE_LAMBDA {
+            return std::pair{ entry.srcAddress.min, entry.id } < key;
+        };
+        auto it = std::lower_bound(region->entries.begin(), region->entries.end(), std::pair{ min, id },
+                                   byKey);
+        for (; it != region->entries.end() && it->srcAddress.min == min && it->id == id; ++it) {
+            if (it->handler) {
+                killEntry(*region, *it, false);
+                break;
+            }
+        }
+    }
+    for (const auto& [region, min] : locations) {
+        compact(*region);
     }
 }
 
 void Bindings::removeIndirectDependencies(Region* regionToRemove) {
-    for (const auto& [k, region] : m_regions) {
-        region->disconnectIf([regionToRemove](const std::pair<BindingAddress, Entry>& it)
-                                 BRISK_INLINE_LAMBDA {
-                                     return it.second.destRegion == regionToRemove;
-                                 });
+    // Only the regions that write into this one can hold such handlers
+    SmallVector<std::pair<Region*, uint32_t>, 1> writers = regionToRemove->writers;
+    for (const auto& [region, count] : writers) {
+        eraseEntries(*region, [regionToRemove](const Entry& entry) BRISK_INLINE_LAMBDA {
+            return entry.destRegion == regionToRemove;
+        });
     }
 }
 
 void Bindings::disconnect(BindingHandle handle) {
     std::lock_guard lk(m_mutex);
-    for (const auto& [k, region] : m_regions) {
-        region->disconnectIf([&](const std::pair<BindingAddress, Entry>& it) BRISK_INLINE_LAMBDA {
-            return it.second.id == handle.m_id;
-        });
-    }
-}
-
-void Bindings::Region::disconnectIf(std::function<bool(const std::pair<BindingAddress, Entry>&)> pred) {
-    for (auto it = entries.begin(); it != entries.end();) {
-        if (pred(*it)) [[unlikely]] {
-            entriesChanged = true;
-            it             = entries.erase(it); // Erase matching entries
-        } else {
-            ++it;
-        }
-    }
+    removeConnection(handle.m_id);
 }
 
 void Bindings::internalDisconnect(const BindingAddress& destAddress, const BindingAddresses& srcAddresses) {
-    for (const auto& [k, region] : m_regions) {
-        region->disconnectIf([&](const std::pair<BindingAddress, Entry>& it) BRISK_INLINE_LAMBDA {
-            return addressesContain(srcAddresses, it.first) && it.second.destAddress == destAddress;
-        });
+    for (BindingAddress srcAddress : srcAddresses) {
+        if (RC<Region> region = lookupRegion(srcAddress)) {
+            eraseEntries(*region, [&](const Entry& entry) BRISK_INLINE_LAMBDA {
+                return entry.srcAddress == srcAddress && entry.destAddress == destAddress;
+            });
+        }
     }
 }
 
 void Bindings::internalDisconnect(const BindingAddresses& addresses, BindDir dir) {
-    if (dir == BindDir::Dest) {
-        for (const auto& [k, region] : m_regions) {
-            region->disconnectIf([&](const std::pair<BindingAddress, Entry>& it) BRISK_INLINE_LAMBDA {
-                return addressesContain(addresses, it.second.destAddress);
-            });
-        }
-    } else if (dir == BindDir::Src) {
-        for (const auto& [k, region] : m_regions) {
-            region->disconnectIf([&](const std::pair<BindingAddress, Entry>& it) BRISK_INLINE_LAMBDA {
-                return addressesContain(addresses, it.first);
-            });
+    if (dir == BindDir::Src || dir == BindDir::Both) {
+        // Handlers live in the region of their source address
+        for (BindingAddress address : addresses) {
+            if (RC<Region> region = lookupRegion(address)) {
+                eraseEntries(*region, [&](const Entry& entry) BRISK_INLINE_LAMBDA {
+                    return addressesContain(addresses, entry.srcAddress);
+                });
+            }
         }
-    } else {
-        // Disconnect in both source and destination directions
-        for (const auto& [k, region] : m_regions) {
-            region->disconnectIf([&](const std::pair<BindingAddress, Entry>& it) BRISK_INLINE_LAMBDA {
-                return addressesContain(addresses, it.first) ||
-                       addressesContain(addresses, it.second.destAddress);
-            });
+    }
+    if (dir == BindDir::Dest || dir == BindDir::Both) {
+        for (BindingAddress address : addresses) {
+            RC<Region> destRegion = lookupRegion(address);
+            if (!destRegion)
+                continue;
+            SmallVector<std::pair<Region*, uint32_t>, 1> writers = destRegion->writers;
+            for (const auto& [region, count] : writers) {
+                eraseEntries(*region, [&](const Entry& entry) BRISK_INLINE_LAMBDA {
+                    return addressesContain(addresses, entry.destAddress);
+                });
+            }
         }
     }
 }
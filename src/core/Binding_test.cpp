@@ -513,4 +513,154 @@ TEST_CASE("Trigger after free") {
     }
 }
 
+// Test that writes inside a CoalesceScope produce one handler call per property
+TEST_CASE("Binding coalescing") {
+    struct {
+        int a = 0;
+        int b = 0;
+    } data;
+
+    BindingRegistration lt{ &data, nullptr };
+    int aCounter = 0, bCounter = 0;
+    bindings->listen(Value{ &data.a }, [&]() {
+        ++aCounter;
+    });
+    bindings->listen(Value{ &data.b }, [&]() {
+        ++bCounter;
+    });
+    Trigger<int> trigger;
+    BindingRegistration triggerLt{ &trigger, nullptr };
+    std::vector<int> triggered;
+    bindings->listen(Value{ &trigger }, [&](int value) {
+        triggered.push_back(value);
+    });
+
+    {
+        Bindings::CoalesceScope scope;
+        for (int i = 1; i <= 100; ++i) {
+            bindings->assign(data.a, i);
+        }
+        {
+            Bindings::CoalesceScope nested;
+            bindings->assign(data.b, 1);
+            bindings->assign(data.b, 2);
+        }
+        CHECK(aCounter == 0);
+        CHECK(bCounter == 0);
+
+        // Triggers carry an argument and are never postponed
+        trigger.trigger(1);
+        trigger.trigger(2);
+        CHECK(triggered == std::vector<int>{ 1, 2 });
+    }
+    CHECK(aCounter == 1);
+    CHECK(bCounter == 1);
+    CHECK(data.a == 100);
+
+    bindings->assign(data.a, 0);
+    CHECK(aCounter == 2);
+}
+
+// Test that notifications postponed for an object are dropped when the object is destroyed
+TEST_CASE("Binding coalescing with destroyed objects") {
+    int counter = 0;
+    {
+        Bindings::CoalesceScope scope;
+        auto b = std::make_unique<BObject>();
+        bindings->listen(Value{ &b->value }, [&]() {
+            ++counter;
+        });
+        bindings->assign(b->value, 1);
+        b.reset();
+
+        // An object reusing the memory doesn't receive the postponed notification either
+        auto reused = std::make_unique<BObject>();
+        bindings->listen(Value{ &reused->value }, [&]() {
+            ++counter;
+        });
+    }
+    CHECK(counter == 0);
+}
+
+// Test that connecting and disconnecting touches only the regions involved
+TEST_CASE("Binding many regions") {
+    constexpr int count = 1000;
+    std::vector<std::unique_ptr<BObject>> objects;
+    for (int i = 0; i < count; ++i) {
+        objects.push_back(std::make_unique<BObject>());
+    }
+    std::vector<BindingHandle> handles;
+    for (int i = 1; i < count; ++i) {
+        handles.push_back(bindings->connect(Value{ &objects[i]->value }, Value{ &objects[i - 1]->value },
+                                            BindType::Immediate, false));
+    }
+    CHECK(bindings->numHandlers() == count - 1);
+
+    // The value propagates down the whole chain
+    bindings->assign(objects[0]->value, 42);
+    CHECK(objects[count - 1]->value == 42);
+
+    bindings->disconnect(handles[count / 2]);
+    CHECK(bindings->numHandlers() == count - 2);
+    bindings->assign(objects[0]->value, 7);
+    CHECK(objects[count / 2]->value == 7);
+    CHECK(objects[count / 2 + 1]->value == 42);
+
+    // Destroying an object drops the handlers reading from it and writing into it
+    objects[10].reset();
+    CHECK(bindings->numHandlers() == count - 4);
+    objects.clear();
+    CHECK(bindings->numHandlers() == 0);
+    CHECK(bindings->numRegions() == 0);
+}
+
+TEST_CASE("Binding benchmarks", "[.benchmark]") {
+    std::vector<std::unique_ptr<BObject>> objects;
+    for (int i = 0; i < 10000; ++i) {
+        objects.push_back(std::make_unique<BObject>());
+    }
+    int counter = 0;
+    bindings->listen(Value{ &objects[0]->value }, [&counter]() {
+        ++counter;
+    });
+
+    BENCHMARK("Notify without handlers") {
+        for (auto& object : objects) {
+            bindings->notify(&object->value);
+        }
+        return objects.size();
+    };
+
+    BENCHMARK("Notify with a handler") {
+        for (int i = 0; i < 10000; ++i) {
+            bindings->notify(&objects[0]->value);
+        }
+        return counter;
+    };
+
+    BENCHMARK("Notify coalesced") {
+        Bindings::CoalesceScope scope;
+        for (int i = 0; i < 10000; ++i) {
+            bindings->notify(&objects[0]->value);
+        }
+        return counter;
+    };
+
+    for (int connections : { 1000, 10000 }) {
+        BENCHMARK("Connect, notify and disconnect " + std::to_string(connections)) {
+            std::vector<BindingHandle> handles;
+            handles.reserve(connections);
+            for (int i = 1; i < connections; ++i) {
+                handles.push_back(bindings->connect(Value{ &objects[i]->value }, Value{ &objects[0]->value },
+                                                    BindType::Immediate, false));
+            }
+            bindings->assign(objects[0]->value, objects[0]->value + 1);
+            for (BindingHandle& h : handles) {
+                bindings->disconnect(h);
+            }
+            return handles.size();
+        };
+    }
+}
+
 } // namespace Brisk
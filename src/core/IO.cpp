@@ -34,6 +34,8 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #endif
 #include <brisk/core/Text.hpp>
 #include <brisk/core/Utilities.hpp>
@@ -225,6 +227,34 @@ expected<bytes, IOError> readBytes(const fs::path& file_name) {
     });
 }
 
+#ifdef BRISK_POSIX
+MappedFile::~MappedFile() {
+    if (m_size > 0)
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+}
+
+expected<RC<MappedFile>, IOError> mapFile(const fs::path& file_name) {
+    int fd = ::open(file_name.string().c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return unexpected(posixToResult(errno));
+    SCOPE_EXIT {
+        ::close(fd);
+    };
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+        return unexpected(posixToResult(errno));
+    RC<MappedFile> result = rcnew MappedFile();
+    if (st.st_size == 0)
+        return result; // mmap doesn't accept zero length
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+        return unexpected(posixToResult(errno));
+    result->m_data = reinterpret_cast<const uint8_t*>(data);
+    result->m_size = st.st_size;
+    return result;
+}
+#endif
+
 expected<string, IOError> readUtf8(const fs::path& file_name, bool removeBOM) {
     return readBytes(file_name).map([removeBOM](const bytes& b) {
         if (removeBOM)
@@ -171,6 +171,48 @@ private:
     Win32Handle m_handle;
 };
 
+static IOError win32ToResult(DWORD code) {
+    switch (code) {
+    case ERROR_FILE_NOT_FOUND:
+    case ERROR_PATH_NOT_FOUND:
+        return IOError::NotFound;
+    case ERROR_ACCESS_DENIED:
+    case ERROR_SHARING_VIOLATION:
+        return IOError::AccessDenied;
+    default:
+        return IOError::UnknownError;
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (m_data)
+        UnmapViewOfFile(m_data);
+}
+
+expected<RC<MappedFile>, IOError> mapFile(const fs::path& file_name) {
+    Win32Handle file(CreateFileW(file_name.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr));
+    if (!file)
+        return unexpected(win32ToResult(GetLastError()));
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file.get(), &size))
+        return unexpected(win32ToResult(GetLastError()));
+    RC<MappedFile> result = rcnew MappedFile();
+    if (size.QuadPart == 0)
+        return result; // Empty files cannot be mapped
+    // The view keeps the mapping object alive after both handles are closed
+    HANDLE mapping = CreateFileMappingW(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping)
+        return unexpected(win32ToResult(GetLastError()));
+    const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!data)
+        return unexpected(win32ToResult(GetLastError()));
+    result->m_data = reinterpret_cast<const uint8_t*>(data);
+    result->m_size = size.QuadPart;
+    return result;
+}
+
 static REFKNOWNFOLDERID folderId(DefaultFolder folder) {
     switch (folder) {
     case DefaultFolder::Home:
@@ -0,0 +1,178 @@
+/*
+ * Brisk
+ *
+ * Cross-platform application framework
+ * --------------------------------------------------------------
+ *
+ * Copyright (C) 2024 Brisk Developers
+ *
+ * This file is part of the Brisk library.
+ *
+ * Brisk is dual-licensed under the GNU General Public License, version 2 (GPL-2.0+),
+ * and a commercial license. You may use, modify, and distribute this software under
+ * the terms of the GPL-2.0+ license if you comply with its conditions.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * If you do not wish to be bound by the GPL-2.0+ license, you must purchase a commercial
+ * license. For commercial licensing options, please visit: https://brisklib.com
+ */
+#include <brisk/core/Memory.hpp>
+#include <array>
+#include <bit>
+#include <mutex>
+#include <vector>
+
+namespace Brisk {
+
+namespace {
+
+// Every block is followed by a pointer to the arena state it came from (nullptr for the heap)
+using Tag = MemoryArena::State*;
+
+size_t tagOffset(size_t size) noexcept {
+    return alignUp(size, alignof(Tag));
+}
+
+Tag& blockTag(void* ptr, size_t size) noexcept {
+    return *reinterpret_cast<Tag*>(reinterpret_cast<uint8_t*>(ptr) + tagOffset(size));
+}
+
+size_t sizeClass(size_t size) noexcept {
+    return alignUp(tagOffset(size) + sizeof(Tag), MemoryArena::alignment) / MemoryArena::alignment;
+}
+
+// Free lists are kept for each alignment from MemoryArena::alignment to MemoryArena::maxAlignment
+constexpr size_t numAlignments =
+    std::countr_zero(MemoryArena::maxAlignment) - std::countr_zero(MemoryArena::alignment) + 1;
+
+size_t alignmentIndex(size_t blockAlignment) noexcept {
+    return std::countr_zero(blockAlignment) - std::countr_zero(MemoryArena::alignment);
+}
+
+size_t addressAlignmentIndex(const void* ptr) noexcept {
+    return alignmentIndex(
+        std::min(size_t(1) << std::countr_zero(reinterpret_cast<uintptr_t>(ptr)), MemoryArena::maxAlignment));
+}
+
+uint8_t* alignPointer(uint8_t* ptr, size_t blockAlignment) noexcept {
+    const uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+    return ptr + (alignUp(address, blockAlignment) - address);
+}
+
+thread_local MemoryArena* currentArena = nullptr;
+
+} // namespace
+
+struct MemoryArena::State {
+    std::mutex mutex;
+    size_t chunkSize;
+    std::vector<uint8_t*> chunks;
+    uint8_t* cursor   = nullptr;
+    uint8_t* end      = nullptr;
+    size_t liveBlocks = 0;
+    bool ownerAlive   = true;
+    // Singly linked lists of freed blocks, indexed by the alignment of their address and size class
+    std::array<std::array<void*, maxBlockSize / alignment + 2>, numAlignments> freeLists{};
+
+    explicit State(size_t chunkSize) : chunkSize(chunkSize) {}
+
+    ~State() {
+        for (uint8_t* chunk : chunks) {
+            alignedFree(chunk);
+        }
+    }
+
+    void* allocate(size_t cls, size_t blockAlignment) {
+        std::lock_guard lk(mutex);
+        ++liveBlocks;
+        // Any freed block aligned at least as strictly will do
+        for (size_t a = alignmentIndex(blockAlignment); a < numAlignments; ++a) {
+            if (void* block = freeLists[a][cls]) {
+                freeLists[a][cls] = *reinterpret_cast<void**>(block);
+                return block;
+            }
+        }
+        const size_t bytes = cls * alignment;
+        uint8_t* block     = cursor ? alignPointer(cursor, blockAlignment) : nullptr;
+        if (block == nullptr || end - block < static_cast<ptrdiff_t>(bytes)) {
+            block = alignedAlloc<uint8_t>(chunkSize, maxAlignment);
+            if (!block)
+                throw std::bad_alloc();
+            end = block + chunkSize;
+            chunks.push_back(block);
+        }
+        cursor = block + bytes;
+        return block;
+    }
+
+    // Returns true if the state must be destroyed by the caller
+    bool release(void* block, size_t cls) noexcept {
+        std::lock_guard lk(mutex);
+        void*& freeList                  = freeLists[addressAlignmentIndex(block)][cls];
+        *reinterpret_cast<void**>(block) = freeList;
+        freeList                         = block;
+        --liveBlocks;
+        return !ownerAlive && liveBlocks == 0;
+    }
+};
+
+MemoryArena::MemoryArena(size_t chunkSize)
+    : m_state(new State(alignUp(std::max(chunkSize, maxBlockSize + alignment), alignment))) {}
+
+MemoryArena::~MemoryArena() {
+    bool destroy;
+    {
+        std::lock_guard lk(m_state->mutex);
+        m_state->ownerAlive = false;
+        destroy             = m_state->liveBlocks == 0;
+    }
+    if (destroy)
+        delete m_state;
+}
+
+MemoryArena::Statistics MemoryArena::statistics() const {
+    std::lock_guard lk(m_state->mutex);
+    return { m_state->chunks.size(), m_state->chunks.size() * m_state->chunkSize, m_state->liveBlocks };
+}
+
+void* MemoryArena::allocate(size_t size, size_t blockAlignment) {
+    const size_t cls = sizeClass(size);
+    if (currentArena && size <= maxBlockSize && blockAlignment <= maxAlignment) {
+        State* state        = currentArena->m_state;
+        void* ptr           = state->allocate(cls, std::max(blockAlignment, alignment));
+        blockTag(ptr, size) = state;
+        return ptr;
+    }
+    void* ptr = alignedAlloc(cls * alignment, std::max(blockAlignment, alignof(Tag)));
+    if (!ptr)
+        throw std::bad_alloc();
+    blockTag(ptr, size) = nullptr;
+    return ptr;
+}
+
+void MemoryArena::deallocate(void* ptr, size_t size) noexcept {
+    if (!ptr)
+        return;
+    if (State* state = blockTag(ptr, size)) {
+        if (state->release(ptr, sizeClass(size)))
+            delete state;
+    } else {
+        alignedFree(ptr);
+    }
+}
+
+MemoryArena* MemoryArena::current() noexcept {
+    return currentArena;
+}
+
+MemoryArena::Scope::Scope(MemoryArena* arena) noexcept : m_saved(currentArena) {
+    currentArena = arena;
+}
+
+MemoryArena::Scope::~Scope() {
+    currentArena = m_saved;
+}
+
+} // namespace Brisk
@@ -0,0 +1,129 @@
+/*
+ * Brisk
+ *
+ * Cross-platform application framework
+ * --------------------------------------------------------------
+ *
+ * Copyright (C) 2024 Brisk Developers
+ *
+ * This file is part of the Brisk library.
+ *
+ * Brisk is dual-licensed under the GNU General Public License, version 2 (GPL-2.0+),
+ * and a commercial license. You may use, modify, and distribute this software under
+ * the terms of the GPL-2.0+ license if you comply with its conditions.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * If you do not wish to be bound by the GPL-2.0+ license, you must purchase a commercial
+ * license. For commercial licensing options, please visit: https://brisklib.com
+ */
+#include <catch2/catch_all.hpp>
+
+#include <brisk/core/Memory.hpp>
+#include <brisk/core/RC.hpp>
+#include <vector>
+
+using namespace Brisk;
+
+namespace {
+struct Node : public ArenaAllocation {
+    int value;
+    char payload[100];
+
+    explicit Node(int value) : value(value) {}
+};
+} // namespace
+
+TEST_CASE("MemoryArena") {
+    auto arena = std::make_unique<MemoryArena>(16384);
+    std::vector<RC<Node>> nodes;
+    {
+        MemoryArena::Scope scope(arena.get());
+        CHECK(MemoryArena::current() == arena.get());
+        for (int i = 0; i < 1000; ++i) {
+            nodes.push_back(rcnew Node(i));
+        }
+        {
+            MemoryArena::Scope heap(nullptr);
+            CHECK(MemoryArena::current() == nullptr);
+            RC<Node> onHeap = rcnew Node(-1);
+            CHECK(arena->statistics().liveBlocks == 2000);
+        }
+        CHECK(MemoryArena::current() == arena.get());
+    }
+    CHECK(MemoryArena::current() == nullptr);
+
+    // Object and control block
+    CHECK(arena->statistics().liveBlocks == 2000);
+    CHECK(arena->statistics().chunks > 1);
+    CHECK(reinterpret_cast<uintptr_t>(nodes[1].get()) % MemoryArena::alignment == 0);
+    for (int i = 0; i < 1000; ++i) {
+        CHECK(nodes[i]->value == i);
+    }
+    const size_t chunks = arena->statistics().chunks;
+
+    // Freed blocks are reused
+    nodes.resize(500);
+    {
+        MemoryArena::Scope scope(arena.get());
+        for (int i = 500; i < 1000; ++i) {
+            nodes.push_back(rcnew Node(i));
+        }
+    }
+    CHECK(arena->statistics().chunks == chunks);
+    CHECK(arena->statistics().liveBlocks == 2000);
+
+    // Blocks outlive the arena
+    arena.reset();
+    for (int i = 0; i < 1000; ++i) {
+        CHECK(nodes[i]->value == i);
+    }
+    nodes.clear();
+}
+
+TEST_CASE("MemoryArena large blocks") {
+    MemoryArena arena;
+    MemoryArena::Scope scope(&arena);
+    void* small = MemoryArena::allocate(MemoryArena::maxBlockSize);
+    void* large = MemoryArena::allocate(MemoryArena::maxBlockSize + 1);
+    CHECK(arena.statistics().liveBlocks == 1);
+    MemoryArena::deallocate(large, MemoryArena::maxBlockSize + 1);
+    MemoryArena::deallocate(small, MemoryArena::maxBlockSize);
+    CHECK(arena.statistics().liveBlocks == 0);
+}
+
+TEST_CASE("MemoryArena alignment") {
+    MemoryArena arena;
+    MemoryArena::Scope scope(&arena);
+    std::vector<std::pair<void*, size_t>> blocks;
+    for (size_t i = 0; i < 100; ++i) {
+        // Small blocks in between leave the chunk cursor at arbitrary 16-byte boundaries
+        blocks.emplace_back(MemoryArena::allocate(24, alignof(int)), 24);
+        void* aligned = MemoryArena::allocate(100, cacheAlignment);
+        CHECK(reinterpret_cast<uintptr_t>(aligned) % cacheAlignment == 0);
+        blocks.emplace_back(aligned, 100);
+    }
+    CHECK(arena.statistics().liveBlocks == 200);
+
+    // Freed blocks are reused only if they are aligned strictly enough
+    for (auto [ptr, size] : blocks) {
+        MemoryArena::deallocate(ptr, size);
+    }
+    blocks.clear();
+    for (size_t i = 0; i < 200; ++i) {
+        void* aligned = MemoryArena::allocate(100, cacheAlignment);
+        CHECK(reinterpret_cast<uintptr_t>(aligned) % cacheAlignment == 0);
+        blocks.emplace_back(aligned, 100);
+    }
+
+    // Stricter alignments than the arena supports are served from the heap
+    void* page = MemoryArena::allocate(100, 4096);
+    CHECK(reinterpret_cast<uintptr_t>(page) % 4096 == 0);
+    CHECK(arena.statistics().liveBlocks == 200);
+    MemoryArena::deallocate(page, 100);
+    for (auto [ptr, size] : blocks) {
+        MemoryArena::deallocate(ptr, size);
+    }
+    CHECK(arena.statistics().liveBlocks == 0);
+}
@@ -24,6 +24,8 @@
 #include <brisk/core/Utilities.hpp>
 
 #include <brisk/core/internal/Lock.hpp>
+#include <condition_variable>
+#include <deque>
 #include <concurrentqueue/concurrentqueue.h>
 #include <readerwriterqueue/readerwriterqueue.h>
 #include "uv.hpp"
@@ -158,6 +160,143 @@ void Scheduler::waitForCompletion() {
     waitFuture(completionFuture(), 0);
 }
 
+namespace {
+struct ParallelJob {
+    const function<void(size_t)>* fn;
+    function<void(size_t)> owned; // Used by submitted tasks that outlive the caller
+    size_t count;
+    std::atomic_size_t next{ 0 };
+    std::atomic_size_t done{ 0 };
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::exception_ptr exception;
+
+    // Runs one call. Returns false if all calls have been claimed already
+    bool runOne() {
+        const size_t index = next.fetch_add(1, std::memory_order_relaxed);
+        if (index >= count)
+            return false;
+        try {
+            (*fn)(index);
+        } catch (...) {
+            std::lock_guard lk(mutex);
+            if (!exception)
+                exception = std::current_exception();
+        }
+        if (done.fetch_add(1, std::memory_order_acq_rel) + 1 == count) {
+            std::lock_guard lk(mutex);
+            finished.notify_all();
+        }
+        return true;
+    }
+};
+} // namespace
+
+struct WorkerPool::Impl {
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::shared_ptr<ParallelJob>> jobs;
+    bool stopping = false;
+
+    void threadBody() {
+        setThreadName("Brisk Worker");
+        std::unique_lock lk(mutex);
+        for (;;) {
+            wake.wait(lk, [this]() {
+                return stopping || !jobs.empty();
+            });
+            if (stopping)
+                return;
+            std::shared_ptr<ParallelJob> job = jobs.front();
+            lk.unlock();
+            while (job->runOne()) {
+            }
+            lk.lock();
+            // All calls of the job are claimed, let the other threads move on
+            if (!jobs.empty() && jobs.front() == job)
+                jobs.pop_front();
+        }
+    }
+};
+
+WorkerPool::WorkerPool(size_t numThreads) : m_impl(new Impl()) {
+    m_impl->threads.reserve(numThreads);
+    for (size_t i = 0; i < numThreads; ++i) {
+        m_impl->threads.emplace_back(&Impl::threadBody, m_impl.get());
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard lk(m_impl->mutex);
+        m_impl->stopping = true;
+    }
+    m_impl->wake.notify_all();
+    for (std::thread& thread : m_impl->threads) {
+        thread.join();
+    }
+}
+
+size_t WorkerPool::threadCount() const noexcept {
+    return m_impl->threads.size();
+}
+
+void WorkerPool::parallelFor(size_t count, const function<void(size_t)>& fn) {
+    if (count == 0)
+        return;
+    auto job   = std::make_shared<ParallelJob>();
+    job->fn    = &fn;
+    job->count = count;
+    // A single call or an empty pool runs on the calling thread only
+    const bool shared = count > 1 && !m_impl->threads.empty();
+    if (shared) {
+        {
+            std::lock_guard lk(m_impl->mutex);
+            m_impl->jobs.push_back(job);
+        }
+        m_impl->wake.notify_all();
+    }
+
+    while (job->runOne()) {
+    }
+    {
+        std::unique_lock lk(job->mutex);
+        job->finished.wait(lk, [&]() {
+            return job->done.load(std::memory_order_acquire) == count;
+        });
+    }
+    if (shared) {
+        std::lock_guard lk(m_impl->mutex);
+        std::erase(m_impl->jobs, job);
+    }
+    if (job->exception)
+        std::rethrow_exception(job->exception);
+}
+
+void WorkerPool::submit(VoidFunc fn) {
+    if (m_impl->threads.empty()) {
+        BRISK_SUPPRESS_EXCEPTIONS(fn());
+        return;
+    }
+    auto job   = std::make_shared<ParallelJob>();
+    job->owned = [fn = std::move(fn)](size_t) {
+        BRISK_SUPPRESS_EXCEPTIONS(fn());
+    };
+    job->fn    = &job->owned;
+    job->count = 1;
+    {
+        std::lock_guard lk(m_impl->mutex);
+        m_impl->jobs.push_back(std::move(job));
+    }
+    m_impl->wake.notify_one();
+}
+
+WorkerPool& workerPool() {
+    static WorkerPool pool(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+    return pool;
+}
+
 RC<TaskQueue> mainScheduler;
 
 thread_local Scheduler* threadScheduler = nullptr;
@@ -0,0 +1,114 @@
+/*
+ * Brisk
+ *
+ * Cross-platform application framework
+ * --------------------------------------------------------------
+ *
+ * Copyright (C) 2024 Brisk Developers
+ *
+ * This file is part of the Brisk library.
+ *
+ * Brisk is dual-licensed under the GNU General Public License, version 2 (GPL-2.0+),
+ * and a commercial license. You may use, modify, and distribute this software under
+ * the terms of the GPL-2.0+ license if you comply with its conditions.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * If you do not wish to be bound by the GPL-2.0+ license, you must purchase a commercial
+ * license. For commercial licensing options, please visit: https://brisklib.com
+ */
+#include <brisk/core/Threading.hpp>
+#include <catch2/catch_all.hpp>
+#include "Catch2Utils.hpp"
+#include <set>
+
+namespace Brisk {
+
+TEST_CASE("WorkerPool") {
+    for (size_t numThreads : { 0, 1, 4 }) {
+        WorkerPool pool(numThreads);
+        CHECK(pool.threadCount() == numThreads);
+
+        std::vector<int> values(1000, 0);
+        pool.parallelFor(values.size(), [&](size_t i) {
+            values[i] += int(i);
+        });
+        for (size_t i = 0; i < values.size(); ++i) {
+            CHECK(values[i] == int(i));
+        }
+
+        pool.parallelFor(0, [](size_t) {
+            FAIL("must not be called");
+        });
+
+        // Nested calls don't deadlock
+        std::atomic_int total{ 0 };
+        pool.parallelFor(8, [&](size_t) {
+            pool.parallelFor(8, [&](size_t) {
+                ++total;
+            });
+        });
+        CHECK(total == 64);
+
+        // Exceptions are rethrown after all calls have finished
+        std::atomic_int calls{ 0 };
+        CHECK_THROWS_AS(pool.parallelFor(100,
+                                         [&](size_t i) {
+                                             ++calls;
+                                             if (i == 50)
+                                                 throw std::runtime_error("failed");
+                                         }),
+                        std::runtime_error);
+        CHECK(calls == 100);
+    }
+}
+
+TEST_CASE("WorkerPool uses several threads") {
+    WorkerPool pool(3);
+    std::mutex mutex;
+    std::set<std::thread::id> ids;
+    pool.parallelFor(64, [&](size_t) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::lock_guard lk(mutex);
+        ids.insert(std::this_thread::get_id());
+    });
+    CHECK(ids.size() > 1);
+}
+
+TEST_CASE("WorkerPool submit") {
+    {
+        WorkerPool pool(0);
+        bool called = false;
+        pool.submit([&]() {
+            called = true;
+        });
+        CHECK(called);
+    }
+
+    std::promise<std::thread::id> promise;
+    std::future<std::thread::id> future = promise.get_future();
+    std::atomic_bool release{ false };
+    WorkerPool pool(2);
+    pool.submit([]() {
+        throw std::runtime_error("suppressed");
+    });
+    pool.submit([&]() {
+        promise.set_value(std::this_thread::get_id());
+    });
+    CHECK(future.get() != std::this_thread::get_id());
+
+    // Fork-join work still progresses while a task occupies a worker
+    pool.submit([&]() {
+        while (!release)
+            std::this_thread::yield();
+    });
+    std::atomic_int calls{ 0 };
+    pool.parallelFor(16, [&](size_t) {
+        ++calls;
+    });
+    CHECK(calls == 16);
+    release = true;
+}
+
+} // namespace Brisk
@@ -70,6 +70,10 @@ Canvas::Canvas(RenderContext& context) : RawCanvas(context), m_state(defaultStat
 
 Canvas::Canvas(RawCanvas& canvas) : RawCanvas(canvas), m_state(defaultState) {}
 
+Canvas::Canvas(RenderContext& context, const Canvas& canvas) : RawCanvas(context), m_state(canvas.m_state) {
+    RawCanvas::m_state = canvas.RawCanvas::m_state;
+}
+
 const Paint& Canvas::getStrokePaint() const {
     return m_state.strokePaint;
 }
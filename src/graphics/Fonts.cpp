@@ -20,6 +20,7 @@
  */
 #include <brisk/graphics/Fonts.hpp>
 #include <map>
+#include <random>
 #include <brisk/core/Log.hpp>
 #include <brisk/core/Time.hpp>
 #include <brisk/core/Utilities.hpp>
@@ -27,6 +28,12 @@
 #include <brisk/core/internal/Fixed.hpp>
 #include <brisk/core/IO.hpp>
 #include <brisk/core/Text.hpp>
+#include <brisk/core/Threading.hpp>
+#include <brisk/core/App.hpp>
+#include <brisk/core/Json.hpp>
+#include <brisk/core/internal/SmallVector.hpp>
+#include <numeric>
+#include "GlyphCache.hpp"
 
 #include <utf8proc.h>
 
@@ -127,12 +134,49 @@ static GlyphCacheKey glyphCacheKey(float fontSize, uint32_t glyphIndex) {
 
 const static Range<float> nullRange{ HUGE_VALF, -HUGE_VALF };
 
+// Advance of a text segment shaped on its own
+struct SegmentAdvance {
+    float advance;
+    bool safeStart; // Shaping result doesn't depend on the preceding text
+    bool safeEnd;   // Shaping result doesn't depend on the following text
+};
+
+using SegmentCacheKey = std::tuple<FTFixed, hb_script_t, std::u32string>;
+
+// Transparent hash and equality, so that lookups don't need to copy the segment text
+struct SegmentCacheHash {
+    using is_transparent = void;
+
+    template <typename Key>
+    size_t operator()(const Key& key) const {
+        return fastHash(std::u32string_view(std::get<2>(key)),
+                        (uint64_t(uint32_t(std::get<0>(key))) << 32) | uint32_t(std::get<1>(key)));
+    }
+};
+
+struct SegmentCacheEqual {
+    using is_transparent = void;
+
+    template <typename Key1, typename Key2>
+    bool operator()(const Key1& a, const Key2& b) const {
+        return std::get<0>(a) == std::get<0>(b) && std::get<1>(a) == std::get<1>(b) &&
+               std::u32string_view(std::get<2>(a)) == std::u32string_view(std::get<2>(b));
+    }
+};
+
+constexpr size_t maxSegmentCacheSize = 4096;
+
 struct FontFace {
     FontManager* manager;
     FontFlags flags;
-    FT_Face face;
-    hb_font_t* hb_font;
+    FT_Face face       = nullptr; // Created by load() on first use
+    hb_font_t* hb_font = nullptr;
     Bytes bytes;
+    RC<MappedFile> mapping;
+    bytes_view fileData;
+    function<bytes_view()> loader; // Produces fileData on first use for faces registered by a loader
+    bool loadFailed      = false;
+    uint64_t contentHash = 0; // Computed on first use of the glyph disk cache
 
     struct GlyphDataAndTime : GlyphData {
         double time;
@@ -145,6 +189,7 @@ struct FontFace {
 
     std::unordered_map<GlyphCacheKey, GlyphDataAndTime, FastHash> cache;
     std::map<uint32_t, SizeData> sizes;
+    std::unordered_map<SegmentCacheKey, SegmentAdvance, SegmentCacheHash, SegmentCacheEqual> segmentCache;
     FT_Fixed xHeight                     = 0;
     FT_Fixed capHeight                   = 0;
 
@@ -160,18 +205,49 @@ struct FontFace {
         for (auto& s : sizes) {
             HANDLE_FT_ERROR_SOFT(FT_Done_Size(s.second.ftSize), continue);
         }
-        HANDLE_FT_ERROR_SOFT(FT_Done_Face(face), return);
+        if (face)
+            HANDLE_FT_ERROR_SOFT(FT_Done_Face(face), return);
     }
 
-    explicit FontFace(FontManager* manager, bytes_view data, bool makeCopy, FontFlags flags)
-        : manager(manager), flags(flags) {
+    explicit FontFace(FontManager* manager, bytes_view data, bool makeCopy, FontFlags flags,
+                      RC<MappedFile> mapping = nullptr)
+        : manager(manager), flags(flags), mapping(std::move(mapping)) {
         if (makeCopy) {
             bytes = Bytes(data.begin(), data.end());
             data  = bytes;
         }
-        HANDLE_FT_ERROR(FT_New_Memory_Face(static_cast<FT_Library>(manager->m_ft_library),
-                                           (const FT_Byte*)data.data(), data.size(), 0, &face));
-        HANDLE_FT_ERROR(FT_Select_Charmap(face, FT_ENCODING_UNICODE));
+        fileData = data;
+    }
+
+    explicit FontFace(FontManager* manager, function<bytes_view()> loader, FontFlags flags)
+        : manager(manager), flags(flags), loader(std::move(loader)) {}
+
+    // Parses the face, producing its data first if needed. Registering a face only records where its
+    // data is, so faces that are never used are never decompressed or parsed
+    bool load() {
+        if (face)
+            return true;
+        if (loadFailed)
+            return false;
+        if (loader) {
+            fileData = loader();
+            loader   = nullptr;
+        }
+        FT_Face newFace;
+        FT_Library library = static_cast<FT_Library>(manager->m_ft_library);
+        if (FT_Error error = FT_New_Memory_Face(library, (const FT_Byte*)fileData.data(), fileData.size(), 0,
+                                                &newFace)) {
+            handleFTErrSoft(error);
+            loadFailed = true;
+            return false;
+        }
+        if (FT_Error error = FT_Select_Charmap(newFace, FT_ENCODING_UNICODE)) {
+            handleFTErrSoft(error);
+            FT_Done_Face(newFace);
+            loadFailed = true;
+            return false;
+        }
+        face = newFace;
 
         FT_Matrix matrix = { toFixed16(1.0f / HORIZONTAL_OVERSAMPLING * manager->m_hscale), toFixed16(0),
                              toFixed16(0), toFixed16(1.0f) };
@@ -188,6 +264,7 @@ struct FontFace {
         setSize(toFixed6(10));
 
         hb_font = hb_ft_font_create_referenced(face);
+        return true;
     }
 
     bool setSize(uint32_t sz) {
@@ -196,6 +273,8 @@ struct FontFace {
     }
 
     SizeData lookupSize(float fontSize) {
+        if (!load())
+            return { nullptr, {} };
         uint32_t sz = toFixed6(fontSize);
 
         auto it     = sizes.find(sz);
@@ -232,6 +311,7 @@ struct FontFace {
 
     void clearCache() {
         cache.clear();
+        segmentCache.clear();
     }
 
     GlyphID codepointToGlyph(char32_t codepoint) const {
@@ -252,15 +332,32 @@ struct FontFace {
         return numRemoved;
     }
 
+    GlyphDiskKey glyphDiskKey(float fontSize, GlyphID glyphIndex) {
+        if (contentHash == 0)
+            contentHash = fastHash(fileData) | 1;
+        return { contentHash, glyphIndex, toFixed6(fontSize), uint32_t(manager->m_hscale),
+                 flags && FontFlags::DisableHinting ? GlyphDiskCache::NoHinting : 0 };
+    }
+
     optional<GlyphData> loadGlyphCached(float fontSize, GlyphID glyphIndex) {
+        if (!load())
+            return nullopt;
         if (auto it = cache.find(glyphCacheKey(fontSize, glyphIndex)); it != cache.end()) {
             it->second.time = currentTime();
             return it->second;
         } else {
-            std::ignore              = lookupSize(fontSize);
-            optional<GlyphData> data = loadGlyph(glyphIndex);
-            if (!data.has_value())
-                return nullopt;
+            GlyphDiskCache* diskCache = manager->m_glyphDiskCache.get();
+            optional<GlyphData> data;
+            if (diskCache)
+                data = diskCache->load(glyphDiskKey(fontSize, glyphIndex));
+            if (!data.has_value()) {
+                std::ignore = lookupSize(fontSize);
+                data        = loadGlyph(glyphIndex);
+                if (!data.has_value())
+                    return nullopt;
+                if (diskCache)
+                    diskCache->store(glyphDiskKey(fontSize, glyphIndex), *data);
+            }
 
             it              = cache.insert(it, std::pair<Internal::GlyphCacheKey, GlyphDataAndTime>{
                                       glyphCacheKey(fontSize, glyphIndex),
@@ -317,6 +414,66 @@ struct FontFace {
     }
 };
 
+// Resolves codepoints to the faces of a (possibly merged) font family in constant time.
+// Coverage is built lazily from the cmap tables, one page of 256 codepoints at a time. Within a page,
+// a face is consulted (and loaded) only once a codepoint is missing from all the faces before it.
+struct CodepointFallback {
+    static constexpr uint32_t pageBits = 8;
+    static constexpr uint32_t pageSize = 1u << pageBits;
+    static constexpr uint32_t numPages = 0x110000 >> pageBits;
+    static constexpr uint8_t noFace    = UINT8_MAX;
+
+    struct Page {
+        std::array<uint8_t, pageSize> slots; // Indices into faces
+        uint8_t scannedFaces = 0;            // Faces whose coverage has been filled in
+    };
+
+    inline_vector<FontFace*, maxFontsInMergedFonts> faces; // nullptr for missing faces
+    std::vector<std::unique_ptr<Page>> pages;
+
+    explicit CodepointFallback(inline_vector<FontFace*, maxFontsInMergedFonts> faces)
+        : faces(std::move(faces)), pages(numPages) {}
+
+    FontFace* lookup(char32_t codepoint, bool fallbackToUndef) {
+        if (codepoint < U' ')
+            return nullptr;
+        if (codepoint < 0x110000) {
+            const uint32_t pageIndex    = codepoint >> pageBits;
+            std::unique_ptr<Page>& page = pages[pageIndex];
+            if (!page) {
+                page.reset(new Page);
+                page->slots.fill(noFace);
+            }
+            uint8_t& slot = page->slots[codepoint & (pageSize - 1)];
+            while (slot == noFace && page->scannedFaces < faces.size())
+                scanFace(*page, pageIndex, page->scannedFaces++);
+            if (slot != noFace)
+                return faces[slot];
+        }
+        if (!fallbackToUndef)
+            return nullptr;
+        FontFace* undef = faces.front();
+        return undef && undef->load() ? undef : nullptr;
+    }
+
+    // Earlier faces take precedence, so only unassigned slots are filled
+    void scanFace(Page& page, uint32_t pageIndex, uint8_t index) const {
+        if (!faces[index] || !faces[index]->load())
+            return;
+        const FT_ULong first = pageIndex << pageBits;
+        FT_Face face         = faces[index]->face;
+        FT_UInt glyph;
+        FT_ULong codepoint =
+            first == 0 ? FT_Get_First_Char(face, &glyph) : FT_Get_Next_Char(face, first - 1, &glyph);
+        while (glyph != 0 && codepoint < first + pageSize) {
+            uint8_t& slot = page.slots[codepoint - first];
+            if (slot == noFace)
+                slot = index;
+            codepoint = FT_Get_Next_Char(face, codepoint, &glyph);
+        }
+    }
+};
+
 struct Caret {
     LayoutOptions options;
     float lineHeight = 1.f;
@@ -356,8 +513,15 @@ struct Caret {
 
 using namespace Internal;
 
+static fs::path defaultFontIndexPath() {
+    return defaultFolder(DefaultFolder::UserData) /
+           (appMetadata.vendor.empty() ? "Brisk" : appMetadata.vendor) /
+           (appMetadata.name.empty() ? "App" : appMetadata.name) / "font_index.msgpack";
+}
+
 FontManager::FontManager(std::recursive_mutex* mutex, int hscale, uint32_t cacheTimeMs)
-    : m_lock(mutex), m_hscale(hscale), m_cacheTimeMs(cacheTimeMs) {
+    : m_lock(mutex), m_hscale(hscale), m_cacheTimeMs(cacheTimeMs), m_fontFolders(fontFolders()),
+      m_fontIndexPath(defaultFontIndexPath()) {
     HANDLE_FT_ERROR(FT_Init_FreeType(&reinterpret_cast<FT_Library&>(m_ft_library)));
 }
 
@@ -374,33 +538,26 @@ inline_vector<FontFamily, maxFontsInMergedFonts> FontManager::fontList(FontFamil
     return { ff };
 }
 
-std::pair<Internal::FontFace*, GlyphID> FontManager::lookupCodepoint(const Font& font, char32_t codepoint,
-                                                                     bool fallbackToUndef) const {
-    if (codepoint < U' ')
-        return { nullptr, UINT32_MAX };
-    auto list = fontList(font.fontFamily);
-    for (int offset = 0; offset < list.size(); ++offset) {
-        auto it = m_fonts.find(FontKey{ list[offset], font.style, font.weight });
-        if (it != m_fonts.end()) {
-            GlyphID id = FT_Get_Char_Index(it->second->face, (FT_ULong)(codepoint));
-            if (id != 0)
-                return { it->second.get(), id };
+Internal::CodepointFallback& FontManager::codepointFallback(const Font& font) const {
+    FontKey key{ font.fontFamily, font.style, font.weight };
+    auto it = m_codepointFallback.find(key);
+    if (it == m_codepointFallback.end()) {
+        inline_vector<FontFace*, maxFontsInMergedFonts> faces;
+        for (FontFamily family : fontList(font.fontFamily)) {
+            auto f = m_fonts.find(FontKey{ family, font.style, font.weight });
+            faces.push_back(f != m_fonts.end() ? f->second.get() : nullptr);
         }
+        it = m_codepointFallback
+                 .insert_or_assign(key, std::unique_ptr<CodepointFallback>(new CodepointFallback(faces)))
+                 .first;
     }
-    if (fallbackToUndef) {
-        auto it = m_fonts.find(FontKey{ list[0], font.style, font.weight });
-        if (it != m_fonts.end()) {
-            return { it->second.get(), 0 };
-        }
-    }
-
-    return { nullptr, UINT32_MAX };
+    return *it->second;
 }
 
 Internal::FontFace* FontManager::lookup(const Font& font) const {
     auto list = fontList(font.fontFamily);
     auto it   = m_fonts.find(FontKey{ list[0], font.style, font.weight });
-    if (it == m_fonts.end())
+    if (it == m_fonts.end() || !it->second->load())
         return nullptr;
     return it->second.get();
 }
@@ -417,24 +574,54 @@ FontManager::FontKey FontManager::faceToKey(Internal::FontFace* face) const {
 void FontManager::addMergedFont(FontFamily font, std::initializer_list<FontFamily> families) {
     lock_quard_cond lk(m_lock);
     m_mergedFonts[font] = inline_vector<FontFamily, maxFontsInMergedFonts>(families);
+    m_codepointFallback.clear();
 }
 
 void FontManager::addFont(FontFamily font, FontStyle style, FontWeight weight, bytes_view data, bool makeCopy,
                           FontFlags flags) {
     lock_quard_cond lk(m_lock);
     FontKey key{ font, style, weight };
+    m_codepointFallback.clear();
     m_fonts.insert_or_assign(key, std::unique_ptr<FontFace>(new FontFace(this, data, makeCopy, flags)));
 }
 
+void FontManager::addFont(FontFamily font, FontStyle style, FontWeight weight, function<bytes_view()> loader,
+                          FontFlags flags) {
+    lock_quard_cond lk(m_lock);
+    FontKey key{ font, style, weight };
+    m_codepointFallback.clear();
+    m_fonts.insert_or_assign(key, std::unique_ptr<FontFace>(new FontFace(this, std::move(loader), flags)));
+}
+
+RC<MappedFile> FontManager::mapFontFile(const fs::path& path) const {
+    if (auto it = m_mappedFiles.find(path); it != m_mappedFiles.end()) {
+        if (RC<MappedFile> mapping = it->second.lock())
+            return mapping;
+    }
+    expected<RC<MappedFile>, IOError> mapping = mapFile(path);
+    if (!mapping)
+        return nullptr;
+    m_mappedFiles.insert_or_assign(path, *mapping);
+    return *mapping;
+}
+
 status<IOError> FontManager::addFontFromFile(FontFamily family, FontStyle style, FontWeight weight,
                                              const fs::path& path) {
     lock_quard_cond lk(m_lock);
-    expected<bytes, IOError> b = readBytes(path);
-    if (b) {
+    // Faces loaded from the same file share one read-only mapping
+    RC<MappedFile> mapping = mapFontFile(path);
+    if (!mapping) {
+        expected<bytes, IOError> b = readBytes(path);
+        if (!b)
+            return unexpected(b.error());
         addFont(family, style, weight, *b);
         return {};
     }
-    return unexpected(b.error());
+    FontKey key{ family, style, weight };
+    m_codepointFallback.clear();
+    m_fonts.insert_or_assign(key, std::unique_ptr<FontFace>(new FontFace(this, mapping->data(), false,
+                                                                         FontFlags::Default, mapping)));
+    return {};
 }
 
 static bool cmpi(string_view a, string_view b) {
@@ -463,6 +650,12 @@ static optional<OSFont> fontQuickInfo(FT_Library library, const fs::path& path)
     if (face->family_name == nullptr)
         return nullopt;
     font.family = face->family_name;
+    if (TT_OS2* os2 = (TT_OS2*)FT_Get_Sfnt_Table(face, FT_SFNT_OS2)) {
+        font.unicodeRanges = { static_cast<uint32_t>(os2->ulUnicodeRange1),
+                               static_cast<uint32_t>(os2->ulUnicodeRange2),
+                               static_cast<uint32_t>(os2->ulUnicodeRange3),
+                               static_cast<uint32_t>(os2->ulUnicodeRange4) };
+    }
     if (face->style_name != nullptr) {
         std::string_view styleName = face->style_name;
         std::vector<std::string_view> extraStyles;
@@ -499,24 +692,226 @@ static optional<OSFont> fontQuickInfo(FT_Library library, const fs::path& path)
     return font;
 }
 
+namespace {
+
+// Persistent record of a scanned font file. An entry is reused as long as
+// the file size and modification time are unchanged.
+struct FontIndexEntry {
+    std::string path;
+    int64_t modified;
+    uint64_t size;
+    std::string family;
+    FontStyle style   = FontStyle::Normal;
+    FontWeight weight = FontWeight::Regular;
+    std::string styleName;
+    std::array<uint32_t, 4> unicodeRanges{};
+
+    inline static const std::tuple Reflection = {
+        ReflectionField{ "path", &FontIndexEntry::path },
+        ReflectionField{ "modified", &FontIndexEntry::modified },
+        ReflectionField{ "size", &FontIndexEntry::size },
+        ReflectionField{ "family", &FontIndexEntry::family },
+        ReflectionField{ "style", &FontIndexEntry::style },
+        ReflectionField{ "weight", &FontIndexEntry::weight },
+        ReflectionField{ "styleName", &FontIndexEntry::styleName },
+        ReflectionField{ "unicodeRanges", &FontIndexEntry::unicodeRanges },
+    };
+};
+
+constexpr int fontIndexVersion = 1;
+
+std::map<std::string, FontIndexEntry> loadFontIndex(const fs::path& indexPath) {
+    std::map<std::string, FontIndexEntry> result;
+    if (indexPath.empty())
+        return result;
+    expected<Json, IOError> json = readMsgpack(indexPath);
+    if (!json || json->getItem<int>("version").value_or(0) != fontIndexVersion)
+        return result;
+    std::vector<FontIndexEntry> entries;
+    if (!json->getItemTo("fonts", entries))
+        return result;
+    for (FontIndexEntry& e : entries) {
+        std::string key = e.path;
+        result.insert_or_assign(std::move(key), std::move(e));
+    }
+    return result;
+}
+
+void saveFontIndex(const fs::path& indexPath, const std::vector<FontIndexEntry>& entries) {
+    if (indexPath.empty())
+        return;
+    std::error_code ec;
+    fs::create_directories(indexPath.parent_path(), ec);
+    Json json = JsonObject{};
+    json.setItem("version", fontIndexVersion);
+    json.setItem("fonts", entries);
+    // Write to a unique file and rename it over the index so that concurrent
+    // processes never observe a partially written index
+    fs::path tmpPath = indexPath;
+    tmpPath += fmt::format(".{:08X}.tmp", std::random_device{}());
+    if (!writeMsgpack(tmpPath, json)) {
+        fs::remove(tmpPath, ec);
+        return;
+    }
+    fs::rename(tmpPath, indexPath, ec);
+    if (ec)
+        fs::remove(tmpPath, ec);
+}
+
+} // namespace
+
+// Lists the fonts in `folders`, reusing the index at `indexPath` for files that haven't changed
+static std::vector<OSFont> scanFontFolders(FT_Library library, const std::vector<fs::path>& folders,
+                                           const fs::path& indexPath) {
+    std::vector<OSFont> result;
+    std::map<std::string, FontIndexEntry> index = loadFontIndex(indexPath);
+    std::vector<FontIndexEntry> entries;
+    bool indexChanged = false;
+    for (const fs::path& folder : folders) {
+        std::error_code ec;
+        for (auto it = fs::recursive_directory_iterator(folder, fs::directory_options::skip_permission_denied,
+                                                        ec);
+             !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+            const fs::directory_entry& f = *it;
+            if (!f.is_regular_file(ec) || !isFontExt(f.path().extension().string()))
+                continue;
+            std::error_code statEc;
+            uint64_t size    = f.file_size(statEc);
+            int64_t modified = f.last_write_time(statEc).time_since_epoch().count();
+            if (statEc)
+                continue;
+            std::string key = f.path().string();
+            if (auto cached = index.find(key); cached != index.end() && cached->second.size == size &&
+                                               cached->second.modified == modified) {
+                FontIndexEntry& e = cached->second;
+                if (!e.family.empty()) {
+                    result.push_back(
+                        OSFont{ e.family, e.style, e.weight, e.styleName, f.path(), e.unicodeRanges });
+                }
+                entries.push_back(std::move(e));
+                index.erase(cached);
+                continue;
+            }
+            indexChanged = true;
+            FontIndexEntry e{ key, modified, size };
+            if (optional<OSFont> fontInfo = fontQuickInfo(library, f.path())) {
+                e.family        = fontInfo->family;
+                e.style         = fontInfo->style;
+                e.weight        = fontInfo->weight;
+                e.styleName     = fontInfo->styleName;
+                e.unicodeRanges = fontInfo->unicodeRanges;
+                result.push_back(std::move(*fontInfo));
+            }
+            // Files that FreeType can't open are indexed with an empty family to avoid rescanning them
+            entries.push_back(std::move(e));
+        }
+    }
+    // Entries left in the index refer to removed files
+    if (indexChanged || !index.empty())
+        saveFontIndex(indexPath, entries);
+    return result;
+}
+
 std::vector<OSFont> FontManager::installedFonts(bool rescan) const {
     lock_quard_cond lk(m_lock);
-    if (m_osFonts.empty() || rescan) {
+    if (rescan) {
+        // Both scans would write the index
+        if (m_osFontsScan.valid())
+            m_osFontsScan.wait();
         m_osFonts.clear();
-        for (fs::path path : fontFolders()) {
-            for (auto f : fs::directory_iterator(path)) {
-                if (f.is_regular_file() && isFontExt(f.path().extension().string())) {
-                    if (optional<OSFont> fontInfo =
-                            fontQuickInfo(static_cast<FT_Library>(m_ft_library), f.path())) {
-                        m_osFonts.push_back(std::move(*fontInfo));
-                    }
-                }
-            }
+        m_osFontsScan = {};
+    }
+    if (m_osFonts.empty()) {
+        if (m_osFontsScan.valid()) {
+            // The background scan doesn't take the lock
+            m_osFonts     = m_osFontsScan.get();
+            m_osFontsScan = {};
+        } else {
+            m_osFonts =
+                scanFontFolders(static_cast<FT_Library>(m_ft_library), m_fontFolders, m_fontIndexPath);
         }
     }
     return m_osFonts;
 }
 
+void FontManager::scanInstalledFonts() {
+    lock_quard_cond lk(m_lock);
+    if (!m_osFonts.empty() || m_osFontsScan.valid())
+        return;
+    // FreeType libraries can't be shared between threads, so the scan opens its own
+    auto task = std::make_shared<std::packaged_task<std::vector<OSFont>()>>(
+        [folders = m_fontFolders, indexPath = m_fontIndexPath]() -> std::vector<OSFont> {
+            FT_Library library;
+            HANDLE_FT_ERROR(FT_Init_FreeType(&library));
+            SCOPE_EXIT {
+                FT_Done_FreeType(library);
+            };
+            return scanFontFolders(library, folders, indexPath);
+        });
+    m_osFontsScan = task->get_future().share();
+    workerPool().submit([task]() {
+        (*task)();
+    });
+}
+
+bool FontManager::installedFontsReady() const {
+    lock_quard_cond lk(m_lock);
+    if (!m_osFonts.empty())
+        return true;
+    return m_osFontsScan.valid() &&
+           m_osFontsScan.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+void FontManager::setFontFolders(std::vector<fs::path> folders) {
+    lock_quard_cond lk(m_lock);
+    // The next scan would write the index while a scan in progress still does
+    if (m_osFontsScan.valid())
+        m_osFontsScan.wait();
+    m_fontFolders = std::move(folders);
+    m_osFonts.clear();
+    m_osFontsScan = {};
+}
+
+void FontManager::setFontIndexPath(fs::path path) {
+    lock_quard_cond lk(m_lock);
+    if (m_osFontsScan.valid())
+        m_osFontsScan.wait();
+    m_fontIndexPath = std::move(path);
+    m_osFontsScan   = {};
+}
+
+void FontManager::setWorkerPool(WorkerPool* pool) {
+    lock_quard_cond lk(m_lock);
+    m_workerPool = pool;
+}
+
+// Identifies the rasterizer, glyphs rendered by a different FreeType version are not reused
+static uint64_t glyphCacheSalt(FT_Library library) {
+    FT_Int version[5]{ 0, 0, 0, HORIZONTAL_OVERSAMPLING, DPI };
+    FT_Library_Version(library, &version[0], &version[1], &version[2]);
+    return fastHash(version);
+}
+
+void FontManager::setGlyphCachePath(fs::path path, uintmax_t maxSize) {
+    lock_quard_cond lk(m_lock);
+    m_glyphDiskCache.reset();
+    if (!path.empty())
+        m_glyphDiskCache.reset(new GlyphDiskCache(std::move(path), maxSize,
+                                                  glyphCacheSalt(static_cast<FT_Library>(m_ft_library))));
+}
+
+void FontManager::flushGlyphCache() {
+    lock_quard_cond lk(m_lock);
+    if (m_glyphDiskCache) {
+        if (status<IOError> result = m_glyphDiskCache->flush(); !result)
+            LOG_WARN(font, "Unable to write glyph cache: {}", result.error());
+    }
+}
+
+WorkerPool& FontManager::layoutPool() const {
+    return m_workerPool ? *m_workerPool : workerPool();
+}
+
 bool FontManager::addSystemFont(FontFamily fontFamily) {
     lock_quard_cond lk(m_lock);
     fs::path path = fontFolders().front();
@@ -562,7 +957,7 @@ std::vector<FontStyleAndWeight> FontManager::fontFamilyStyles(FontFamily font) c
 
 bool FontManager::hasCodepoint(const Font& font, char32_t codepoint) const {
     lock_quard_cond lk(m_lock);
-    return lookupCodepoint(font, codepoint, false).first != nullptr;
+    return codepointFallback(font).lookup(codepoint, false) != nullptr;
 }
 
 FontMetrics FontManager::metrics(const Font& font) const {
@@ -650,9 +1045,9 @@ std::vector<Internal::TextRun> FontManager::splitControls(
 // Assign fonts to text runs
 std::vector<TextRun> FontManager::assignFontsToTextRuns(const Font& font, std::u32string_view text,
                                                         const std::vector<TextRun>& textRuns) const {
-
+    CodepointFallback& fallback = codepointFallback(font);
     return Internal::splitRuns(text, textRuns, [&](char32_t ch) -> Internal::FontFace* {
-        return lookupCodepoint(font, ch, true).first;
+        return fallback.lookup(ch, true);
     });
 }
 #else
@@ -661,17 +1056,18 @@ std::vector<TextRun> FontManager::assignFontsToTextRuns(const Font& font, std::u
                                                         const std::vector<TextRun>& textRuns) const {
     std::vector<TextRun> newTextRuns;
     newTextRuns.reserve(textRuns.size());
+    CodepointFallback& fallback = codepointFallback(font);
     for (const TextRun& t : textRuns) {
         if (t.end == t.begin)
             continue;
 
-        Internal::FontFace* face          = lookupCodepoint(font, text[t.begin], true).first;
+        Internal::FontFace* face          = fallback.lookup(text[t.begin], true);
         int32_t start                     = t.begin;
         std::vector<TextRun>::iterator it = newTextRuns.end();
 
         for (int32_t i = t.begin + 1; i < t.end; ++i) {
             char32_t codepoint          = text[i];
-            Internal::FontFace* newFace = lookupCodepoint(font, codepoint, true).first;
+            Internal::FontFace* newFace = fallback.lookup(codepoint, true);
             if (newFace != face) {
                 // TODO: correct t.visualOrder
                 it = newTextRuns.insert(it, TextRun{ t.direction, start, i, t.visualOrder, face });
@@ -720,13 +1116,76 @@ static bool isPrintable(char32_t ch) {
     }
 }
 
+// Shapes text[run.begin, run.end) with run.face using the rest of the text as context
+static void shapeText(hb_buffer_t* buffer, const Font& font, std::u32string_view text, const TextRun& run,
+                      hb_script_t script = HB_SCRIPT_INVALID,
+                      hb_buffer_flags_t bufferFlags = HB_BUFFER_FLAG_DEFAULT) {
+    hb_buffer_reset(buffer);
+    hb_buffer_set_flags(buffer, bufferFlags);
+
+    hb_buffer_add_codepoints(buffer, (const uint32_t*)text.data(), text.size(), run.begin,
+                             run.end - run.begin);
+    hb_buffer_set_direction(buffer,
+                            run.direction == TextDirection::LTR ? HB_DIRECTION_LTR : HB_DIRECTION_RTL);
+    hb_buffer_set_script(buffer, script);
+    hb_buffer_guess_segment_properties(buffer);
+
+    std::vector<hb_feature_t> features;
+    bool kernSet = false;
+    for (OpenTypeFeatureFlag feat : font.features) {
+        if (feat.feature == OpenTypeFeature::kern) {
+            kernSet = true;
+        }
+        features.push_back(hb_feature_t{
+            fontFeatures[+feat.feature],
+            feat.enabled ? 1u : 0u,
+            HB_FEATURE_GLOBAL_START,
+            HB_FEATURE_GLOBAL_END,
+        });
+    }
+    FontFlags flags = run.face->flags;
+    if (font.letterSpacing > 0) {
+        flags |= FontFlags::DisableLigatures;
+    }
+    if (!kernSet && (flags && FontFlags::DisableKerning)) {
+        features.push_back(hb_feature_t{
+            fontFeatures[+OpenTypeFeature::kern],
+            0u,
+            HB_FEATURE_GLOBAL_START,
+            HB_FEATURE_GLOBAL_END,
+        });
+    }
+    if ((flags && FontFlags::DisableLigatures)) {
+        using enum OpenTypeFeature;
+        for (OpenTypeFeature feature : { liga, clig, kern }) {
+            features.push_back(hb_feature_t{
+                fontFeatures[+feature],
+                0u,
+                HB_FEATURE_GLOBAL_START,
+                HB_FEATURE_GLOBAL_END,
+            });
+        }
+    }
+
+    std::ignore = run.face->lookupSize(font.fontSize);
+
+    hb_shape(run.face->hb_font, buffer, features.data(), features.size());
+}
+
+// Shapes textRuns lying within text[begin, end). The range must start and end at a paragraph boundary
 ShapedRuns FontManager::shapeRuns(const Font& font, const TextWithOptions& text,
-                                  const std::vector<TextRun>& textRuns) const {
+                                  const std::vector<TextRun>& textRuns, int32_t begin, int32_t end,
+                                  const FontMetrics& metrics) const {
     ShapedRuns shaped;
     shaped.options = text.options;
     std::vector<int32_t> textBreaks;
-    if (!(text.options && LayoutOptions::SingleLine))
-        textBreaks = textBreakPositions(text.text, TextBreakMode::Line);
+    if (!(text.options && LayoutOptions::SingleLine)) {
+        textBreaks = textBreakPositions(std::u32string_view(text.text).substr(begin, end - begin),
+                                        TextBreakMode::Line);
+        for (int32_t& pos : textBreaks) {
+            pos += begin;
+        }
+    }
 
     std::unique_ptr<hb_buffer_t, hb_buffer_deleter> hb_buffer;
     hb_buffer.reset(hb_buffer_create());
@@ -740,7 +1199,7 @@ ShapedRuns FontManager::shapeRuns(const Font& font, const TextWithOptions& text,
         run.decoration    = font.textDecoration;
         run.direction     = t.direction;
         run.verticalAlign = font.verticalAlign;
-        run.metrics       = getMetrics(font);
+        run.metrics       = metrics;
 
         if (isControlCode(text.text[t.begin])) {
             for (int32_t i = t.begin; i < t.end; ++i) {
@@ -759,54 +1218,7 @@ ShapedRuns FontManager::shapeRuns(const Font& font, const TextWithOptions& text,
         if (t.face == nullptr)
             continue;
 
-        hb_buffer_reset(hb_buffer.get());
-
-        hb_buffer_add_codepoints(hb_buffer.get(), (const uint32_t*)text.text.data(), text.text.size(),
-                                 t.begin, t.end - t.begin);
-        hb_buffer_set_direction(hb_buffer.get(),
-                                t.direction == TextDirection::LTR ? HB_DIRECTION_LTR : HB_DIRECTION_RTL);
-        hb_buffer_guess_segment_properties(hb_buffer.get());
-
-        std::vector<hb_feature_t> features;
-        bool kernSet = false;
-        for (OpenTypeFeatureFlag feat : font.features) {
-            if (feat.feature == OpenTypeFeature::kern) {
-                kernSet = true;
-            }
-            features.push_back(hb_feature_t{
-                fontFeatures[+feat.feature],
-                feat.enabled ? 1u : 0u,
-                HB_FEATURE_GLOBAL_START,
-                HB_FEATURE_GLOBAL_END,
-            });
-        }
-        FontFlags flags = t.face->flags;
-        if (font.letterSpacing > 0) {
-            flags |= FontFlags::DisableLigatures;
-        }
-        if (!kernSet && (flags && FontFlags::DisableKerning)) {
-            features.push_back(hb_feature_t{
-                fontFeatures[+OpenTypeFeature::kern],
-                0u,
-                HB_FEATURE_GLOBAL_START,
-                HB_FEATURE_GLOBAL_END,
-            });
-        }
-        if ((flags && FontFlags::DisableLigatures)) {
-            using enum OpenTypeFeature;
-            for (OpenTypeFeature feature : { liga, clig, kern }) {
-                features.push_back(hb_feature_t{
-                    fontFeatures[+feature],
-                    0u,
-                    HB_FEATURE_GLOBAL_START,
-                    HB_FEATURE_GLOBAL_END,
-                });
-            }
-        }
-
-        std::ignore = t.face->lookupSize(font.fontSize);
-
-        hb_shape(t.face->hb_font, hb_buffer.get(), features.data(), features.size());
+        shapeText(hb_buffer.get(), font, text.text, t);
 
         unsigned int len               = hb_buffer_get_length(hb_buffer.get());
         hb_glyph_info_t* info          = hb_buffer_get_glyph_infos(hb_buffer.get(), nullptr);
@@ -890,6 +1302,146 @@ ShapedRuns FontManager::shapeRuns(const Font& font, const TextWithOptions& text,
     return shaped;
 }
 
+// Same script as hb_buffer_guess_segment_properties would pick for the whole run
+static hb_script_t runScript(std::u32string_view text, const TextRun& run) {
+    hb_unicode_funcs_t* funcs = hb_unicode_funcs_get_default();
+    for (int32_t i = run.begin; i < run.end; ++i) {
+        hb_script_t script = hb_unicode_script(funcs, text[i]);
+        if (script != HB_SCRIPT_COMMON && script != HB_SCRIPT_INHERITED && script != HB_SCRIPT_UNKNOWN)
+            return script;
+    }
+    return HB_SCRIPT_INVALID;
+}
+
+static size_t segmentAt(const std::vector<int32_t>& breaks, int32_t position) {
+    return std::upper_bound(breaks.begin(), breaks.end(), position) - breaks.begin() - 1;
+}
+
+static SegmentAdvance segmentAdvance(hb_buffer_t* buffer, const Font& font, std::u32string_view segment,
+                                     FontFace* face, hb_script_t script) {
+    const FTFixed fontSize = toFixed6(font.fontSize);
+    auto it                = face->segmentCache.find(
+        std::tuple<FTFixed, hb_script_t, std::u32string_view>{ fontSize, script, segment });
+    if (it != face->segmentCache.end())
+        return it->second;
+
+    // Shape the segment without context and let HarfBuzz report whether its edges interact
+    // with neighbouring text (kerning pairs, ligatures, contextual forms)
+    shapeText(buffer, font, segment, TextRun{ TextDirection::LTR, 0, int32_t(segment.size()), 0, face },
+              script, HB_BUFFER_FLAG_PRODUCE_UNSAFE_TO_CONCAT);
+
+    unsigned int len               = hb_buffer_get_length(buffer);
+    hb_glyph_info_t* info          = hb_buffer_get_glyph_infos(buffer, nullptr);
+    hb_glyph_position_t* positions = hb_buffer_get_glyph_positions(buffer, nullptr);
+    SegmentAdvance result{ 0.f, true, true };
+    for (uint32_t i = 0; i < len; i++) {
+        result.advance += fromFixed6(positions[i].x_advance) / HORIZONTAL_OVERSAMPLING;
+    }
+    if (len > 0) {
+        result.safeStart = !(hb_glyph_info_get_glyph_flags(info) & HB_GLYPH_FLAG_UNSAFE_TO_CONCAT);
+        result.safeEnd   = !(hb_glyph_info_get_glyph_flags(info + len - 1) & HB_GLYPH_FLAG_UNSAFE_TO_CONCAT);
+    }
+    if (face->segmentCache.size() >= maxSegmentCacheSize)
+        face->segmentCache.clear();
+    face->segmentCache.emplace(SegmentCacheKey{ fontSize, script, std::u32string(segment) }, result);
+    return result;
+}
+
+// Sums cached advances of the segments covered by the run. Returns false if shaping the segments
+// separately may give a different result than shaping the run as a whole
+static bool measureSegments(hb_buffer_t* buffer, const Font& font, std::u32string_view text,
+                            const TextRun& run, TextMeasurement& result) {
+    const hb_script_t script = runScript(text, run);
+    const size_t first       = segmentAt(result.breaks, run.begin);
+    SmallVector<float, 16> advances;
+    for (size_t i = first; i + 1 < result.breaks.size() && result.breaks[i] < run.end; ++i) {
+        const int32_t begin = std::max(result.breaks[i], run.begin);
+        const int32_t end   = std::min(result.breaks[i + 1], run.end);
+        SegmentAdvance segment =
+            segmentAdvance(buffer, font, text.substr(begin, end - begin), run.face, script);
+        if ((begin > 0 && !segment.safeStart) || (end < int32_t(text.size()) && !segment.safeEnd))
+            return false;
+        advances.push_back(segment.advance);
+    }
+    for (size_t i = 0; i < advances.size(); ++i) {
+        result.advances[first + i] += advances[i];
+    }
+    return true;
+}
+
+// Shapes the run as shapeRuns does and attributes glyph advances to the segments
+static void measureRun(hb_buffer_t* buffer, const Font& font, std::u32string_view text, const TextRun& run,
+                       TextMeasurement& result) {
+    shapeText(buffer, font, text, run);
+
+    unsigned int len               = hb_buffer_get_length(buffer);
+    hb_glyph_info_t* info          = hb_buffer_get_glyph_infos(buffer, nullptr);
+    hb_glyph_position_t* positions = hb_buffer_get_glyph_positions(buffer, nullptr);
+    uint32_t cluster               = UINT32_MAX;
+    for (uint32_t i = 0; i < len; i++) {
+        float advance = 0.f;
+        bool breakAllowed =
+            (hb_glyph_info_get_glyph_flags((info + i)) & HB_GLYPH_FLAG_UNSAFE_TO_BREAK) == 0;
+        if (i != 0 && info[i].cluster != cluster && breakAllowed) {
+            advance += font.letterSpacing;
+            if (utf8proc_category(text[info[i].cluster]) == UTF8PROC_CATEGORY_ZS) {
+                advance += font.wordSpacing;
+            }
+        }
+        cluster = info[i].cluster;
+        advance += fromFixed6(positions[i].x_advance) / HORIZONTAL_OVERSAMPLING;
+        result.advances[segmentAt(result.breaks, cluster)] += advance;
+    }
+}
+
+TextMeasurement FontManager::measure(const Font& font, const TextWithOptions& text) const {
+    lock_quard_cond lk(m_lock);
+    return doMeasure(font, text);
+}
+
+TextMeasurement FontManager::doMeasure(const Font& font, const TextWithOptions& text) const {
+    const int32_t length = text.text.size();
+    TextMeasurement result;
+    result.height = getMetrics(font).vertBounds();
+    if (length == 0) {
+        result.breaks = { 0 };
+        return result;
+    }
+    if (std::any_of(text.text.begin(), text.text.end(), isControlCode)) {
+        // Line feeds and tabs are handled by the full layout
+        RectangleF bounds = doPrerender(font, text).bounds();
+        result.breaks     = { 0, length };
+        result.advances   = { bounds.width() };
+        result.height     = bounds.height();
+        return result;
+    }
+    if (text.options && LayoutOptions::SingleLine)
+        result.breaks = { 0, length };
+    else
+        result.breaks = textBreakPositions(text.text, TextBreakMode::Line);
+    result.advances.assign(result.breaks.size() - 1, 0.f);
+
+    std::vector<TextRun> textRuns = splitTextRuns(text.text, text.defaultDirection, false);
+    textRuns                      = assignFontsToTextRuns(font, text.text, textRuns);
+
+    // Spacing and features are applied per run, so only plain text is measured by segments
+    const bool cacheable =
+        font.features.empty() && font.letterSpacing == 0.f && font.wordSpacing == 0.f;
+
+    std::unique_ptr<hb_buffer_t, hb_buffer_deleter> hb_buffer;
+    hb_buffer.reset(hb_buffer_create());
+
+    for (const TextRun& t : textRuns) {
+        if (t.face == nullptr)
+            continue;
+        if (cacheable && t.direction == TextDirection::LTR &&
+            measureSegments(hb_buffer.get(), font, text.text, t, result))
+            continue;
+        measureRun(hb_buffer.get(), font, text.text, t, result);
+    }
+    return result;
+}
+
 PrerenderedText FontManager::prerender(const Font& font, const TextWithOptions& text, float width) const {
     lock_quard_cond lk(m_lock);
     return doPrerender(font, text, width);
@@ -991,16 +1543,94 @@ ShapedRuns FontManager::doShapeCached(const Font& font, const TextWithOptions& t
 #endif
 }
 
+// Texts longer than this are split into chunks of whole paragraphs that are shaped in parallel
+constexpr static size_t parallelShapingChunk = 2048;
+
+// Returns chunk boundaries. Every chunk except the last ends right after a line feed
+static std::vector<int32_t> paragraphChunks(std::u32string_view text) {
+    std::vector<int32_t> chunks{ 0 };
+    size_t start = 0;
+    while (text.size() - start > parallelShapingChunk) {
+        size_t lineFeed = text.find(U'\n', start + parallelShapingChunk - 1);
+        if (lineFeed == std::u32string_view::npos || lineFeed + 1 == text.size())
+            break;
+        start = lineFeed + 1;
+        chunks.push_back(start);
+    }
+    chunks.push_back(text.size());
+    return chunks;
+}
+
 ShapedRuns FontManager::doShape(const Font& font, const TextWithOptions& text) const {
+    // Without worker threads the chunks would be shaped one after another, so shape the whole text at once
+    if (layoutPool().threadCount() > 0) {
+        std::vector<int32_t> chunks = paragraphChunks(text.text);
+        if (chunks.size() > 2)
+            return doShapeParallel(font, text, chunks);
+    }
     std::vector<TextRun> textRuns = splitTextRuns(text.text, text.defaultDirection, false);
     textRuns                      = assignFontsToTextRuns(font, text.text, textRuns);
     textRuns                      = splitControls(text.text, textRuns);
-    return shapeRuns(font, text, textRuns);
+    return shapeRuns(font, text, textRuns, 0, text.text.size(), getMetrics(font));
+}
+
+ShapedRuns FontManager::doShapeParallel(const Font& font, const TextWithOptions& text,
+                                        const std::vector<int32_t>& chunks) const {
+    WorkerPool& pool       = layoutPool();
+    const size_t numChunks = chunks.size() - 1;
+    std::vector<std::vector<TextRun>> chunkRuns(numChunks);
+
+    // Bidi levels are resolved per paragraph, so each chunk can be analyzed on its own
+    pool.parallelFor(numChunks, [&](size_t i) {
+        std::u32string_view chunk =
+            std::u32string_view(text.text).substr(chunks[i], chunks[i + 1] - chunks[i]);
+        chunkRuns[i] = splitTextRuns(chunk, text.defaultDirection, false);
+        for (TextRun& run : chunkRuns[i]) {
+            run.begin += chunks[i];
+            run.end += chunks[i];
+            // Visual indices are in UTF-16 units, so shifting by twice the chunk start keeps them below
+            // those of the next chunk. Lines never span chunks, so only this ordering between chunks
+            // differs from the indices of the whole text
+            run.visualOrder += 2 * chunks[i];
+        }
+    });
+
+    // Font fallback and FreeType sizes are shared state, so resolve them on this thread.
+    // Once a size is active, lookupSize only reads it
+    const FontMetrics metrics = getMetrics(font);
+    for (std::vector<TextRun>& textRuns : chunkRuns) {
+        textRuns = assignFontsToTextRuns(font, text.text, textRuns);
+        textRuns = splitControls(text.text, textRuns);
+        for (const TextRun& run : textRuns) {
+            if (run.face)
+                std::ignore = run.face->lookupSize(font.fontSize);
+        }
+    }
+
+    std::vector<ShapedRuns> shapedChunks(numChunks);
+    pool.parallelFor(numChunks, [&](size_t i) {
+        shapedChunks[i] = shapeRuns(font, text, chunkRuns[i], chunks[i], chunks[i + 1], metrics);
+    });
+
+    ShapedRuns shaped;
+    shaped.options = text.options;
+    for (ShapedRuns& chunk : shapedChunks) {
+        std::move(chunk.runs.begin(), chunk.runs.end(), std::back_inserter(shaped.runs));
+    }
+    return shaped;
 }
 
 PrerenderedText FontManager::doPrerender(const Font& font, const TextWithOptions& text, float width) const {
     ShapedRuns shaped = doShapeCached(font, text);
-    return std::move(shaped).prerender(font, width);
+    return std::move(shaped).prerender(font, width, &layoutPool());
+}
+
+float TextMeasurement::width() const noexcept {
+    return std::accumulate(advances.begin(), advances.end(), 0.f);
+}
+
+SizeF TextMeasurement::size() const noexcept {
+    return { width(), height };
 }
 
 RectangleF FontManager::bounds(const Font& font, const TextWithOptions& text) const {
@@ -1349,13 +1979,81 @@ void ShapedRuns::formatLine(std::span<GlyphRun> input, float y, int lineNum, flo
     }
 }
 
-PrerenderedText ShapedRuns::prerender(const Font& font, float maxWidth) && {
+// Below this number of runs prerender doesn't split text into paragraphs
+constexpr static size_t parallelLayoutRuns = 256;
+
+GlyphRuns ShapedRuns::formatParagraphs(GlyphRuns& input, const Font& font, float maxWidth,
+                                       WorkerPool& pool) {
+    struct Paragraph {
+        GlyphRuns input;
+        GlyphRuns output;
+        std::vector<size_t> lineRuns;
+        std::vector<float> lineHeights;
+        float y;
+        int lineNum;
+    };
+
+    // extractLine always ends a line at a line feed, so paragraphs are broken into lines independently
+    std::vector<Paragraph> paragraphs(1);
+    for (GlyphRun& run : input) {
+        const bool lineFeed = run.glyphs.front().codepoint == U'\n';
+        paragraphs.back().input.push_back(std::move(run));
+        if (lineFeed)
+            paragraphs.emplace_back();
+    }
+    input.clear();
+
+    pool.parallelFor(paragraphs.size(), [&](size_t i) {
+        Paragraph& p = paragraphs[i];
+        while (!p.input.empty()) {
+            size_t nb = extractLine(p.output, p.input, maxWidth);
+            if (nb) {
+                auto line = std::span{ p.output }.subspan(p.output.size() - nb, nb);
+                p.lineRuns.push_back(nb);
+                p.lineHeights.push_back(bounds(line).height());
+            }
+        }
+    });
+
+    // Line positions are accumulated in the same order as in the serial layout
+    float y     = 0;
+    int lineNum = 0;
+    for (Paragraph& p : paragraphs) {
+        p.y       = y;
+        p.lineNum = lineNum;
+        for (float height : p.lineHeights) {
+            y += height * font.lineHeight;
+        }
+        lineNum += p.lineRuns.size();
+    }
+
+    pool.parallelFor(paragraphs.size(), [&](size_t i) {
+        Paragraph& p  = paragraphs[i];
+        float y       = p.y;
+        size_t offset = 0;
+        for (size_t l = 0; l < p.lineRuns.size(); ++l) {
+            formatLine(std::span{ p.output }.subspan(offset, p.lineRuns[l]), y, p.lineNum + l, font.tabWidth);
+            offset += p.lineRuns[l];
+            y += p.lineHeights[l] * font.lineHeight;
+        }
+    });
+
+    GlyphRuns output;
+    for (Paragraph& p : paragraphs) {
+        std::move(p.output.begin(), p.output.end(), std::back_inserter(output));
+    }
+    return output;
+}
+
+PrerenderedText ShapedRuns::prerender(const Font& font, float maxWidth, WorkerPool* pool) && {
     BRISK_ASSERT(state == ShapedRunsState::Logical);
     PrerenderedText result;
     result.state = ShapedRunsState::Visual;
     if (options && LayoutOptions::SingleLine) {
         result.runs = std::move(runs);
         formatLine(result.runs, 0, 0, font.tabWidth);
+    } else if (pool && runs.size() >= parallelLayoutRuns) {
+        result.runs = formatParagraphs(runs, font, maxWidth, *pool);
     } else {
         float y     = 0;
         int lineNum = 0;
@@ -1373,9 +2071,9 @@ PrerenderedText ShapedRuns::prerender(const Font& font, float maxWidth) && {
     return result;
 }
 
-PrerenderedText ShapedRuns::prerender(const Font& font, float maxWidth) const& {
+PrerenderedText ShapedRuns::prerender(const Font& font, float maxWidth, WorkerPool* pool) const& {
     BRISK_ASSERT(state == ShapedRunsState::Logical);
-    return ShapedRuns(*this).prerender(font, maxWidth);
+    return ShapedRuns(*this).prerender(font, maxWidth, pool);
 }
 
 RectangleF ShapedRuns::bounds(std::span<const GlyphRun> runs, GlyphRunBounds boundsType) {
@@ -21,12 +21,14 @@
 #include <fmt/ranges.h>
 #include <brisk/graphics/Fonts.hpp>
 #include <brisk/core/Utilities.hpp>
+#include <brisk/core/Threading.hpp>
 #include <catch2/catch_all.hpp>
 #include "Catch2Utils.hpp"
 #include "../core/test/HelloWorld.hpp"
 #include <brisk/core/Reflection.hpp>
 #include "VisualTests.hpp"
 #include "Atlas.hpp"
+#include <numeric>
 
 namespace Brisk {
 
@@ -185,9 +187,47 @@ TEST_CASE("splitTextRuns") {
                                      .visualOrder = 11,
                                      .face        = nullptr },
               });
+        // Text without strong characters takes the default direction
+        CHECK(Internal::splitTextRuns(U"  ", TextDirection::RTL, true) ==
+              std::vector<Internal::TextRun>{
+                  Internal::TextRun{ .direction   = TextDirection::RTL,
+                                     .begin       = 0,
+                                     .end         = 2,
+                                     .visualOrder = 0,
+                                     .face        = nullptr },
+              });
+        CHECK(Internal::splitTextRuns(U"abc", TextDirection::RTL, true) ==
+              std::vector<Internal::TextRun>{
+                  Internal::TextRun{ .direction   = TextDirection::LTR,
+                                     .begin       = 0,
+                                     .end         = 3,
+                                     .visualOrder = 0,
+                                     .face        = nullptr },
+              });
+        // Explicit embedding characters always go through the bidi algorithm
+        CHECK(Internal::splitTextRuns(U"abc \U0000202Bdef\U0000202C", TextDirection::LTR, true).size() > 1);
     }
 }
 
+TEST_CASE("splitTextRuns benchmark", "[.benchmark]") {
+    const std::u32string ltrText = U"The quick brown fox jumps over the lazy dog. 0123456789, ÀÉÎÕÜ";
+    const std::u32string mixedText =
+        U"The quick brown fox שלום עולם jumps over مرحبا بالعالم the lazy dog. 0123456789";
+
+    BENCHMARK("splitTextRuns, LTR only") {
+        return Internal::splitTextRuns(ltrText, TextDirection::LTR, false).size();
+    };
+    BENCHMARK("splitTextRuns, mixed") {
+        return Internal::splitTextRuns(mixedText, TextDirection::LTR, false).size();
+    };
+    BENCHMARK("textBreakPositions, LTR only") {
+        return textBreakPositions(ltrText, TextBreakMode::Line).size();
+    };
+    BENCHMARK("textBreakPositions, mixed") {
+        return textBreakPositions(mixedText, TextBreakMode::Line).size();
+    };
+}
+
 TEST_CASE("FontManager") {
 
     fontManager = rcnew FontManager(nullptr, 1, 5000);
@@ -551,4 +591,367 @@ I	Ì	Î	Ĭ	I̊	I̋	Ï	I̧	Ǐ	Ĩ	Í	Ḯ	Í̈
     fontManager.reset();
 }
 
+static const std::u32string mixedScriptText =
+    U"Hello, world! Привет, мир! Γειά σου Κόσμε! 你好，世界！こんにちは世界！안녕하세요 세계! "
+    U"مرحبا بالعالم! שלום עולם! नमस्ते दुनिया! สวัสดีชาวโลก! \U00010140\U00010141\U00010142";
+
+TEST_CASE("CodepointFallback") {
+    FontManager manager(nullptr, 1, 5000);
+    auto ttf  = readBytes(fs::path(PROJECT_SOURCE_DIR) / "resources" / "fonts" / "Lato-Medium.ttf");
+    auto ttf2 = readBytes(fs::path(PROJECT_SOURCE_DIR) / "resources" / "fonts" / "GoNotoCurrent-Regular.ttf");
+    REQUIRE(ttf.has_value());
+    REQUIRE(ttf2.has_value());
+    FontFamily lato = FontFamily(0), noto = FontFamily(1), merged = FontFamily(2);
+    manager.addFont(lato, FontStyle::Normal, FontWeight::Regular, *ttf);
+    manager.addFont(noto, FontStyle::Normal, FontWeight::Regular, *ttf2);
+    manager.addMergedFont(merged, { lato, noto });
+
+    for (char32_t ch : mixedScriptText) {
+        CHECK(manager.hasCodepoint(Font{ merged }, ch) ==
+              (manager.hasCodepoint(Font{ lato }, ch) || manager.hasCodepoint(Font{ noto }, ch)));
+    }
+    CHECK(manager.hasCodepoint(Font{ lato }, U'A'));
+    CHECK(!manager.hasCodepoint(Font{ lato }, U'你'));
+    CHECK(manager.hasCodepoint(Font{ merged }, U'你'));
+    CHECK(!manager.hasCodepoint(Font{ merged }, U'\n'));
+    CHECK(!manager.hasCodepoint(Font{ merged }, char32_t(0x110000)));
+
+    // The first family in the merged font takes precedence
+    ShapedRuns shaped = manager.shape(Font{ merged }, U"A你B"s);
+    REQUIRE(shaped.runs.size() == 3);
+    CHECK(shaped.runs[0].face == shaped.runs[2].face);
+    CHECK(shaped.runs[0].face != shaped.runs[1].face);
+}
+
+TEST_CASE("Deferred font loading") {
+    auto ttf  = readBytes(fs::path(PROJECT_SOURCE_DIR) / "resources" / "fonts" / "Lato-Medium.ttf");
+    auto ttf2 = readBytes(fs::path(PROJECT_SOURCE_DIR) / "resources" / "fonts" / "GoNotoCurrent-Regular.ttf");
+    REQUIRE(ttf.has_value());
+    REQUIRE(ttf2.has_value());
+    FontFamily lato = FontFamily(0), noto = FontFamily(1), merged = FontFamily(2);
+    int latoLoads = 0, notoLoads = 0;
+
+    FontManager manager(nullptr, 1, 5000);
+    manager.addFont(lato, FontStyle::Normal, FontWeight::Regular, [&]() -> bytes_view {
+        ++latoLoads;
+        return *ttf;
+    });
+    manager.addFont(noto, FontStyle::Normal, FontWeight::Regular, [&]() -> bytes_view {
+        ++notoLoads;
+        return *ttf2;
+    });
+    manager.addMergedFont(merged, { lato, noto });
+    CHECK(latoLoads == 0);
+    CHECK(notoLoads == 0);
+
+    Font font{ merged, 14.f };
+    CHECK(manager.bounds(font, U"Hello, world"s).width() > 0);
+    CHECK(latoLoads == 1);
+    // Fallback faces are loaded only for codepoints missing from the faces before them
+    CHECK(notoLoads == 0);
+    CHECK(manager.hasCodepoint(font, U'你'));
+    CHECK(notoLoads == 1);
+
+    FontManager eager(nullptr, 1, 5000);
+    eager.addFont(lato, FontStyle::Normal, FontWeight::Regular, *ttf);
+    eager.addFont(noto, FontStyle::Normal, FontWeight::Regular, *ttf2);
+    eager.addMergedFont(merged, { lato, noto });
+    CHECK(manager.bounds(font, U"Hello, 世界"s) == eager.bounds(font, U"Hello, 世界"s));
+    for (char32_t ch : mixedScriptText) {
+        CHECK(manager.hasCodepoint(font, ch) == eager.hasCodepoint(font, ch));
+    }
+    CHECK(latoLoads == 1);
+    CHECK(notoLoads == 1);
+
+    // Data FreeType can't read leaves the face missing
+    static const std::string garbage = "not a font";
+    manager.addFont(FontFamily(3), FontStyle::Normal, FontWeight::Regular, []() -> bytes_view {
+        return toBytesView(garbage);
+    });
+    CHECK(manager.metrics(Font{ FontFamily(3), 14.f }) == FontMetrics{});
+    CHECK(!manager.hasCodepoint(Font{ FontFamily(3) }, U'A'));
+}
+
+TEST_CASE("CodepointFallback benchmark", "[.benchmark]") {
+    FontManager manager(nullptr, 1, 5000);
+    auto ttf  = readBytes(fs::path(PROJECT_SOURCE_DIR) / "resources" / "fonts" / "Lato-Medium.ttf");
+    auto ttf2 = readBytes(fs::path(PROJECT_SOURCE_DIR) / "resources" / "fonts" / "GoNotoCurrent-Regular.ttf");
+    REQUIRE(ttf.has_value());
+    REQUIRE(ttf2.has_value());
+    manager.addFont(FontFamily(0), FontStyle::Normal, FontWeight::Regular, *ttf);
+    manager.addFont(FontFamily(1), FontStyle::Normal, FontWeight::Regular, *ttf2);
+    manager.addMergedFont(FontFamily(2), { FontFamily(0), FontFamily(1) });
+    Font font{ FontFamily(2), 14.f };
+
+    BENCHMARK("hasCodepoint, mixed scripts") {
+        int found = 0;
+        for (char32_t ch : mixedScriptText)
+            found += manager.hasCodepoint(font, ch);
+        return found;
+    };
+    int counter = 0;
+    BENCHMARK("shape, mixed scripts") {
+        // Unique text on every iteration to bypass the shaping cache
+        return manager.shape(font, mixedScriptText + utf8ToUtf32(std::to_string(counter++))).runs.size();
+    };
+}
+
+TEST_CASE("TextMeasurement") {
+    FontManager manager(nullptr, 1, 5000);
+    auto ttf  = readBytes(fs::path(PROJECT_SOURCE_DIR) / "resources" / "fonts" / "Lato-Medium.ttf");
+    auto ttf2 = readBytes(fs::path(PROJECT_SOURCE_DIR) / "resources" / "fonts" / "GoNotoCurrent-Regular.ttf");
+    REQUIRE(ttf.has_value());
+    REQUIRE(ttf2.has_value());
+    manager.addFont(FontFamily(0), FontStyle::Normal, FontWeight::Regular, *ttf);
+    manager.addFont(FontFamily(1), FontStyle::Normal, FontWeight::Regular, *ttf2);
+    manager.addMergedFont(FontFamily(2), { FontFamily(0), FontFamily(1) });
+
+    std::vector<std::u32string> texts{
+        U"Hello, world!",
+        U"  AVAWAY To Tea, Ty Yo  ",
+        U"office fluffy waffle",
+        U"1,234.56 – 7/8 ≠ 3½",
+        mixedScriptText,
+        U"Tab\tseparated",
+        U"First line\nSecond line",
+    };
+    for (std::string_view text : helloWorld) {
+        texts.push_back(utf8ToUtf32(text));
+    }
+
+    Font regular{ FontFamily(2), 14.f };
+    Font large{ FontFamily(2), 36.f };
+    Font spaced          = regular;
+    spaced.letterSpacing = 1.5f;
+    spaced.wordSpacing   = 3.f;
+    Font noKerning       = regular;
+    noKerning.features   = { OpenTypeFeatureFlag{ OpenTypeFeature::kern, false } };
+
+    for (const Font& font : { regular, large, spaced, noKerning }) {
+        for (LayoutOptions options : { LayoutOptions::Default, LayoutOptions::SingleLine }) {
+            for (const std::u32string& text : texts) {
+                INFO(utf32ToUtf8(text));
+                RectangleF bounds = manager.prerender(font, TextWithOptions{ text, options }).bounds();
+                // The second call is served from the segment cache
+                for (int pass = 0; pass < 2; ++pass) {
+                    TextMeasurement measured = manager.measure(font, TextWithOptions{ text, options });
+                    REQUIRE(measured.breaks.size() == measured.advances.size() + 1);
+                    CHECK(measured.breaks.front() == 0);
+                    CHECK(measured.breaks.back() == text.size());
+                    CHECK(measured.width() == Catch::Approx(bounds.width()).margin(0.001));
+                    CHECK(measured.height == Catch::Approx(bounds.height()).margin(0.001));
+                }
+            }
+        }
+    }
+
+    TextMeasurement measured = manager.measure(regular, U"Hello, world!"s);
+    CHECK(measured.breaks == textBreakPositions(U"Hello, world!", TextBreakMode::Line));
+    CHECK(manager.measure(regular, U""s).width() == 0.f);
+}
+
+TEST_CASE("TextMeasurement benchmark", "[.benchmark]") {
+    FontManager manager(nullptr, 1, 5000);
+    auto ttf = readBytes(fs::path(PROJECT_SOURCE_DIR) / "resources" / "fonts" / "Lato-Medium.ttf");
+    REQUIRE(ttf.has_value());
+    manager.addFont(FontFamily(0), FontStyle::Normal, FontWeight::Regular, *ttf);
+    Font font{ FontFamily(0), 14.f };
+
+    std::vector<std::u32string> labels;
+    for (int i = 0; i < 1000; ++i) {
+        labels.push_back(utf8ToUtf32(fmt::format("Item {} of the list", i)));
+    }
+    BENCHMARK("bounds, 1000 labels") {
+        float width = 0;
+        for (const std::u32string& label : labels)
+            width += manager.bounds(font, label).width();
+        return width;
+    };
+    BENCHMARK("measure, 1000 labels") {
+        float width = 0;
+        for (const std::u32string& label : labels)
+            width += manager.measure(font, label).width();
+        return width;
+    };
+}
+
+static void checkSameLayout(const FontManager& m1, const GlyphRuns& r1, const FontManager& m2,
+                            const GlyphRuns& r2) {
+    REQUIRE(r1.size() == r2.size());
+    for (size_t i = 0; i < r1.size(); ++i) {
+        INFO(i);
+        CHECK(m1.faceToKey(r1[i].face) == m2.faceToKey(r2[i].face));
+        CHECK(r1[i].line == r2[i].line);
+        CHECK(r1[i].position == r2[i].position);
+        REQUIRE(r1[i].glyphs.size() == r2[i].glyphs.size());
+        for (size_t j = 0; j < r1[i].glyphs.size(); ++j) {
+            CHECK(r1[i].glyphs[j].glyph == r2[i].glyphs[j].glyph);
+            CHECK(r1[i].glyphs[j].begin_char == r2[i].glyphs[j].begin_char);
+            CHECK(r1[i].glyphs[j].end_char == r2[i].glyphs[j].end_char);
+            CHECK(r1[i].glyphs[j].pos == r2[i].glyphs[j].pos);
+            CHECK(r1[i].glyphs[j].flags == r2[i].glyphs[j].flags);
+        }
+    }
+}
+
+// Visual indices of chunks differ from those of the whole text, but must order the runs the same way
+static void checkSameVisualOrder(const GlyphRuns& r1, const GlyphRuns& r2) {
+    REQUIRE(r1.size() == r2.size());
+    auto visualOrder = [](const GlyphRuns& runs) {
+        std::vector<size_t> indices(runs.size());
+        std::iota(indices.begin(), indices.end(), 0);
+        std::stable_sort(indices.begin(), indices.end(), [&runs](size_t a, size_t b) {
+            return runs[a].visualOrder < runs[b].visualOrder;
+        });
+        return indices;
+    };
+    CHECK(visualOrder(r1) == visualOrder(r2));
+}
+
+static std::u32string longText(int paragraphs) {
+    std::u32string text;
+    for (int i = 0; i < paragraphs; ++i) {
+        text += utf8ToUtf32(fmt::format("{}. ", i)) + mixedScriptText + U"\n";
+        if (i % 7 == 0)
+            text += U"\n"; // empty line
+    }
+    return text;
+}
+
+TEST_CASE("Parallel shaping") {
+    auto ttf  = readBytes(fs::path(PROJECT_SOURCE_DIR) / "resources" / "fonts" / "Lato-Medium.ttf");
+    auto ttf2 = readBytes(fs::path(PROJECT_SOURCE_DIR) / "resources" / "fonts" / "GoNotoCurrent-Regular.ttf");
+    REQUIRE(ttf.has_value());
+    REQUIRE(ttf2.has_value());
+    WorkerPool serial(0);
+    WorkerPool parallel(4);
+    FontManager m1(nullptr, 1, 5000);
+    FontManager m2(nullptr, 1, 5000);
+    m1.setWorkerPool(&serial);
+    m2.setWorkerPool(&parallel);
+    for (FontManager* m : { &m1, &m2 }) {
+        m->addFont(FontFamily(0), FontStyle::Normal, FontWeight::Regular, *ttf);
+        m->addFont(FontFamily(1), FontStyle::Normal, FontWeight::Regular, *ttf2);
+        m->addMergedFont(FontFamily(2), { FontFamily(0), FontFamily(1) });
+    }
+    Font font{ FontFamily(2), 14.f };
+    const std::u32string text = longText(100);
+
+    // Without worker threads, m1 shapes the whole text at once, m2 shapes it in chunks of paragraphs
+    ShapedRuns whole   = m1.shape(font, text);
+    ShapedRuns chunked = m2.shape(font, text);
+    checkSameLayout(m1, whole.runs, m2, chunked.runs);
+    checkSameVisualOrder(whole.runs, chunked.runs);
+    for (float width : { HUGE_VALF, 300.f }) {
+        // Line breaks, run order within lines and glyph positions match the serial layout exactly
+        PrerenderedText ref = whole.prerender(font, width);
+        PrerenderedText p1  = m1.prerender(font, text, width);
+        PrerenderedText p2  = m2.prerender(font, text, width);
+        checkSameLayout(m1, ref.runs, m2, p2.runs);
+        checkSameLayout(m1, p1.runs, m2, p2.runs);
+        CHECK(ref.bounds() == p2.bounds());
+        CHECK(p1.bounds() == p2.bounds());
+    }
+}
+
+TEST_CASE("Parallel shaping benchmark", "[.benchmark]") {
+    auto ttf  = readBytes(fs::path(PROJECT_SOURCE_DIR) / "resources" / "fonts" / "Lato-Medium.ttf");
+    auto ttf2 = readBytes(fs::path(PROJECT_SOURCE_DIR) / "resources" / "fonts" / "GoNotoCurrent-Regular.ttf");
+    REQUIRE(ttf.has_value());
+    REQUIRE(ttf2.has_value());
+    FontManager manager(nullptr, 1, 5000);
+    manager.addFont(FontFamily(0), FontStyle::Normal, FontWeight::Regular, *ttf);
+    manager.addFont(FontFamily(1), FontStyle::Normal, FontWeight::Regular, *ttf2);
+    manager.addMergedFont(FontFamily(2), { FontFamily(0), FontFamily(1) });
+    Font font{ FontFamily(2), 14.f };
+    const std::u32string text = longText(500);
+
+    int counter = 0;
+    for (size_t threads : { 0, 1, 3, 7 }) {
+        WorkerPool pool(threads);
+        manager.setWorkerPool(&pool);
+        BENCHMARK(fmt::format("prerender, {} threads", threads + 1)) {
+            // Unique text on every iteration to bypass the shaping cache
+            return manager.prerender(font, text + utf8ToUtf32(std::to_string(counter++)), 400.f).runs.size();
+        };
+    }
+    manager.setWorkerPool(nullptr);
+}
+
+TEST_CASE("FontIndex") {
+    const fs::path fontsDir = fs::path(PROJECT_SOURCE_DIR) / "resources" / "fonts";
+    const fs::path tmpDir   = tempFilePath("brisk-fonts-*");
+    REQUIRE(fs::create_directories(tmpDir / "sub"));
+    SCOPE_EXIT {
+        std::error_code ec;
+        fs::remove_all(tmpDir, ec);
+    };
+    fs::copy_file(fontsDir / "Lato-Medium.ttf", tmpDir / "Lato-Medium.ttf");
+    fs::copy_file(fontsDir / "Lato-Light.ttf", tmpDir / "sub" / "Lato-Light.ttf");
+    REQUIRE(writeUtf8(tmpDir / "broken.ttf", "not a font"));
+    const fs::path indexPath = tmpDir / "index" / "fonts.msgpack";
+
+    auto scan = [&](bool rescan = false) {
+        FontManager manager(nullptr, 1, 5000);
+        manager.setFontFolders({ tmpDir });
+        manager.setFontIndexPath(indexPath);
+        std::vector<OSFont> fonts = manager.installedFonts(rescan);
+        std::sort(fonts.begin(), fonts.end(), [](const OSFont& a, const OSFont& b) {
+            return a.path < b.path;
+        });
+        return fonts;
+    };
+
+    std::vector<OSFont> cold = scan();
+    REQUIRE(cold.size() == 2);
+    CHECK(cold[0].family == "Lato");
+    CHECK(cold[0].weight == FontWeight::Medium);
+    CHECK(cold[1].weight == FontWeight::Light);
+    CHECK(cold[0].unicodeRanges[0] != 0); // Basic Latin
+    CHECK(fs::exists(indexPath));
+
+    std::vector<OSFont> warm = scan();
+    REQUIRE(warm.size() == cold.size());
+    for (size_t i = 0; i < warm.size(); ++i) {
+        CHECK(warm[i].path == cold[i].path);
+        CHECK(warm[i].family == cold[i].family);
+        CHECK(warm[i].weight == cold[i].weight);
+        CHECK(warm[i].unicodeRanges == cold[i].unicodeRanges);
+    }
+
+    // Changed and removed files must be revalidated
+    fs::copy_file(fontsDir / "Lato-Black.ttf", tmpDir / "Lato-Medium.ttf",
+                  fs::copy_options::overwrite_existing);
+    fs::remove(tmpDir / "sub" / "Lato-Light.ttf");
+    std::vector<OSFont> updated = scan(true);
+    REQUIRE(updated.size() == 1);
+    CHECK(updated[0].weight == FontWeight::Black);
+
+    // A corrupted index is ignored and rewritten
+    REQUIRE(writeUtf8(indexPath, "garbage"));
+    CHECK(scan().size() == 1);
+
+    // Scanning on the worker pool gives the same result
+    {
+        FontManager manager(nullptr, 1, 5000);
+        manager.setFontFolders({ tmpDir });
+        manager.setFontIndexPath(indexPath);
+        CHECK(!manager.installedFontsReady());
+        manager.scanInstalledFonts();
+        std::vector<OSFont> fonts = manager.installedFonts();
+        CHECK(manager.installedFontsReady());
+        REQUIRE(fonts.size() == 1);
+        CHECK(fonts[0].weight == FontWeight::Black);
+    }
+
+    // Faces loaded from the same file share a single mapping
+    FontManager manager(nullptr, 1, 5000);
+    REQUIRE(manager.addFontFromFile(FontFamily(0), FontStyle::Normal, FontWeight::Regular,
+                                    tmpDir / "Lato-Medium.ttf"));
+    REQUIRE(manager.addFontFromFile(FontFamily(1), FontStyle::Normal, FontWeight::Regular,
+                                    tmpDir / "Lato-Medium.ttf"));
+    CHECK(manager.bounds(Font{ FontFamily(0), 20.f }, U"Hello"s) ==
+          manager.bounds(Font{ FontFamily(1), 20.f }, U"Hello"s));
+}
+
 } // namespace Brisk
@@ -0,0 +1,238 @@
+/*
+ * Brisk
+ *
+ * Cross-platform application framework
+ * --------------------------------------------------------------
+ *
+ * Copyright (C) 2024 Brisk Developers
+ *
+ * This file is part of the Brisk library.
+ *
+ * Brisk is dual-licensed under the GNU General Public License, version 2 (GPL-2.0+),
+ * and a commercial license. You may use, modify, and distribute this software under
+ * the terms of the GPL-2.0+ license if you comply with its conditions.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * If you do not wish to be bound by the GPL-2.0+ license, you must purchase a commercial
+ * license. For commercial licensing options, please visit: https://brisklib.com
+ */
+#include "GlyphCache.hpp"
+#include <brisk/core/Hash.hpp>
+#include <bit>
+#include <random>
+#include <unordered_set>
+
+namespace Brisk {
+
+namespace Internal {
+
+namespace {
+
+constexpr uint32_t glyphCacheMagic   = 0x4347524B; // "KRGC"
+constexpr uint32_t glyphCacheVersion = 1;
+
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t salt;
+};
+
+struct RecordHeader {
+    GlyphDiskKey key;
+    uint32_t offsetX;  // float bits
+    int32_t offsetY;
+    uint32_t advanceX; // float bits
+    uint16_t width;
+    uint16_t height;
+    uint32_t checksum; // CRC-32 of the header with this field set to zero, followed by the pixels
+    uint32_t reserved;
+};
+
+static_assert(std::has_unique_object_representations_v<FileHeader>);
+static_assert(std::has_unique_object_representations_v<RecordHeader>);
+
+uint32_t recordChecksum(RecordHeader header, bytes_view pixels) {
+    header.checksum = 0;
+    return crc32(pixels, crc32(asBytesView(header)));
+}
+
+// Returns the record at the offset, or an empty view if the record overruns the data
+bytes_view recordAt(bytes_view data, size_t offset) {
+    if (data.size() - offset < sizeof(RecordHeader))
+        return {};
+    RecordHeader header;
+    memcpy(&header, data.data() + offset, sizeof(RecordHeader));
+    const size_t size = sizeof(RecordHeader) + size_t(header.width) * header.height;
+    if (data.size() - offset < size)
+        return {};
+    return data.subspan(offset, size);
+}
+
+bool validRecord(bytes_view record) {
+    RecordHeader header;
+    memcpy(&header, record.data(), sizeof(RecordHeader));
+    return recordChecksum(header, record.subspan(sizeof(RecordHeader))) == header.checksum;
+}
+
+// Calls fn(key, offset, record) for each record of the file. Checksums are not verified
+template <typename Fn>
+void parseRecords(bytes_view data, uint64_t salt, Fn&& fn) {
+    FileHeader header;
+    if (data.size() < sizeof(FileHeader))
+        return;
+    memcpy(&header, data.data(), sizeof(FileHeader));
+    if (header.magic != glyphCacheMagic || header.version != glyphCacheVersion || header.salt != salt)
+        return;
+    size_t offset = sizeof(FileHeader);
+    while (offset < data.size()) {
+        bytes_view record = recordAt(data, offset);
+        if (record.empty())
+            break; // Truncated file
+        RecordHeader recordHeader;
+        memcpy(&recordHeader, record.data(), sizeof(RecordHeader));
+        fn(recordHeader.key, offset, record);
+        offset += record.size();
+    }
+}
+
+} // namespace
+
+GlyphDiskCache::GlyphDiskCache(fs::path path, uintmax_t maxSize, uint64_t salt)
+    : m_path(std::move(path)), m_maxSize(maxSize), m_salt(salt) {
+    open();
+}
+
+GlyphDiskCache::~GlyphDiskCache() {
+    std::ignore = flush();
+}
+
+void GlyphDiskCache::open() {
+    m_entries.clear();
+    m_mapping = nullptr;
+    expected<RC<MappedFile>, IOError> mapping = mapFile(m_path);
+    if (!mapping)
+        return;
+    m_mapping = std::move(*mapping);
+    parseRecords(m_mapping->data(), m_salt, [&](const GlyphDiskKey& key, size_t offset, bytes_view) {
+        m_entries.try_emplace(key, Entry{ offset, false });
+    });
+}
+
+optional<GlyphData> GlyphDiskCache::load(const GlyphDiskKey& key) {
+    bytes_view record;
+    if (auto it = m_pending.find(key); it != m_pending.end()) {
+        record = it->second;
+    } else if (auto it = m_entries.find(key); it != m_entries.end()) {
+        record = recordAt(m_mapping->data(), it->second.offset);
+        // Checksums are verified lazily to keep opening the cache cheap
+        if (!validRecord(record)) {
+            m_entries.erase(it);
+            return nullopt;
+        }
+        it->second.used = true;
+    } else {
+        return nullopt;
+    }
+    RecordHeader header;
+    memcpy(&header, record.data(), sizeof(RecordHeader));
+    GlyphData glyph;
+    glyph.size      = Size(header.width, header.height);
+    glyph.sprite    = makeSprite(glyph.size, record.subspan(sizeof(RecordHeader)));
+    glyph.offset_x  = std::bit_cast<float>(header.offsetX);
+    glyph.offset_y  = header.offsetY;
+    glyph.advance_x = std::bit_cast<float>(header.advanceX);
+    return glyph;
+}
+
+void GlyphDiskCache::store(const GlyphDiskKey& key, const GlyphData& glyph) {
+    if (glyph.size.width > UINT16_MAX || glyph.size.height > UINT16_MAX || m_entries.contains(key))
+        return;
+    RecordHeader header{
+        key,
+        std::bit_cast<uint32_t>(glyph.offset_x),
+        glyph.offset_y,
+        std::bit_cast<uint32_t>(glyph.advance_x),
+        uint16_t(glyph.size.width),
+        uint16_t(glyph.size.height),
+        0,
+        0,
+    };
+    bytes_view pixels = glyph.sprite ? glyph.sprite->bytes() : bytes_view{};
+    BRISK_ASSERT(pixels.size() == glyph.size.area());
+    header.checksum = recordChecksum(header, pixels);
+    Bytes record(sizeof(RecordHeader) + pixels.size());
+    memcpy(record.data(), &header, sizeof(RecordHeader));
+    std::copy(pixels.begin(), pixels.end(), record.begin() + sizeof(RecordHeader));
+    m_pending.insert_or_assign(key, std::move(record));
+}
+
+status<IOError> GlyphDiskCache::flush() {
+    if (m_pending.empty())
+        return {};
+
+    Bytes output(sizeof(FileHeader));
+    FileHeader header{ glyphCacheMagic, glyphCacheVersion, m_salt };
+    memcpy(output.data(), &header, sizeof(FileHeader));
+    std::unordered_set<GlyphDiskKey, FastHash> written;
+    auto append = [&](const GlyphDiskKey& key, bytes_view record) {
+        if (written.contains(key) || output.size() + record.size() > m_maxSize)
+            return;
+        written.insert(key);
+        output.insert(output.end(), record.begin(), record.end());
+    };
+    auto appendFile = [&](const RC<MappedFile>& file, bool usedOnly) {
+        if (!file)
+            return;
+        parseRecords(file->data(), m_salt, [&](const GlyphDiskKey& key, size_t, bytes_view record) {
+            if (usedOnly) {
+                auto it = m_entries.find(key);
+                if (it == m_entries.end() || !it->second.used)
+                    return;
+            }
+            if (validRecord(record))
+                append(key, record);
+        });
+    };
+
+    // Glyphs used in this session take precedence when the size limit is reached
+    for (const auto& [key, record] : m_pending) {
+        append(key, record);
+    }
+    appendFile(m_mapping, true);
+    // Keep the glyphs written by other processes since the cache was opened
+    appendFile(mapFile(m_path).value_or(nullptr), false);
+    appendFile(m_mapping, false);
+
+    // Mapped files can't be replaced on some systems
+    m_entries.clear();
+    m_mapping = nullptr;
+
+    std::error_code ec;
+    fs::create_directories(m_path.parent_path(), ec);
+    // Write to a unique file and rename it over the cache so that concurrent
+    // processes never observe a partially written cache
+    fs::path tmpPath = m_path;
+    tmpPath += fmt::format(".{:08X}.tmp", std::random_device{}());
+    status<IOError> result = writeBytes(tmpPath, output);
+    if (result) {
+        fs::rename(tmpPath, m_path, ec);
+        if (ec)
+            result = unexpected(IOError::CantWrite);
+    }
+    if (result)
+        m_pending.clear();
+    else
+        fs::remove(tmpPath, ec);
+    open();
+    return result;
+}
+
+size_t GlyphDiskCache::size() const noexcept {
+    return m_entries.size() + m_pending.size();
+}
+
+} // namespace Internal
+
+} // namespace Brisk
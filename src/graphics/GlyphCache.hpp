@@ -0,0 +1,117 @@
+/*
+ * Brisk
+ *
+ * Cross-platform application framework
+ * --------------------------------------------------------------
+ *
+ * Copyright (C) 2024 Brisk Developers
+ *
+ * This file is part of the Brisk library.
+ *
+ * Brisk is dual-licensed under the GNU General Public License, version 2 (GPL-2.0+),
+ * and a commercial license. You may use, modify, and distribute this software under
+ * the terms of the GPL-2.0+ license if you comply with its conditions.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * If you do not wish to be bound by the GPL-2.0+ license, you must purchase a commercial
+ * license. For commercial licensing options, please visit: https://brisklib.com
+ */
+#pragma once
+#include <brisk/graphics/Fonts.hpp>
+#include <brisk/core/IO.hpp>
+#include <unordered_map>
+
+namespace Brisk {
+
+namespace Internal {
+
+/**
+ * @brief Identifies a rasterized glyph across runs.
+ */
+struct GlyphDiskKey {
+    uint64_t fontHash;   // Hash of the font file contents
+    uint32_t glyphIndex; // Glyph index within the font
+    int32_t fontSize;    // Font size in 26.6 fixed point
+    uint32_t hscale;     // Horizontal scale of the font manager
+    uint32_t flags;      // Rasterization options, see GlyphDiskCache::NoHinting
+
+    bool operator==(const GlyphDiskKey&) const noexcept = default;
+};
+
+static_assert(std::has_unique_object_representations_v<GlyphDiskKey>);
+
+/**
+ * @brief Persistent cache of rasterized glyph bitmaps.
+ *
+ * The cache file is memory-mapped when the cache is opened. Glyphs are copied out of the
+ * mapping on lookup. Glyphs stored during the session are kept in memory until flush(), which
+ * writes them together with the entries of the current file.
+ *
+ * Every record carries a checksum, verified when the glyph is first loaded. A damaged record is
+ * dropped on its own and the glyph is rasterized again. Flushing skips damaged records, and
+ * reading stops at a truncated one. The file is replaced atomically, so concurrent processes
+ * never observe a partially written cache.
+ * Flushing merges the entries written by other processes in the meantime.
+ */
+class GlyphDiskCache final {
+public:
+    constexpr static uint32_t NoHinting = 1;
+
+    /**
+     * @brief Opens the cache file.
+     *
+     * @param path Cache file. A missing or invalid file yields an empty cache.
+     * @param maxSize Maximum file size in bytes. Glyphs used in this session are kept first.
+     * @param salt Value identifying the rasterizer. Files written with a different salt are ignored.
+     */
+    GlyphDiskCache(fs::path path, uintmax_t maxSize, uint64_t salt);
+
+    /**
+     * @brief Flushes the cache.
+     */
+    ~GlyphDiskCache();
+
+    GlyphDiskCache(const GlyphDiskCache&)            = delete;
+    GlyphDiskCache& operator=(const GlyphDiskCache&) = delete;
+
+    /**
+     * @brief Returns the glyph, or nullopt if it isn't cached.
+     */
+    optional<GlyphData> load(const GlyphDiskKey& key);
+
+    /**
+     * @brief Adds the glyph to the cache. The glyph is written by the next flush().
+     */
+    void store(const GlyphDiskKey& key, const GlyphData& glyph);
+
+    /**
+     * @brief Writes the cache file if any glyph has been stored since the last flush.
+     */
+    status<IOError> flush();
+
+    /**
+     * @brief Returns the number of cached glyphs.
+     */
+    size_t size() const noexcept;
+
+private:
+    struct Entry {
+        size_t offset; // Offset of the record in the mapping
+        bool used;     // Looked up during this session
+    };
+
+    fs::path m_path;
+    uintmax_t m_maxSize;
+    uint64_t m_salt;
+    RC<MappedFile> m_mapping;
+    std::unordered_map<GlyphDiskKey, Entry, FastHash> m_entries;
+    std::unordered_map<GlyphDiskKey, Bytes, FastHash> m_pending; // Serialized records
+
+    void open();
+};
+
+} // namespace Internal
+
+} // namespace Brisk
@@ -0,0 +1,219 @@
+/*
+ * Brisk
+ *
+ * Cross-platform application framework
+ * --------------------------------------------------------------
+ *
+ * Copyright (C) 2024 Brisk Developers
+ *
+ * This file is part of the Brisk library.
+ *
+ * Brisk is dual-licensed under the GNU General Public License, version 2 (GPL-2.0+),
+ * and a commercial license. You may use, modify, and distribute this software under
+ * the terms of the GPL-2.0+ license if you comply with its conditions.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * If you do not wish to be bound by the GPL-2.0+ license, you must purchase a commercial
+ * license. For commercial licensing options, please visit: https://brisklib.com
+ */
+#include "GlyphCache.hpp"
+#include <brisk/core/Utilities.hpp>
+#include <catch2/catch_all.hpp>
+#include "Catch2Utils.hpp"
+
+namespace Brisk {
+
+using namespace Internal;
+
+static GlyphData testGlyph(int width, int height, uint8_t seed) {
+    GlyphData glyph;
+    glyph.size   = Size(width, height);
+    glyph.sprite = makeSprite(glyph.size);
+    for (int i = 0; i < glyph.size.area(); ++i)
+        glyph.sprite->data()[i] = uint8_t(seed + i);
+    glyph.offset_x  = 0.25f * seed;
+    glyph.offset_y  = seed;
+    glyph.advance_x = 1.5f * seed;
+    return glyph;
+}
+
+static GlyphDiskKey testKey(uint32_t glyphIndex) {
+    return { 0x0123456789ABCDEFull, glyphIndex, 14 * 64, 1, 0 };
+}
+
+static void checkGlyph(const optional<GlyphData>& glyph, const GlyphData& expected) {
+    REQUIRE(glyph.has_value());
+    CHECK(glyph->size == expected.size);
+    CHECK(glyph->offset_x == expected.offset_x);
+    CHECK(glyph->offset_y == expected.offset_y);
+    CHECK(glyph->advance_x == expected.advance_x);
+    CHECK(std::ranges::equal(glyph->sprite->bytes(), expected.sprite->bytes()));
+}
+
+TEST_CASE("GlyphDiskCache") {
+    const fs::path tmpDir = tempFilePath("brisk-glyphs-*");
+    SCOPE_EXIT {
+        std::error_code ec;
+        fs::remove_all(tmpDir, ec);
+    };
+    const fs::path path = tmpDir / "cache" / "glyphs.bin";
+    constexpr uint64_t salt = 1;
+
+    {
+        GlyphDiskCache cache(path, 1 << 20, salt);
+        CHECK(cache.size() == 0);
+        for (uint32_t i = 0; i < 10; ++i)
+            cache.store(testKey(i), testGlyph(i, 12, i));
+        checkGlyph(cache.load(testKey(3)), testGlyph(3, 12, 3));
+        CHECK(!cache.load(testKey(10)).has_value());
+    } // Flushed by the destructor
+    REQUIRE(fs::exists(path));
+
+    {
+        GlyphDiskCache cache(path, 1 << 20, salt);
+        CHECK(cache.size() == 10);
+        for (uint32_t i = 0; i < 10; ++i)
+            checkGlyph(cache.load(testKey(i)), testGlyph(i, 12, i));
+        // Empty glyphs are cached too
+        checkGlyph(cache.load(testKey(0)), testGlyph(0, 12, 0));
+    }
+
+    // A different rasterizer doesn't reuse the glyphs
+    CHECK(GlyphDiskCache(path, 1 << 20, salt + 1).size() == 0);
+
+    auto loadable = [&]() {
+        GlyphDiskCache cache(path, 1 << 20, salt);
+        int count = 0;
+        for (uint32_t i = 0; i < 10; ++i) {
+            if (optional<GlyphData> glyph = cache.load(testKey(i))) {
+                checkGlyph(glyph, testGlyph(i, 12, i));
+                ++count;
+            }
+        }
+        return count;
+    };
+
+    SECTION("Corruption") {
+        auto data = readBytes(path);
+        REQUIRE(data.has_value());
+        // Damage the last record
+        data->back() ^= 0xFF;
+        REQUIRE(writeBytes(path, *data));
+        CHECK(loadable() == 9);
+
+        // Truncated records are dropped
+        data->resize(data->size() - 20);
+        REQUIRE(writeBytes(path, *data));
+        CHECK(GlyphDiskCache(path, 1 << 20, salt).size() == 9);
+        CHECK(loadable() == 9);
+
+        REQUIRE(writeUtf8(path, "garbage"));
+        CHECK(GlyphDiskCache(path, 1 << 20, salt).size() == 0);
+    }
+
+    SECTION("Size limit") {
+        {
+            GlyphDiskCache cache(path, 1024, salt);
+            // Glyphs used in this session are kept first
+            CHECK(cache.load(testKey(9)).has_value());
+            cache.store(testKey(100), testGlyph(20, 20, 100));
+        }
+        CHECK(fs::file_size(path) <= 1024);
+        GlyphDiskCache cache(path, 1024, salt);
+        CHECK(cache.size() < 11);
+        checkGlyph(cache.load(testKey(100)), testGlyph(20, 20, 100));
+        checkGlyph(cache.load(testKey(9)), testGlyph(9, 12, 9));
+    }
+
+#ifndef BRISK_WINDOWS // Windows doesn't allow replacing a file mapped by another cache
+    SECTION("Concurrent writers") {
+        GlyphDiskCache cache1(path, 1 << 20, salt);
+        GlyphDiskCache cache2(path, 1 << 20, salt);
+        cache1.store(testKey(101), testGlyph(4, 4, 101));
+        cache2.store(testKey(102), testGlyph(4, 4, 102));
+        REQUIRE(cache1.flush());
+        REQUIRE(cache2.flush());
+        GlyphDiskCache cache(path, 1 << 20, salt);
+        CHECK(cache.size() == 12);
+        checkGlyph(cache.load(testKey(101)), testGlyph(4, 4, 101));
+        checkGlyph(cache.load(testKey(102)), testGlyph(4, 4, 102));
+    }
+#endif
+}
+
+static std::u32string glyphCacheText() {
+    std::u32string text;
+    for (char32_t ch = U'!'; ch < 0x250; ++ch)
+        text += ch;
+    return text;
+}
+
+// Rasterizes every glyph of the text as the renderer does
+static size_t renderGlyphs(const FontManager& manager, const Font& font, const std::u32string& text) {
+    size_t bytes = 0;
+    for (const GlyphRun& run : manager.prerender(font, text).runs) {
+        for (const Glyph& g : run.glyphs) {
+            if (optional<GlyphData> data = g.load(run); data && data->sprite)
+                bytes += data->sprite->bytes().size();
+        }
+    }
+    return bytes;
+}
+
+TEST_CASE("FontManager glyph cache") {
+    auto ttf = readBytes(fs::path(PROJECT_SOURCE_DIR) / "resources" / "fonts" / "Lato-Medium.ttf");
+    REQUIRE(ttf.has_value());
+    const fs::path tmpDir = tempFilePath("brisk-glyphs-*");
+    SCOPE_EXIT {
+        std::error_code ec;
+        fs::remove_all(tmpDir, ec);
+    };
+    const fs::path path       = tmpDir / "glyphs.bin";
+    const std::u32string text = glyphCacheText();
+    Font font{ FontFamily(0), 17.f };
+
+    FontManager reference(nullptr, 1, 5000);
+    reference.addFont(FontFamily(0), FontStyle::Normal, FontWeight::Regular, *ttf);
+    const size_t expected = renderGlyphs(reference, font, text);
+
+    for (int pass = 0; pass < 2; ++pass) {
+        FontManager manager(nullptr, 1, 5000);
+        manager.setGlyphCachePath(path);
+        manager.addFont(FontFamily(0), FontStyle::Normal, FontWeight::Regular, *ttf);
+        CHECK(renderGlyphs(manager, font, text) == expected);
+    }
+    CHECK(fs::file_size(path) > expected);
+}
+
+TEST_CASE("FontManager glyph cache benchmark", "[.benchmark]") {
+    auto ttf = readBytes(fs::path(PROJECT_SOURCE_DIR) / "resources" / "fonts" / "GoNotoCurrent-Regular.ttf");
+    REQUIRE(ttf.has_value());
+    const fs::path tmpDir = tempFilePath("brisk-glyphs-*");
+    SCOPE_EXIT {
+        std::error_code ec;
+        fs::remove_all(tmpDir, ec);
+    };
+    const fs::path path       = tmpDir / "glyphs.bin";
+    const std::u32string text = glyphCacheText();
+    Font font{ FontFamily(0), 17.f };
+
+    auto startup = [&](bool useCache) {
+        FontManager manager(nullptr, 1, 5000);
+        if (useCache)
+            manager.setGlyphCachePath(path);
+        manager.addFont(FontFamily(0), FontStyle::Normal, FontWeight::Regular, *ttf, false);
+        return renderGlyphs(manager, font, text);
+    };
+    startup(true); // Populate the cache
+
+    BENCHMARK("cold startup") {
+        return startup(false);
+    };
+    BENCHMARK("warm startup") {
+        return startup(true);
+    };
+}
+
+} // namespace Brisk
@@ -27,10 +27,13 @@
 
 #include <brisk/core/Time.hpp>
 #include <brisk/core/Embed.hpp>
+#include <mutex>
 #include <unicode/putil.h>
 #include <unicode/uclean.h>
 #include <unicode/ubidi.h>
 #include <unicode/brkiter.h>
+#include <unicode/uchar.h>
+#include <unicode/utext.h>
 #include <resources/icudt.hpp>
 
 // Externally declare the ICU data array. This array will hold the ICU data.
@@ -43,11 +46,7 @@ namespace Brisk {
 bool icuAvailable = true;
 
 // Uncompress and initialize ICU data.
-static void uncompressICUData() {
-    static bool icuDataInit = false;
-    if (icuDataInit)
-        return;
-
+static void uncompressICUDataOnce() {
     // Unpack the ICU data.
     auto&& b = icudt();
 
@@ -57,8 +56,6 @@ static void uncompressICUData() {
     // Copy the uncompressed ICU data into the external data array.
     memcpy(icudt74_dat, b.data(), b.size());
 
-    icuDataInit     = true;
-
     // Initialize ICU with error checking.
     UErrorCode uerr = U_ZERO_ERROR;
     u_init(&uerr);
@@ -69,6 +66,12 @@ static void uncompressICUData() {
     }
 }
 
+static void uncompressICUData() {
+    // Shaping may run on several threads at once
+    static std::once_flag icuDataInit;
+    std::call_once(icuDataInit, &uncompressICUDataOnce);
+}
+
 struct UBiDiDeleter {
     void operator()(UBiDi* ptr) {
         ubidi_close(ptr);
@@ -79,9 +82,6 @@ struct UBiDiDeleter {
     throwException(EUnicode("ICU Error: {}", safeCharPtr(u_errorName(err))));
 }
 
-static std::mutex breakIteratorMutex;
-static std::unique_ptr<icu::BreakIterator> breakIterators[3];
-
 static std::unique_ptr<icu::BreakIterator> createBreakIterator(TextBreakMode mode) {
     uncompressICUData();
     UErrorCode uerr = U_ZERO_ERROR;
@@ -106,39 +106,81 @@ static std::unique_ptr<icu::BreakIterator> createBreakIterator(TextBreakMode mod
     }
 }
 
-template <typename Fn>
-static auto withBreakIterator(TextBreakMode mode, Fn&& fn) {
-    std::unique_lock<std::mutex> lk(breakIteratorMutex, std::defer_lock_t{});
-    if (lk.try_lock()) {
+namespace {
+
+// ICU objects and scratch memory owned by a single thread and reused between calls
+struct ICUContext {
+    std::unique_ptr<UBiDi, UBiDiDeleter> bidi;
+    std::unique_ptr<icu::BreakIterator> breakIterators[3];
+    std::u16string u16;
+
+    UBiDi* getBidi() {
+        if (!bidi) {
+            UErrorCode uerr = U_ZERO_ERROR;
+            bidi.reset(ubidi_openSized(0, 0, &uerr));
+            if (U_FAILURE(uerr))
+                handleICUErr(uerr);
+        }
+        return bidi.get();
+    }
+
+    icu::BreakIterator& breakIterator(TextBreakMode mode) {
         if (!breakIterators[+mode])
             breakIterators[+mode] = createBreakIterator(mode);
-        return fn(*breakIterators[+mode]);
-    } else {
-        std::unique_ptr<icu::BreakIterator> iter(createBreakIterator(mode));
-        return fn(*iter);
+        return *breakIterators[+mode];
     }
-}
 
-std::vector<int32_t> textBreakPositions(std::u32string_view text, TextBreakMode mode) {
-    return withBreakIterator(mode, [text](icu::BreakIterator& iter) {
-        std::vector<int32_t> result;
-        u16string u16 = utf32ToUtf16(text);
-        icu::UnicodeString ustr(u16.data(), u16.size());
-        iter.setText(ustr);
-        size_t codepoints = 0;
-        result.clear();
-        result.push_back(0);
-        int32_t p    = iter.next();
-        int32_t oldp = 0;
-        while (p != icu::BreakIterator::DONE) {
-            codepoints +=
-                utf16Codepoints(std::u16string_view{ u16.data() + oldp, static_cast<size_t>(p - oldp) });
-            result.push_back(codepoints);
-            oldp = p;
-            p    = iter.next();
+    // Converts text into the scratch buffer. Invalid codepoints become U+FFFD as in utf32ToUtf16
+    std::u16string_view toUtf16(std::u32string_view text) {
+        u16.clear();
+        for (char32_t ch : text) {
+            if (ch < 0x10000) {
+                u16.push_back(ch >= 0xD800 && ch < 0xE000 ? char16_t(replacementChar) : char16_t(ch));
+            } else if (ch < 0x110000) {
+                ch -= 0x10000;
+                u16.push_back(char16_t(0xD800 + (ch >> 10)));
+                u16.push_back(char16_t(0xDC00 + (ch & 0x3FF)));
+            } else {
+                u16.push_back(char16_t(replacementChar));
+            }
         }
-        return result;
-    });
+        return u16;
+    }
+};
+
+thread_local ICUContext icuContext;
+
+} // namespace
+
+std::vector<int32_t> textBreakPositions(std::u32string_view text, TextBreakMode mode) {
+    icu::BreakIterator& iter = icuContext.breakIterator(mode);
+    std::u16string_view u16  = icuContext.toUtf16(text);
+    UErrorCode uerr          = U_ZERO_ERROR;
+    // Iterate over the scratch buffer directly instead of copying it into a UnicodeString
+    UText utext              = UTEXT_INITIALIZER;
+    utext_openUChars(&utext, u16.data(), u16.size(), &uerr);
+    iter.setText(&utext, uerr);
+    utext_close(&utext);
+    if (U_FAILURE(uerr))
+        handleICUErr(uerr);
+
+    std::vector<int32_t> result;
+    result.push_back(0);
+    // Without surrogate pairs UTF-16 offsets are codepoint offsets
+    const bool bmpOnly = u16.size() == text.size();
+    size_t codepoints  = 0;
+    int32_t p          = iter.next();
+    int32_t oldp       = 0;
+    while (p != icu::BreakIterator::DONE) {
+        if (bmpOnly)
+            codepoints = p;
+        else
+            codepoints += utf16Codepoints(u16.substr(oldp, p - oldp));
+        result.push_back(codepoints);
+        oldp = p;
+        p    = iter.next();
+    }
+    return result;
 }
 
 static TextDirection toDir(UBiDiDirection direction) {
@@ -149,6 +191,38 @@ static TextDirection toDir(UBiDiLevel level) {
     return (level & 1) ? TextDirection::RTL : TextDirection::LTR;
 }
 
+// Returns true if the bidi algorithm may assign an odd level to any part of the text
+static bool needsBidi(std::u32string_view text, TextDirection defaultDirection) {
+    bool hasStrongLTR = defaultDirection == TextDirection::LTR;
+    for (char32_t ch : text) {
+        // No right-to-left or explicit formatting characters before the Hebrew block
+        if (ch < 0x0590 && hasStrongLTR)
+            continue;
+        switch (u_charDirection(ch)) {
+        case U_LEFT_TO_RIGHT:
+            hasStrongLTR = true;
+            break;
+        case U_RIGHT_TO_LEFT:
+        case U_RIGHT_TO_LEFT_ARABIC:
+        case U_ARABIC_NUMBER:
+        case U_LEFT_TO_RIGHT_EMBEDDING:
+        case U_LEFT_TO_RIGHT_OVERRIDE:
+        case U_RIGHT_TO_LEFT_EMBEDDING:
+        case U_RIGHT_TO_LEFT_OVERRIDE:
+        case U_POP_DIRECTIONAL_FORMAT:
+        case U_FIRST_STRONG_ISOLATE:
+        case U_LEFT_TO_RIGHT_ISOLATE:
+        case U_RIGHT_TO_LEFT_ISOLATE:
+        case U_POP_DIRECTIONAL_ISOLATE:
+            return true;
+        default:
+            break;
+        }
+    }
+    // Without any strong character the paragraph takes the default direction
+    return !hasStrongLTR;
+}
+
 #define HANDLE_UERROR(returncode)                                                                            \
     if (U_FAILURE(uerr)) {                                                                                   \
         handleICUErr(uerr);                                                                                  \
@@ -160,17 +234,20 @@ namespace Internal {
 std::vector<TextRun> splitTextRuns(std::u32string_view text, TextDirection defaultDirection) {
     uncompressICUData();
     std::vector<TextRun> textRuns;
-    UErrorCode uerr = U_ZERO_ERROR;
-    std::unique_ptr<UBiDi, UBiDiDeleter> bidi(ubidi_openSized(0, 0, &uerr));
-    HANDLE_UERROR(textRuns)
+    if (!needsBidi(text, defaultDirection)) {
+        textRuns.push_back(TextRun{ TextDirection::LTR, 0, (int32_t)text.size(), 0, nullptr });
+        return textRuns;
+    }
+    UErrorCode uerr        = U_ZERO_ERROR;
+    UBiDi* bidi            = icuContext.getBidi();
 
-    std::u16string u16 = utf32ToUtf16(text);
-    ubidi_setPara(bidi.get(), u16.data(), u16.size(),
+    std::u16string_view u16 = icuContext.toUtf16(text);
+    ubidi_setPara(bidi, u16.data(), u16.size(),
                   defaultDirection == TextDirection::LTR ? UBIDI_DEFAULT_LTR : UBIDI_DEFAULT_RTL, nullptr,
                   &uerr);
     HANDLE_UERROR(textRuns)
 
-    UBiDiDirection direction = ubidi_getDirection(bidi.get());
+    UBiDiDirection direction = ubidi_getDirection(bidi);
     if (direction != UBIDI_MIXED) {
         textRuns.push_back(TextRun{
             toDir(direction),
@@ -180,7 +257,7 @@ std::vector<TextRun> splitTextRuns(std::u32string_view text, TextDirection defau
             nullptr,
         });
     } else {
-        int32_t count = ubidi_countRuns(bidi.get(), &uerr);
+        int32_t count = ubidi_countRuns(bidi, &uerr);
         HANDLE_UERROR(textRuns)
         int32_t codepoints = 0;
         int32_t u16chars   = 0;
@@ -189,13 +266,13 @@ std::vector<TextRun> splitTextRuns(std::u32string_view text, TextDirection defau
             r.face = nullptr;
             int32_t u16length;
             UBiDiLevel level;
-            ubidi_getLogicalRun(bidi.get(), u16chars, &u16length, &level);
+            ubidi_getLogicalRun(bidi, u16chars, &u16length, &level);
             u16length -= u16chars;
             r.direction   = toDir(level);
             r.begin       = codepoints;
-            r.end         = codepoints + utf16Codepoints(u16string_view(u16).substr(u16chars, u16length));
+            r.end         = codepoints + utf16Codepoints(u16.substr(u16chars, u16length));
             codepoints    = r.end;
-            r.visualOrder = ubidi_getVisualIndex(bidi.get(), u16chars, &uerr);
+            r.visualOrder = ubidi_getVisualIndex(bidi, u16chars, &uerr);
             HANDLE_UERROR(textRuns)
             textRuns.push_back(r);
             u16chars += u16length;
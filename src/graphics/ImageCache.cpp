@@ -0,0 +1,177 @@
+/*
+ * Brisk
+ *
+ * Cross-platform application framework
+ * --------------------------------------------------------------
+ *
+ * Copyright (C) 2024 Brisk Developers
+ *
+ * This file is part of the Brisk library.
+ *
+ * Brisk is dual-licensed under the GNU General Public License, version 2 (GPL-2.0+),
+ * and a commercial license. You may use, modify, and distribute this software under
+ * the terms of the GPL-2.0+ license if you comply with its conditions.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * If you do not wish to be bound by the GPL-2.0+ license, you must purchase a commercial
+ * license. For commercial licensing options, please visit: https://brisklib.com
+ */
+#include <brisk/graphics/ImageCache.hpp>
+
+namespace Brisk {
+
+ImageCache::ImageCache(size_t budget) : m_budget(budget) {}
+
+// imageDecode returns the original size when the image doesn't cover minSize
+static bool isOriginal(Size decoded, Size minSize) {
+    return minSize.empty() || decoded.width < minSize.width || decoded.height < minSize.height;
+}
+
+static bool matches(Size size, bool original, Size minSize) {
+    if (minSize.empty())
+        return original;
+    // A decode at the original size can't be improved, so it serves any larger request
+    if (size.width < minSize.width || size.height < minSize.height)
+        return original;
+    // Larger decodes would waste texture memory and sample poorly when drawn this small
+    return size.width < 2 * minSize.width || size.height < 2 * minSize.height;
+}
+
+RC<Image> ImageCache::findLocked(uint64_t source, Size minSize, ImageFormat format) {
+    auto [first, last]              = m_index.equal_range(source);
+    std::list<Entry>::iterator best = m_lru.end();
+    for (auto it = first; it != last; ++it) {
+        const Entry& entry = *it->second;
+        if (entry.format != format || !matches(entry.image->size(), entry.original, minSize))
+            continue;
+        if (best == m_lru.end() || entry.image->size().area() < best->image->size().area())
+            best = it->second;
+    }
+    if (best == m_lru.end())
+        return nullptr;
+    m_lru.splice(m_lru.begin(), m_lru, best);
+    return best->image;
+}
+
+// Unlinks the entry from the index, the caller erases it from the list
+void ImageCache::removeLocked(std::list<Entry>::iterator entry) {
+    auto [first, last] = m_index.equal_range(entry->source);
+    for (auto it = first; it != last; ++it) {
+        if (it->second == entry) {
+            m_index.erase(it);
+            break;
+        }
+    }
+    m_bytes -= entry->image->byteSize();
+}
+
+void ImageCache::evictLocked() {
+    for (auto it = m_lru.end(); it != m_lru.begin() && m_bytes > m_budget;) {
+        --it;
+        // Only the cache holds a reference, so the memory is freed
+        if (it->image.use_count() != 1)
+            continue;
+        removeLocked(it);
+        ++m_statistics.evictions;
+        it = m_lru.erase(it);
+    }
+}
+
+expected<RC<Image>, ImageIOError> ImageCache::decode(uint64_t source, bytes_view encoded, Size minSize,
+                                                     ImageFormat format) {
+    const PendingKey key{ source, minSize.width, minSize.height, format };
+    std::promise<expected<RC<Image>, ImageIOError>> promise;
+    std::shared_future<expected<RC<Image>, ImageIOError>> pending;
+    {
+        std::lock_guard lk(m_mutex);
+        if (RC<Image> image = findLocked(source, minSize, format)) {
+            ++m_statistics.hits;
+            return image;
+        }
+        if (auto it = m_pending.find(key); it != m_pending.end()) {
+            // Another thread is decoding the same image
+            ++m_statistics.hits;
+            pending = it->second;
+        } else {
+            ++m_statistics.misses;
+            m_pending.emplace(key, promise.get_future().share());
+        }
+    }
+    if (pending.valid())
+        return pending.get();
+
+    expected<RC<Image>, ImageIOError> result = unexpected(ImageIOError::CodecError);
+    try {
+        result = minSize.empty() ? imageDecode(encoded, format) : imageDecode(encoded, minSize, format);
+    } catch (...) {
+        {
+            std::lock_guard lk(m_mutex);
+            m_pending.erase(key);
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+
+    {
+        std::lock_guard lk(m_mutex);
+        m_pending.erase(key);
+        if (result) {
+            const RC<Image>& image = *result;
+            m_lru.push_front(Entry{ source, format, isOriginal(image->size(), minSize), image });
+            m_index.emplace(source, m_lru.begin());
+            m_bytes += image->byteSize();
+            evictLocked();
+        }
+    }
+    promise.set_value(result);
+    return result;
+}
+
+RC<Image> ImageCache::find(uint64_t source, Size minSize, ImageFormat format) {
+    std::lock_guard lk(m_mutex);
+    return findLocked(source, minSize, format);
+}
+
+void ImageCache::setBudget(size_t budget) {
+    std::lock_guard lk(m_mutex);
+    m_budget = budget;
+    evictLocked();
+}
+
+size_t ImageCache::budget() const {
+    std::lock_guard lk(m_mutex);
+    return m_budget;
+}
+
+void ImageCache::clear() {
+    std::lock_guard lk(m_mutex);
+    for (auto it = m_lru.begin(); it != m_lru.end();) {
+        if (it->image.use_count() != 1) {
+            ++it;
+            continue;
+        }
+        removeLocked(it);
+        it = m_lru.erase(it);
+    }
+}
+
+ImageCache::Statistics ImageCache::statistics() const {
+    std::lock_guard lk(m_mutex);
+    Statistics result = m_statistics;
+    result.entries    = m_lru.size();
+    result.bytes      = m_bytes;
+    for (const Entry& entry : m_lru) {
+        if (entry.image.use_count() > 1)
+            result.pinnedBytes += entry.image->byteSize();
+    }
+    return result;
+}
+
+ImageCache& imageCache() {
+    static ImageCache cache(256 * 1024 * 1024);
+    return cache;
+}
+
+} // namespace Brisk
@@ -0,0 +1,126 @@
+/*
+ * Brisk
+ *
+ * Cross-platform application framework
+ * --------------------------------------------------------------
+ *
+ * Copyright (C) 2024 Brisk Developers
+ *
+ * This file is part of the Brisk library.
+ *
+ * Brisk is dual-licensed under the GNU General Public License, version 2 (GPL-2.0+),
+ * and a commercial license. You may use, modify, and distribute this software under
+ * the terms of the GPL-2.0+ license if you comply with its conditions.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * If you do not wish to be bound by the GPL-2.0+ license, you must purchase a commercial
+ * license. For commercial licensing options, please visit: https://brisklib.com
+ */
+#include <brisk/graphics/ImageCache.hpp>
+#include <brisk/core/Threading.hpp>
+#include <catch2/catch_all.hpp>
+#include "Catch2Utils.hpp"
+
+namespace Brisk {
+
+static bytes testImage() {
+    auto bytes = readBytes(fs::path(PROJECT_SOURCE_DIR) / "src" / "graphics" / "testdata" / "16616460-rgb.png");
+    REQUIRE(!!bytes);
+    return std::move(*bytes);
+}
+
+TEST_CASE("ImageCache") {
+    const bytes png   = testImage();
+    const uint64_t id = imageSourceId(png);
+    ImageCache cache(16 * 1024 * 1024);
+
+    auto full = cache.decode(id, png);
+    REQUIRE(full.has_value());
+    CHECK((*full)->size() == Size{ 320, 213 });
+    CHECK(cache.decode(id, png).value() == *full);
+
+    auto small = cache.decode(id, png, Size{ 100, 75 });
+    REQUIRE(small.has_value());
+    CHECK((*small)->size() == Size{ 113, 75 });
+    // Served by a cached decode that covers the size and isn't much larger
+    CHECK(cache.decode(id, png, Size{ 90, 60 }).value() == *small);
+    CHECK(cache.find(id, Size{ 90, 60 }) == *small);
+    // The original size serves any larger request
+    CHECK(cache.decode(id, png, Size{ 400, 300 }).value() == *full);
+    // Other formats are cached separately
+    CHECK(cache.find(id, Size{}, ImageFormat::RGB) == nullptr);
+
+    ImageCache::Statistics stats = cache.statistics();
+    CHECK(stats.misses == 2);
+    CHECK(stats.hits == 3);
+    CHECK(stats.entries == 2);
+    CHECK(stats.bytes == (*full)->byteSize() + (*small)->byteSize());
+    CHECK(stats.pinnedBytes == stats.bytes);
+}
+
+TEST_CASE("ImageCache eviction") {
+    const bytes png        = testImage();
+    const size_t imageSize = 320 * 213 * 4;
+    ImageCache cache(imageSize * 5 / 2);
+
+    // Distinct sources with the same contents
+    for (uint64_t id : { 1, 2 }) {
+        REQUIRE(cache.decode(id, png).has_value());
+    }
+    CHECK(cache.statistics().bytes == 2 * imageSize);
+    REQUIRE(cache.decode(3, png).has_value());
+    CHECK(cache.find(1) == nullptr);
+    CHECK(cache.find(2) != nullptr);
+    CHECK(cache.find(3) != nullptr);
+    CHECK(cache.statistics().evictions == 1);
+
+    // Least recently used goes first
+    CHECK(cache.find(2) != nullptr);
+    REQUIRE(cache.decode(4, png).has_value());
+    CHECK(cache.find(3) == nullptr);
+    CHECK(cache.find(2) != nullptr);
+
+    // Referenced images are pinned and may exceed the budget
+    RC<Image> pinned1            = cache.find(2);
+    RC<Image> pinned2            = cache.find(4);
+    RC<Image> pinned3            = cache.decode(5, png).value();
+    ImageCache::Statistics stats = cache.statistics();
+    CHECK(stats.entries == 3);
+    CHECK(stats.bytes == 3 * imageSize);
+    CHECK(stats.pinnedBytes == 3 * imageSize);
+
+    // Unpinned images are evicted once there is pressure again. The image being returned is in use
+    pinned1 = nullptr;
+    REQUIRE(cache.decode(6, png).has_value());
+    CHECK(cache.find(2) == nullptr);
+    CHECK(cache.statistics().entries == 3);
+
+    cache.setBudget(0);
+    CHECK(cache.statistics().entries == 2);
+    pinned2 = nullptr;
+    pinned3 = nullptr;
+    cache.setBudget(imageSize);
+    CHECK(cache.statistics().entries == 1);
+    cache.clear();
+    CHECK(cache.statistics().entries == 0);
+    CHECK(cache.statistics().bytes == 0);
+}
+
+TEST_CASE("ImageCache concurrent decodes") {
+    const bytes png = testImage();
+    ImageCache cache(16 * 1024 * 1024);
+    WorkerPool pool(4);
+    std::vector<RC<Image>> images(16);
+    pool.parallelFor(images.size(), [&](size_t i) {
+        images[i] = cache.decode(7, png, Size{ 100, 75 }).value();
+    });
+    for (const RC<Image>& image : images) {
+        CHECK(image == images.front());
+    }
+    CHECK(cache.statistics().misses == 1);
+    CHECK(cache.statistics().hits == images.size() - 1);
+}
+
+} // namespace Brisk
@@ -19,6 +19,7 @@
  * license. For commercial licensing options, please visit: https://brisklib.com
  */
 #include <brisk/graphics/ImageFormats.hpp>
+#include <brisk/graphics/ImageTransform.hpp>
 #include <brisk/core/Utilities.hpp>
 #include <brisk/core/Utilities.hpp>
 #include <brisk/core/Log.hpp>
@@ -82,4 +83,24 @@ expected<RC<Image>, ImageIOError> imageDecode(bytes_view bytes, ImageFormat form
     return imageDecode(*codec, bytes, format);
 }
 
+expected<RC<Image>, ImageIOError> imageDecode(bytes_view bytes, Size minSize, ImageFormat format) {
+    auto codec = guessImageCodec(bytes);
+    if (!codec)
+        return unexpected(ImageIOError::CodecError);
+    expected<RC<Image>, ImageIOError> image =
+        *codec == ImageCodec::JPEG ? jpegDecode(bytes, minSize, format) : imageDecode(*codec, bytes, format);
+    if (!image)
+        return image;
+    const Size size = (*image)->size();
+    if (size.width <= minSize.width || size.height <= minSize.height)
+        return image;
+    // The side with the larger ratio gets exactly its minimum, the other one is rounded up
+    const int64_t w   = size.width, h = size.height;
+    const Size scaled =
+        minSize.width * h >= minSize.height * w
+            ? Size{ minSize.width, int((h * minSize.width + w - 1) / w) }
+            : Size{ int((w * minSize.height + h - 1) / h), minSize.height };
+    return imageResize(std::move(*image), scaled);
+}
+
 } // namespace Brisk
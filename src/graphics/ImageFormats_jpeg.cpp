@@ -71,7 +71,23 @@ bytes jpegEncode(RC<Image> image, optional<int> quality, optional<ColorSubsampli
     return result;
 }
 
-expected<RC<Image>, ImageIOError> jpegDecode(bytes_view bytes, ImageFormat format) {
+// Returns the smallest decoder scaling factor that keeps size at least minSize, never upscaling
+static tjscalingfactor scalingFactor(Size size, Size minSize) {
+    tjscalingfactor best{ 1, 1 };
+    int numFactors                 = 0;
+    const tjscalingfactor* factors = tjGetScalingFactors(&numFactors);
+    for (int i = 0; i < numFactors; ++i) {
+        const tjscalingfactor f = factors[i];
+        if (f.num > f.denom || f.num * best.denom >= best.num * f.denom)
+            continue;
+        if (TJSCALED(size.width, f) >= minSize.width && TJSCALED(size.height, f) >= minSize.height)
+            best = f;
+    }
+    return best;
+}
+
+static expected<RC<Image>, ImageIOError> jpegDecode(bytes_view bytes, ImageFormat format,
+                                                    optional<Size> minSize) {
     if (toPixelType(format) != PixelType::U8Gamma && toPixelType(format) != PixelType::Unknown) {
         throwException(EImageError("JPEG codec doesn't support decoding to {} format", format));
     }
@@ -91,6 +107,10 @@ expected<RC<Image>, ImageIOError> jpegDecode(bytes_view bytes, ImageFormat forma
     if (pixelFormat == PixelFormat::Unknown) {
         pixelFormat = jpegSS == TJSAMP_GRAY ? PixelFormat::Greyscale : PixelFormat::RGB;
     }
+    if (minSize) {
+        const tjscalingfactor factor = scalingFactor(size, *minSize);
+        size                         = Size{ TJSCALED(size.width, factor), TJSCALED(size.height, factor) };
+    }
 
     RC<Image> image = rcnew Image(size, imageFormat(PixelType::U8Gamma, pixelFormat));
 
@@ -104,4 +124,12 @@ expected<RC<Image>, ImageIOError> jpegDecode(bytes_view bytes, ImageFormat forma
     return image;
 }
 
+expected<RC<Image>, ImageIOError> jpegDecode(bytes_view bytes, ImageFormat format) {
+    return jpegDecode(bytes, format, nullopt);
+}
+
+expected<RC<Image>, ImageIOError> jpegDecode(bytes_view bytes, Size minSize, ImageFormat format) {
+    return jpegDecode(bytes, format, minSize);
+}
+
 } // namespace Brisk
@@ -19,6 +19,7 @@
  * license. For commercial licensing options, please visit: https://brisklib.com
  */
 #include <brisk/graphics/ImageFormats.hpp>
+#include <brisk/graphics/ImageTransform.hpp>
 #include "VisualTests.hpp"
 #include "Catch2Utils.hpp"
 
@@ -76,4 +77,38 @@ TEST_CASE("ImageFormats(RGBA)") {
 TEST_CASE("ImageFormats(Greyscale)") {
     testImageSample<PixelFormat::Greyscale>("16616460-mono", { 320, 213 });
 }
+
+TEST_CASE("ImageFormats scaled decode") {
+    const fs::path testdata = fs::path(PROJECT_SOURCE_DIR) / "src" / "graphics" / "testdata";
+    auto raw                = readBytes(testdata / "16616460-rgb.raw");
+    REQUIRE(!!raw);
+    InplacePtr<Image> reference(raw->data(), Size{ 320, 213 }, 320 * 3, ImageFormat::RGB);
+
+    auto jpeg = readBytes(testdata / "16616460-rgb.jpg");
+    REQUIRE(!!jpeg);
+    // 3/8 is the smallest decoder scaling factor that covers 100x75
+    auto img  = jpegDecode(*jpeg, Size{ 100, 75 });
+    REQUIRE(img.has_value());
+    CHECK((*img)->size() == Size{ 120, 80 });
+    img = jpegDecode(*jpeg, Size{ 1000, 1000 });
+    REQUIRE(img.has_value());
+    CHECK((*img)->size() == Size{ 320, 213 });
+
+    img = imageDecode(*jpeg, Size{ 100, 75 }, ImageFormat::RGB);
+    REQUIRE(img.has_value());
+    CHECK((*img)->size() == Size{ 113, 75 });
+    CHECK(imagePSNR(*img, imageResize(reference, Size{ 113, 75 })) > 30);
+
+    auto png = readBytes(testdata / "16616460-rgb.png");
+    REQUIRE(!!png);
+    img = imageDecode(*png, Size{ 80, 20 }, ImageFormat::RGB);
+    REQUIRE(img.has_value());
+    CHECK((*img)->size() == Size{ 80, 54 });
+    CHECK(imagePSNR(*img, imageResize(reference, Size{ 80, 54 })) > 40);
+
+    // Images are never upscaled
+    img = imageDecode(*png, Size{ 400, 100 }, ImageFormat::RGB);
+    REQUIRE(img.has_value());
+    CHECK((*img)->size() == Size{ 320, 213 });
+}
 } // namespace Brisk
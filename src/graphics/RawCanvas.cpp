@@ -70,6 +70,16 @@ static GeometryGlyphs glyphLayout(SpriteResources& sprites, const PrerenderedTex
     return result;
 }
 
+PreparedText prepareText(const PrerenderedText& text) {
+    PreparedText result;
+    result.glyphs = glyphLayout(result.sprites, text);
+    for (const GlyphRun& run : text.runs) {
+        if (run.decoration != TextDecoration::None)
+            result.decorations.push_back(run);
+    }
+    return result;
+}
+
 GeometryGlyphs pathLayout(SpriteResources& sprites, const RasterizedPath& path) {
     GeometryGlyphs result;
     if (path.sprite) {
@@ -159,7 +169,18 @@ RawCanvas& RawCanvas::drawText(const PrerenderedText& run, RenderStateExArgs arg
     SpriteResources sprites;
     GeometryGlyphs g = glyphLayout(sprites, run);
     drawText(std::move(sprites), g, args);
-    for (const GlyphRun& run : run.runs) {
+    drawDecorations(run.runs, args);
+    return *this;
+}
+
+RawCanvas& RawCanvas::drawText(const PreparedText& text, RenderStateExArgs args) {
+    drawText(text.sprites, text.glyphs, args);
+    drawDecorations(text.decorations, args);
+    return *this;
+}
+
+void RawCanvas::drawDecorations(std::span<const GlyphRun> runs, RenderStateExArgs args) {
+    for (const GlyphRun& run : runs) {
         if (run.decoration != TextDecoration::None) {
             run.updateRanges();
             PointF p1{ run.textHRange.min + run.position.x, run.position.y };
@@ -179,7 +200,6 @@ RawCanvas& RawCanvas::drawText(const PrerenderedText& run, RenderStateExArgs arg
                          LineEnd::Butt, strokeWidth = 0.f, args);
         }
     }
-    return *this;
 }
 
 RawCanvas& RawCanvas::drawRectangle(const GeometryRectangle& rect, RenderStateExArgs args) {
@@ -220,7 +240,7 @@ RawCanvas& RawCanvas::drawArc(PointF center, float outerRadius, float innerRadiu
     return *this;
 }
 
-RawCanvas& RawCanvas::drawMask(SpriteResources sprites, std::span<GeometryGlyph> glyphs,
+RawCanvas& RawCanvas::drawMask(SpriteResources sprites, std::span<const GeometryGlyph> glyphs,
                                RenderStateExArgs args) {
     RenderStateEx style(ShaderType::Mask, glyphs.size(), args);
     style.subpixel_mode       = SubpixelMode::Off;
@@ -231,7 +251,7 @@ RawCanvas& RawCanvas::drawMask(SpriteResources sprites, std::span<GeometryGlyph>
     return *this;
 }
 
-RawCanvas& RawCanvas::drawText(SpriteResources sprites, std::span<GeometryGlyph> glyphs,
+RawCanvas& RawCanvas::drawText(SpriteResources sprites, std::span<const GeometryGlyph> glyphs,
                                RenderStateExArgs args) {
     RenderStateEx style(ShaderType::Text, glyphs.size(), args);
     style.subpixel_mode       = SubpixelMode::RGB;
@@ -181,4 +181,30 @@ RenderPipeline::~RenderPipeline() {
 int RenderPipeline::numBatches() const {
     return m_numBatches;
 }
+
+void RecordingContext::command(RenderStateEx&& cmd, std::span<const float> data) {
+    m_commands.push_back(Command{ std::move(cmd), uint32_t(m_data.size()), uint32_t(data.size()) });
+    m_data.insert(m_data.end(), data.begin(), data.end());
+}
+
+int RecordingContext::numBatches() const {
+    return 0;
+}
+
+std::span<const RecordingContext::Command> RecordingContext::commands() const noexcept {
+    return m_commands;
+}
+
+std::span<const float> RecordingContext::data() const noexcept {
+    return m_data;
+}
+
+void RecordingContext::replay(RenderContext& target) {
+    for (Command& cmd : m_commands) {
+        target.command(std::move(cmd.state),
+                       std::span<const float>{ m_data.data() + cmd.dataOffset, cmd.dataSize });
+    }
+    m_commands.clear();
+    m_data.clear();
+}
 } // namespace Brisk
@@ -155,6 +155,78 @@ TEST_CASE("Renderer - fonts") {
         ColorF{ 1.f, 1.f });
 }
 
+namespace {
+// Collects command data without rendering
+struct RecordingContext final : public RenderContext {
+    std::vector<float> data;
+    int commands = 0;
+
+    void command(RenderStateEx&& cmd, std::span<const float> data) final {
+        ++commands;
+        this->data.insert(this->data.end(), data.begin(), data.end());
+    }
+
+    int numBatches() const final {
+        return 0;
+    }
+};
+} // namespace
+
+TEST_CASE("PreparedText") {
+    auto ttf = readBytes(fs::path(PROJECT_SOURCE_DIR) / "resources" / "fonts" / "Lato-Medium.ttf");
+    REQUIRE(ttf.has_value());
+    fonts->addFont(FontFamily(45), FontStyle::Normal, FontWeight::Regular, *ttf, true, FontFlags::Default);
+    Font font{ FontFamily(45), 18.f };
+    font.textDecoration = TextDecoration::Underline;
+
+    PrerenderedText text = fonts->prerender(font, "The quick brown fox\njumps over the lazy dog");
+    text.alignLines(RectangleF{ 10.f, 10.f, 300.f, 100.f }, 0.5f, 0.5f);
+
+    RecordingContext direct;
+    RawCanvas(direct).drawText(text, fillColor = Palette::black);
+    RecordingContext prepared;
+    RawCanvas(prepared).drawText(prepareText(text), fillColor = Palette::black);
+    CHECK(prepared.commands == direct.commands);
+    CHECK(prepared.data == direct.data);
+}
+
+TEST_CASE("PreparedText benchmark", "[.benchmark]") {
+    auto ttf = readBytes(fs::path(PROJECT_SOURCE_DIR) / "resources" / "fonts" / "Lato-Medium.ttf");
+    REQUIRE(ttf.has_value());
+    fonts->addFont(FontFamily(45), FontStyle::Normal, FontWeight::Regular, *ttf, true, FontFlags::Default);
+    Font font{ FontFamily(45), 14.f };
+
+    std::vector<PrerenderedText> labels;
+    for (int i = 0; i < 2000; ++i) {
+        labels.push_back(fonts->prerender(font, fmt::format("Label number {}", i)));
+    }
+    std::vector<PreparedText> prepared;
+    for (const PrerenderedText& label : labels) {
+        PrerenderedText aligned = label;
+        aligned.alignLines(RectangleF{ 0.f, 0.f, 200.f, 20.f }, 0.f, 0.5f);
+        prepared.push_back(prepareText(aligned));
+    }
+
+    BENCHMARK("paint 2000 labels, align and layout every frame") {
+        RecordingContext context;
+        RawCanvas canvas(context);
+        for (const PrerenderedText& label : labels) {
+            PrerenderedText aligned = label;
+            aligned.alignLines(RectangleF{ 0.f, 0.f, 200.f, 20.f }, 0.f, 0.5f);
+            canvas.drawText(aligned, fillColor = Palette::black);
+        }
+        return context.data.size();
+    };
+    BENCHMARK("paint 2000 labels, prepared") {
+        RecordingContext context;
+        RawCanvas canvas(context);
+        for (const PreparedText& label : prepared) {
+            canvas.drawText(label, fillColor = Palette::black);
+        }
+        return context.data.size();
+    };
+}
+
 TEST_CASE("Renderer", "[gpu]") {
     const Rectangle frameBounds = Rectangle{ 0, 0, 480, 320 };
     RectangleF rect             = frameBounds.withPadding(10);
@@ -19,24 +19,119 @@
  * license. For commercial licensing options, please visit: https://brisklib.com
  */
 #include <brisk/graphics/SVG.hpp>
+#include <brisk/core/Hash.hpp>
 #include <lunasvg.h>
+#include <list>
+#include <mutex>
+#include <unordered_map>
 
 namespace Brisk {
 
 constexpr static PixelFormat lunaFormat = PixelFormat::BGRA;
 
 namespace Internal {
-struct SVGImpl : public lunasvg::Document {
-public:
-    using lunasvg::Document::Document;
+struct SVGImpl {
+    std::unique_ptr<lunasvg::Document> document;
+    uint64_t hash; // Hash of the source
+    std::mutex mutex;
+
+    ~SVGImpl();
 };
 } // namespace Internal
 
 using Internal::SVGImpl;
 
+namespace {
+struct RasterKey {
+    uint64_t hash;
+    Size size;
+    uint32_t background;
+
+    bool operator==(const RasterKey&) const noexcept = default;
+};
+
+struct RasterKeyHash {
+    size_t operator()(const RasterKey& key) const noexcept {
+        return fastHash(key.size, fastHash(key.background, key.hash));
+    }
+};
+
+// Least recently used rendered images within a byte budget
+struct RasterCache {
+    std::mutex mutex;
+    size_t budget = 16 * 1024 * 1024;
+    size_t bytes  = 0;
+    std::list<std::pair<RasterKey, RC<Image>>> lru; // Most recently used first
+    std::unordered_map<RasterKey, decltype(lru)::iterator, RasterKeyHash> index;
+
+    RC<Image> find(const RasterKey& key) {
+        std::lock_guard lk(mutex);
+        auto it = index.find(key);
+        if (it == index.end())
+            return nullptr;
+        lru.splice(lru.begin(), lru, it->second);
+        return it->second->second;
+    }
+
+    void insert(const RasterKey& key, RC<Image> image) {
+        std::lock_guard lk(mutex);
+        if (image->byteSize() > budget || index.contains(key))
+            return;
+        lru.emplace_front(key, std::move(image));
+        index.emplace(key, lru.begin());
+        bytes += lru.front().second->byteSize();
+        evict();
+    }
+
+    void evict() {
+        while (bytes > budget) {
+            bytes -= lru.back().second->byteSize();
+            index.erase(lru.back().first);
+            lru.pop_back();
+        }
+    }
+};
+
+RasterCache& rasterCache() {
+    static RasterCache cache;
+    return cache;
+}
+
+// Parsed documents by the hash of their source
+struct DocumentRegistry {
+    std::mutex mutex;
+    std::unordered_map<uint64_t, std::weak_ptr<SVGImpl>> documents;
+};
+
+DocumentRegistry& documentRegistry() {
+    // Never destroyed because documents may outlive static destruction
+    static DocumentRegistry* registry = new DocumentRegistry();
+    return *registry;
+}
+} // namespace
+
+SVGImpl::~SVGImpl() {
+    DocumentRegistry& registry = documentRegistry();
+    std::lock_guard lk(registry.mutex);
+    // The entry may already refer to a newer document with the same source
+    if (auto it = registry.documents.find(hash); it != registry.documents.end() && it->second.expired())
+        registry.documents.erase(it);
+}
+
 SVGImage::SVGImage(std::string_view svg) {
-    m_impl.reset(
-        reinterpret_cast<SVGImpl*>(lunasvg::Document::loadFromData(svg.data(), svg.size()).release()));
+    const uint64_t hash        = fastHash(svg);
+    DocumentRegistry& registry = documentRegistry();
+    std::lock_guard lk(registry.mutex);
+    if (auto it = registry.documents.find(hash); it != registry.documents.end()) {
+        m_impl = it->second.lock();
+        if (m_impl)
+            return;
+    }
+    std::unique_ptr<lunasvg::Document> document = lunasvg::Document::loadFromData(svg.data(), svg.size());
+    if (!document)
+        return;
+    m_impl = rcnew SVGImpl{ std::move(document), hash };
+    registry.documents.insert_or_assign(hash, m_impl);
 }
 
 SVGImage::SVGImage(bytes_view svg) : SVGImage(toStringView(svg)) {}
@@ -44,16 +139,41 @@ SVGImage::SVGImage(bytes_view svg) : SVGImage(toStringView(svg)) {}
 SVGImage::~SVGImage() = default;
 
 RC<Image> SVGImage::render(Size size, ColorF background) const {
-    Color color         = background;
-    lunasvg::Bitmap bmp = m_impl->renderToBitmap(size.width, size.height, std::bit_cast<uint32_t>(color));
-    RC<Image> image     = rcnew Image(size, ImageFormat::RGBA);
-    convertPixels(image->pixelFormat(), image->data().to<uint8_t>(), lunaFormat,
-                  StridedData<const uint8_t>{
-                      reinterpret_cast<const uint8_t*>(bmp.data()),
-                      int32_t(bmp.stride()),
-                  },
-                  size);
+    if (!m_impl)
+        return nullptr;
+    Color color        = background;
+    const RasterKey key{ m_impl->hash, size, std::bit_cast<uint32_t>(color) };
+    RasterCache& cache = rasterCache();
+    if (RC<Image> image = cache.find(key))
+        return image;
+
+    RC<Image> image = rcnew Image(size, ImageFormat::RGBA);
+    {
+        // lunasvg documents can't be rendered concurrently
+        std::lock_guard lk(m_impl->mutex);
+        lunasvg::Bitmap bmp = m_impl->document->renderToBitmap(size.width, size.height, key.background);
+        convertPixels(image->pixelFormat(), image->data().to<uint8_t>(), lunaFormat,
+                      StridedData<const uint8_t>{
+                          reinterpret_cast<const uint8_t*>(bmp.data()),
+                          int32_t(bmp.stride()),
+                      },
+                      size);
+    }
+    cache.insert(key, image);
     return image;
 }
 
+void SVGImage::setCacheBudget(size_t budget) {
+    RasterCache& cache = rasterCache();
+    std::lock_guard lk(cache.mutex);
+    cache.budget = budget;
+    cache.evict();
+}
+
+size_t SVGImage::cacheBudget() {
+    RasterCache& cache = rasterCache();
+    std::lock_guard lk(cache.mutex);
+    return cache.budget;
+}
+
 } // namespace Brisk
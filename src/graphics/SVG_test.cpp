@@ -0,0 +1,116 @@
+/*
+ * Brisk
+ *
+ * Cross-platform application framework
+ * --------------------------------------------------------------
+ *
+ * Copyright (C) 2024 Brisk Developers
+ *
+ * This file is part of the Brisk library.
+ *
+ * Brisk is dual-licensed under the GNU General Public License, version 2 (GPL-2.0+),
+ * and a commercial license. You may use, modify, and distribute this software under
+ * the terms of the GPL-2.0+ license if you comply with its conditions.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * If you do not wish to be bound by the GPL-2.0+ license, you must purchase a commercial
+ * license. For commercial licensing options, please visit: https://brisklib.com
+ */
+#include <brisk/graphics/SVG.hpp>
+#include <brisk/core/Utilities.hpp>
+#include <catch2/catch_all.hpp>
+#include "Catch2Utils.hpp"
+
+namespace Brisk {
+
+static std::string testIcon(int index) {
+    return fmt::format(R"(<svg xmlns="http://www.w3.org/2000/svg" viewBox="0 0 24 24">)"
+                       R"(<circle cx="12" cy="12" r="{}" fill="#{:06x}"/>)"
+                       R"(<path d="M6 12h12M12 6v12" stroke="white" stroke-width="2"/></svg>)",
+                       6 + index % 6, (0x102030 * (index + 1)) & 0xFFFFFF);
+}
+
+static bool samePixels(const RC<Image>& a, const RC<Image>& b) {
+    if (a->size() != b->size())
+        return false;
+    auto ra = a->mapRead<ImageFormat::RGBA>();
+    auto rb = b->mapRead<ImageFormat::RGBA>();
+    for (int y = 0; y < ra.height(); ++y) {
+        for (int x = 0; x < ra.width(); ++x) {
+            if (ra(x, y) != rb(x, y))
+                return false;
+        }
+    }
+    return true;
+}
+
+TEST_CASE("SVGImage raster cache") {
+    const std::string icon = testIcon(0);
+    SVGImage svg(icon);
+    RC<Image> small = svg.render({ 24, 24 });
+    REQUIRE(small != nullptr);
+    CHECK(small->size() == Size{ 24, 24 });
+    CHECK(svg.render({ 24, 24 }) == small);
+    // Images with the same source share rendered bitmaps
+    CHECK(SVGImage(icon).render({ 24, 24 }) == small);
+
+    RC<Image> large = svg.render({ 48, 48 });
+    CHECK(large != small);
+    CHECK(large->size() == Size{ 48, 48 });
+    RC<Image> filled = svg.render({ 24, 24 }, Palette::white);
+    CHECK(filled != small);
+
+    const size_t budget = SVGImage::cacheBudget();
+    SCOPE_EXIT {
+        SVGImage::setCacheBudget(budget);
+    };
+    SVGImage::setCacheBudget(0);
+    // Cached images match fresh renders
+    for (auto [cached, background] : { std::pair{ small, ColorF(0.f, 0.f) },
+                                       std::pair{ large, ColorF(0.f, 0.f) },
+                                       std::pair{ filled, ColorF(Palette::white) } }) {
+        RC<Image> fresh = svg.render(cached->size(), background);
+        CHECK(fresh != cached);
+        CHECK(samePixels(fresh, cached));
+    }
+    CHECK(svg.render({ 24, 24 }) != svg.render({ 24, 24 }));
+
+    // The oldest images are evicted once the budget is exceeded
+    SVGImage::setCacheBudget(3 * small->byteSize());
+    std::vector<RC<Image>> images;
+    for (int i = 0; i < 4; ++i) {
+        images.push_back(SVGImage(testIcon(i)).render({ 24, 24 }));
+    }
+    CHECK(SVGImage(testIcon(0)).render({ 24, 24 }) != images[0]);
+    CHECK(SVGImage(testIcon(3)).render({ 24, 24 }) == images[3]);
+
+    CHECK(SVGImage("not an svg").render({ 24, 24 }) == nullptr);
+}
+
+TEST_CASE("SVGImage toolbar benchmark", "[.benchmark]") {
+    std::vector<SVGImage> toolbar;
+    for (int i = 0; i < 100; ++i) {
+        toolbar.emplace_back(testIcon(i));
+    }
+    auto renderToolbar = [&]() {
+        size_t bytes = 0;
+        for (const SVGImage& icon : toolbar) {
+            bytes += icon.render({ 32, 32 })->byteSize();
+        }
+        return bytes;
+    };
+    BENCHMARK("100 icons, cached") {
+        return renderToolbar();
+    };
+    const size_t budget = SVGImage::cacheBudget();
+    SCOPE_EXIT {
+        SVGImage::setCacheBudget(budget);
+    };
+    SVGImage::setCacheBudget(0);
+    BENCHMARK("100 icons, uncached") {
+        return renderToolbar();
+    };
+}
+} // namespace Brisk
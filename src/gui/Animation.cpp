@@ -198,4 +198,120 @@ float easeInOutBounce(float t) {
 float easeLinear(float t) {
     return t;
 }
+
+namespace Internal {
+
+bool AnimationScheduler::set(Transition<ColorF>& transition, ColorF value, double time, float duration,
+                             EasingFunction easing) {
+    if (duration <= 0) {
+        if (transition.isActive())
+            remove(transition.slot);
+        return transition.set(value);
+    }
+    if (value == transition.stopValue && (transition.isActive() || value == transition.current))
+        return false;
+    transition.stopValue = value;
+    size_t index;
+    if (transition.isActive()) {
+        index = transition.slot;
+    } else {
+        index = m_targets.size();
+        m_start.emplace_back();
+        m_rate.emplace_back();
+        m_progress.emplace_back();
+        m_easing.emplace_back();
+        m_from.emplace_back();
+        m_to.emplace_back();
+        m_targets.push_back(&transition);
+        transition.slot = static_cast<int32_t>(index);
+    }
+    // Retargeting starts from wherever the running transition currently is
+    m_start[index]  = time;
+    m_rate[index]   = 1.f / duration;
+    m_easing[index] = easing ? easing : &easeLinear;
+    m_from[index]   = transition.current;
+    m_to[index]     = value;
+    return true;
+}
+
+void AnimationScheduler::finish(Transition<ColorF>& transition) {
+    if (!transition.isActive())
+        return;
+    remove(transition.slot);
+    transition.current = transition.stopValue;
+}
+
+void AnimationScheduler::remove(size_t index) {
+    m_targets[index]->slot = -1;
+    size_t last            = m_targets.size() - 1;
+    if (index != last) {
+        m_start[index]         = m_start[last];
+        m_rate[index]          = m_rate[last];
+        m_easing[index]        = m_easing[last];
+        m_from[index]          = m_from[last];
+        m_to[index]            = m_to[last];
+        m_targets[index]       = m_targets[last];
+        m_targets[index]->slot = static_cast<int32_t>(index);
+    }
+    m_start.pop_back();
+    m_rate.pop_back();
+    m_progress.pop_back();
+    m_easing.pop_back();
+    m_from.pop_back();
+    m_to.pop_back();
+    m_targets.pop_back();
+}
+
+size_t AnimationScheduler::tick(double time) {
+    const size_t count = m_targets.size();
+    if (count == 0)
+        return 0;
+
+    // Progress of every transition in one branch-free pass the compiler can vectorize
+    const double* start = m_start.data();
+    const float* rate   = m_rate.data();
+    float* progress     = m_progress.data();
+    for (size_t i = 0; i < count; ++i) {
+        progress[i] = std::clamp(static_cast<float>(time - start[i]) * rate[i], 0.f, 1.f);
+    }
+
+    size_t changed = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const float t = progress[i];
+        ColorF value;
+        if (t >= 1.f)
+            value = m_to[i];
+        else
+            value = mix(m_easing[i] == &easeLinear ? t : m_easing[i](t), m_from[i], m_to[i]);
+        Transition<ColorF>* target = m_targets[i];
+        if (value != target->current) {
+            target->current = value;
+            ++changed;
+        }
+    }
+
+    // Drop finished transitions, walking backwards so swapped-in entries were already visited
+    for (size_t i = count; i-- > 0;) {
+        if (progress[i] >= 1.f)
+            remove(i);
+    }
+    return changed;
+}
+
+bool AnimationScheduler::active() const noexcept {
+    return !m_targets.empty();
+}
+
+size_t AnimationScheduler::size() const noexcept {
+    return m_targets.size();
+}
+
+double AnimationScheduler::finishTime() const noexcept {
+    double result = 0;
+    for (size_t i = 0; i < m_targets.size(); ++i) {
+        result = std::max(result, m_start[i] + 1.0 / m_rate[i]);
+    }
+    return result;
+}
+} // namespace Internal
 } // namespace Brisk
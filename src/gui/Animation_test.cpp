@@ -0,0 +1,122 @@
+/*
+ * Brisk
+ *
+ * Cross-platform application framework
+ * --------------------------------------------------------------
+ *
+ * Copyright (C) 2024 Brisk Developers
+ *
+ * This file is part of the Brisk library.
+ *
+ * Brisk is dual-licensed under the GNU General Public License, version 2 (GPL-2.0+),
+ * and a commercial license. You may use, modify, and distribute this software under
+ * the terms of the GPL-2.0+ license if you comply with its conditions.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * If you do not wish to be bound by the GPL-2.0+ license, you must purchase a commercial
+ * license. For commercial licensing options, please visit: https://brisklib.com
+ */
+#include <catch2/catch_all.hpp>
+#include "Catch2Utils.hpp"
+#include <brisk/graphics/Palette.hpp>
+
+#include <brisk/gui/internal/Animation.hpp>
+
+namespace Brisk {
+
+using Internal::AnimationScheduler;
+using Internal::Transition;
+
+TEST_CASE("AnimationScheduler") {
+    AnimationScheduler scheduler;
+    Transition<ColorF> a{ ColorF(0.f, 0.f, 0.f, 1.f) };
+    Transition<ColorF> b{ ColorF(1.f, 1.f, 1.f, 1.f) };
+    CHECK(!scheduler.active());
+    CHECK(scheduler.tick(10.0) == 0);
+
+    // Zero duration jumps without scheduling
+    CHECK(scheduler.set(a, ColorF(0.f, 0.f, 1.f, 1.f), 10.0, 0.f, &easeLinear));
+    CHECK(a.current == ColorF(0.f, 0.f, 1.f, 1.f));
+    CHECK(!a.isActive());
+    CHECK(!scheduler.set(a, ColorF(0.f, 0.f, 1.f, 1.f), 10.0, 0.f, &easeLinear));
+
+    CHECK(scheduler.set(a, ColorF(1.f, 0.f, 1.f, 1.f), 10.0, 1.f, &easeLinear));
+    CHECK(scheduler.set(b, ColorF(0.f, 1.f, 1.f, 1.f), 10.0, 2.f, &easeInQuad));
+    CHECK(!scheduler.set(b, ColorF(0.f, 1.f, 1.f, 1.f), 10.5, 2.f, &easeInQuad));
+    CHECK(a.isActive());
+    CHECK(b.isActive());
+    CHECK(scheduler.size() == 2);
+    CHECK(scheduler.finishTime() == Catch::Approx(12.0));
+    CHECK(a.current == ColorF(0.f, 0.f, 1.f, 1.f));
+    CHECK(a.stopValue == ColorF(1.f, 0.f, 1.f, 1.f));
+
+    // Values are written back only when they change
+    CHECK(scheduler.tick(10.0) == 0);
+    CHECK(scheduler.tick(10.5) == 2);
+    CHECK(a.current.r == Catch::Approx(0.5f));
+    CHECK(b.current.r == Catch::Approx(1.f - easeInQuad(0.25f)));
+    CHECK(scheduler.tick(10.5) == 0);
+
+    // Finished transitions leave the scheduler with their final value
+    CHECK(scheduler.tick(11.25) == 2);
+    CHECK(a.current == ColorF(1.f, 0.f, 1.f, 1.f));
+    CHECK(!a.isActive());
+    CHECK(b.isActive());
+    CHECK(scheduler.size() == 1);
+
+    // Retargeting restarts from the current value
+    ColorF from = b.current;
+    CHECK(scheduler.set(b, ColorF(0.f, 0.f, 0.f, 1.f), 11.25, 1.f, &easeLinear));
+    CHECK(scheduler.size() == 1);
+    CHECK(scheduler.tick(11.75) == 1);
+    CHECK(b.current.r == Catch::Approx(from.r * 0.5f));
+    CHECK(b.current.g == Catch::Approx(from.g * 0.5f));
+
+    // Jumping cancels a running transition
+    CHECK(scheduler.set(b, ColorF(0.5f, 0.5f, 0.5f, 1.f), 11.75, 0.f, &easeLinear));
+    CHECK(!b.isActive());
+    CHECK(b.current == ColorF(0.5f, 0.5f, 0.5f, 1.f));
+    CHECK(!scheduler.active());
+    CHECK(scheduler.finishTime() == 0.0);
+    CHECK(scheduler.tick(20.0) == 0);
+}
+
+TEST_CASE("AnimationScheduler finish") {
+    AnimationScheduler scheduler;
+    std::vector<Transition<ColorF>> transitions(5, Transition<ColorF>{ Palette::black });
+    for (size_t i = 0; i < transitions.size(); ++i) {
+        scheduler.set(transitions[i], Palette::white, 0.0, 1.f + i, &easeLinear);
+    }
+    CHECK(scheduler.size() == 5);
+
+    // Removing from the middle keeps the remaining entries consistent
+    scheduler.finish(transitions[1]);
+    CHECK(transitions[1].current == Palette::white);
+    CHECK(!transitions[1].isActive());
+    CHECK(scheduler.size() == 4);
+
+    CHECK(scheduler.tick(2.0) == 4);
+    CHECK(transitions[0].current == Palette::white);
+    CHECK(transitions[2].current.r == Catch::Approx(2.f / 3.f));
+    CHECK(transitions[3].current.r == Catch::Approx(0.5f));
+    CHECK(transitions[4].current.r == Catch::Approx(0.4f));
+    CHECK(scheduler.size() == 3);
+
+    scheduler.finish(transitions[4]);
+    CHECK(transitions[4].current == Palette::white);
+    CHECK(scheduler.tick(4.0) == 2);
+    CHECK(transitions[2].current == Palette::white);
+    CHECK(transitions[3].current == Palette::white);
+    CHECK(!scheduler.active());
+
+    // A copy starts at the target value and is not scheduled
+    scheduler.set(transitions[0], Palette::black, 3.0, 1.f, &easeLinear);
+    Transition<ColorF> copy = transitions[0];
+    CHECK(!copy.isActive());
+    CHECK(copy.current == Palette::black);
+    scheduler.finish(transitions[0]);
+}
+
+} // namespace Brisk
@@ -1 +1,57 @@
+/*
+ * Brisk
+ *
+ * Cross-platform application framework
+ * --------------------------------------------------------------
+ *
+ * Copyright (C) 2024 Brisk Developers
+ *
+ * This file is part of the Brisk library.
+ *
+ * Brisk is dual-licensed under the GNU General Public License, version 2 (GPL-2.0+),
+ * and a commercial license. You may use, modify, and distribute this software under
+ * the terms of the GPL-2.0+ license if you comply with its conditions.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * If you do not wish to be bound by the GPL-2.0+ license, you must purchase a commercial
+ * license. For commercial licensing options, please visit: https://brisklib.com
+ */
+#pragma once
+
 #include "../window/Catch2Utils.hpp"
+#include <brisk/gui/GUI.hpp>
+#include <brisk/graphics/Canvas.hpp>
+
+namespace Brisk {
+
+// Discards rendering commands so that a widget tree can be updated without a GPU
+struct NullRenderContext final : public RenderContext {
+    void command(RenderStateEx&& cmd, std::span<const float> data) final {}
+
+    int numBatches() const final {
+        return 0;
+    }
+};
+
+// Widget tree with its own input queue, updated one frame at a time
+struct HeadlessTree {
+    NullRenderContext context;
+    Canvas canvas{ context };
+    InputQueue queue;
+    InputQueueScope scope{ &queue };
+    WidgetTree tree;
+
+    HeadlessTree(Widget::Ptr root, Size size) {
+        registerBuiltinFonts();
+        tree.viewportRectangle = Rectangle{ Point{ 0, 0 }, size };
+        tree.setRoot(std::move(root));
+    }
+
+    void frame() {
+        tree.updateAndPaint(canvas);
+    }
+};
+
+} // namespace Brisk
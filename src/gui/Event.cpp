@@ -52,13 +52,33 @@ const char* const eventTypeNames[+EventType::Count] = {
 };
 
 void Event::reinject() {
-    inputQueue->injectEvent(*this);
+    // Events are queued in window coordinates
+    Event event = *this;
+    event.translate(inputQueue->eventOffset);
+    inputQueue->injectEvent(std::move(event));
 }
 
 void Event::passThrough() {
     inputQueue->passThroughFlag = true;
 }
 
+void Event::translate(PointF offset) {
+    std::visit(
+        [offset](auto& val) BRISK_INLINE_LAMBDA {
+            using T = std::decay_t<decltype(val)>;
+            if constexpr (std::is_base_of_v<EventMouse, T> || std::is_base_of_v<EventDragNDrop, T>) {
+                val.point += offset;
+                if (val.downPoint)
+                    *val.downPoint += offset;
+            }
+            if constexpr (std::is_base_of_v<EventMouseMoved, T>) {
+                for (PointF& p : val.history)
+                    p += offset;
+            }
+        },
+        static_cast<EventVariant&>(*this));
+}
+
 template <typename T>
 optional<T> Event::as() const {
     optional<T> result;
@@ -100,7 +120,8 @@ template optional<EventKey> Event::as<EventKey>() const;
 template optional<EventTargeted> Event::as<EventTargeted>() const;
 
 void HitTestMap::clear() {
-    list.clear();
+    m_list.clear();
+    m_built    = false;
     state      = {};
     tabGroupId = 0;
 }
@@ -108,20 +129,127 @@ void HitTestMap::clear() {
 void HitTestMap::add(std::shared_ptr<Widget> w, Rectangle rect, bool anywhere) {
     if (rect.empty() || !state.visible || state.mouseTransparent)
         return;
-    auto it = std::lower_bound(list.begin(), list.end(), state.zindex,
-                               [](const HTEntry& e, int zindex) BRISK_INLINE_LAMBDA {
-                                   return e.zindex < zindex;
-                               });
-    list.insert(it, HTEntry{ w, state.zindex, rect, anywhere });
+    m_list.push_back(HTEntry{ std::move(w), state.zindex, rect, anywhere });
+    m_built = false;
 }
 
-std::shared_ptr<Widget> HitTestMap::get(float x, float y, bool respect_anywhere) const {
-    for (const HTEntry& e : list) {
-        if (e.rect.contains(Point(x, y)) || (respect_anywhere && e.anywhere)) {
-            return e.widget.lock();
+constexpr static int maxGridSize = 128;
+
+void HitTestMap::build() const {
+    if (m_built)
+        return;
+    m_built = true;
+
+    // Widgets are added parents first; later entries with the same z-index take precedence
+    std::reverse(m_list.begin(), m_list.end());
+    std::stable_sort(m_list.begin(), m_list.end(),
+                     [](const HTEntry& x, const HTEntry& y) BRISK_INLINE_LAMBDA {
+                         return x.zindex < y.zindex;
+                     });
+
+    m_order.clear();
+    m_anywhere.clear();
+    m_cellStart.clear();
+    m_cellItems.clear();
+    m_gridSize = { 0, 0 };
+    if (m_list.empty())
+        return;
+
+    m_bounds = m_list.front().rect;
+    for (uint32_t i = 0; i < m_list.size(); ++i) {
+        const HTEntry& e = m_list[i];
+        m_bounds         = m_bounds.union_(e.rect);
+        if (e.anywhere)
+            m_anywhere.push_back(i);
+        if (Widget::Ptr w = e.widget.lock())
+            m_order.emplace(w.get(), i);
+    }
+
+    // Roughly one entry per cell
+    const int grid =
+        std::clamp(static_cast<int>(std::sqrt(static_cast<double>(m_list.size()))), 1, maxGridSize);
+    m_cellSize = { std::max(1, (m_bounds.width() + grid - 1) / grid),
+                   std::max(1, (m_bounds.height() + grid - 1) / grid) };
+    m_gridSize = { (m_bounds.width() + m_cellSize.width - 1) / m_cellSize.width,
+                   (m_bounds.height() + m_cellSize.height - 1) / m_cellSize.height };
+
+    auto forEachCell = [&](Rectangle rect, auto&& fn) BRISK_INLINE_LAMBDA {
+        const int cx1 = (rect.x1 - m_bounds.x1) / m_cellSize.width;
+        const int cy1 = (rect.y1 - m_bounds.y1) / m_cellSize.height;
+        const int cx2 = (rect.x2 - 1 - m_bounds.x1) / m_cellSize.width;
+        const int cy2 = (rect.y2 - 1 - m_bounds.y1) / m_cellSize.height;
+        for (int cy = cy1; cy <= cy2; ++cy)
+            for (int cx = cx1; cx <= cx2; ++cx)
+                fn(cy * m_gridSize.width + cx);
+    };
+
+    // Counting pass, then fill; entries land in each cell in ascending index order
+    m_cellStart.assign(m_gridSize.area() + 1, 0);
+    for (const HTEntry& e : m_list) {
+        forEachCell(e.rect, [&](int cell) BRISK_INLINE_LAMBDA {
+            ++m_cellStart[cell + 1];
+        });
+    }
+    for (size_t c = 1; c < m_cellStart.size(); ++c) {
+        m_cellStart[c] += m_cellStart[c - 1];
+    }
+    m_cellItems.resize(m_cellStart.back());
+    std::vector<uint32_t> fill(m_cellStart.begin(), m_cellStart.end() - 1);
+    for (uint32_t i = 0; i < m_list.size(); ++i) {
+        forEachCell(m_list[i].rect, [&](int cell) BRISK_INLINE_LAMBDA {
+            m_cellItems[fill[cell]++] = i;
+        });
+    }
+}
+
+const std::vector<HitTestMap::HTEntry>& HitTestMap::entries() const {
+    build();
+    return m_list;
+}
+
+int HitTestMap::indexAt(Point pt, int offset, bool respect_anywhere) const {
+    build();
+    offset    = std::max(0, offset);
+    int found = -1;
+    // Returns the first index in the ascending list that is at least offset and satisfies the predicate
+    auto scan = [&](const uint32_t* first, const uint32_t* last, auto&& accepts) BRISK_INLINE_LAMBDA {
+        for (const uint32_t* it = std::lower_bound(first, last, static_cast<uint32_t>(offset)); it != last;
+             ++it) {
+            if (found >= 0 && *it >= static_cast<uint32_t>(found))
+                return;
+            if (accepts(m_list[*it]) && !m_list[*it].widget.expired()) {
+                found = *it;
+                return;
+            }
         }
+    };
+    if (m_bounds.contains(pt) && m_gridSize.area() > 0) {
+        const int cell = ((pt.y - m_bounds.y1) / m_cellSize.height) * m_gridSize.width +
+                         (pt.x - m_bounds.x1) / m_cellSize.width;
+        scan(m_cellItems.data() + m_cellStart[cell], m_cellItems.data() + m_cellStart[cell + 1],
+             [pt](const HTEntry& e) BRISK_INLINE_LAMBDA {
+                 return e.rect.contains(pt);
+             });
+    }
+    if (respect_anywhere) {
+        scan(m_anywhere.data(), m_anywhere.data() + m_anywhere.size(),
+             [](const HTEntry&) BRISK_INLINE_LAMBDA {
+                 return true;
+             });
     }
-    return nullptr;
+    return found;
+}
+
+optional<size_t> HitTestMap::indexOf(const Widget* widget) const {
+    build();
+    if (auto it = m_order.find(widget); it != m_order.end())
+        return it->second;
+    return nullopt;
+}
+
+std::shared_ptr<Widget> HitTestMap::get(float x, float y, bool respect_anywhere) const {
+    int index = indexAt(Point(x, y), 0, respect_anywhere);
+    return index >= 0 ? m_list[index].widget.lock() : nullptr;
 }
 
 void InputQueue::reset() {
@@ -183,7 +311,41 @@ void InputQueue::beginDrag(std::shared_ptr<Widget> dragSource, std::shared_ptr<O
     this->draggingOnSource = true;
 }
 
+template <typename T>
+static bool coalesceWheel(std::deque<Event>& events, const T& wheel) {
+    for (auto it = events.rbegin(); it != events.rend(); ++it) {
+        if (T* prev = std::get_if<T>(&*it)) {
+            if (prev->mods != wheel.mods || prev->downPoint != wheel.downPoint)
+                return false;
+            prev->delta += wheel.delta;
+            prev->point = wheel.point;
+            return true;
+        }
+        // Horizontal and vertical wheel events often arrive interleaved
+        if (it->type() != EventType::MouseXWheel && it->type() != EventType::MouseYWheel)
+            return false;
+    }
+    return false;
+}
+
 void InputQueue::addEvent(Event event) {
+    if (coalesceMouseEvents && !events.empty()) {
+        if (EventMouseMoved* move = std::get_if<EventMouseMoved>(&event)) {
+            if (EventMouseMoved* prev = std::get_if<EventMouseMoved>(&events.back());
+                prev && prev->mods == move->mods && prev->downPoint == move->downPoint) {
+                move->history = std::move(prev->history);
+                move->history.push_back(prev->point);
+                events.back() = std::move(event);
+                return;
+            }
+        } else if (auto* wheel = std::get_if<EventMouseYWheel>(&event)) {
+            if (coalesceWheel(events, *wheel))
+                return;
+        } else if (auto* wheel = std::get_if<EventMouseXWheel>(&event)) {
+            if (coalesceWheel(events, *wheel))
+                return;
+        }
+    }
     events.push_back(std::move(event));
 }
 
@@ -309,7 +471,8 @@ void InputQueue::processKeyEvent(Event e) {
 
 optional<std::string> InputQueue::getDescriptionAtMouse() const {
     return getAtMouse<std::string>([](Widget* w) BRISK_INLINE_LAMBDA {
-        return !w->m_description.empty() ? optional<std::string>(w->m_description) : nullopt;
+        const std::string& description = w->cold().description;
+        return !description.empty() ? optional<std::string>(description) : nullopt;
     });
 }
 
@@ -327,10 +490,8 @@ std::tuple<std::shared_ptr<Widget>, int> InputQueue::getAt(Point pt, int offset,
                                                            bool respect_anywhere) const {
     if (offset < 0 && !capturingMouse.empty())
         return std::tuple<std::shared_ptr<Widget>, int>{ capturingMouse.back().lock(), 0 };
-    for (int i = std::max(0, offset); i < hitTest.list.size(); i++) {
-        if (Widget::Ptr w = hitTest.list[i].widget.lock();
-            w && (hitTest.list[i].rect.contains(pt) || (respect_anywhere && hitTest.list[i].anywhere)))
-            return std::tuple<std::shared_ptr<Widget>, int>{ w, i + 1 };
+    if (int index = hitTest.indexAt(pt, offset, respect_anywhere); index >= 0) {
+        return std::tuple<std::shared_ptr<Widget>, int>{ hitTest.entries()[index].widget.lock(), index + 1 };
     }
     return std::tuple<std::shared_ptr<Widget>, int>{ nullptr, INT_MAX };
 }
@@ -428,7 +589,7 @@ void InputQueue::processDragEvent(Event e) {
         dropAllowed = false;
     }
 
-    draggingOnSource = source->rect().contains(base->point);
+    draggingOnSource = source->windowRect().contains(base->point);
 }
 
 void InputQueue::processMouseEvent(Event e) {
@@ -563,53 +724,66 @@ void InputQueue::processEvents() {
 }
 
 void InputQueue::processMouseState(const std::shared_ptr<Widget>& target) {
+    // Only the target, its parents and the widgets hovered so far can change state. They are
+    // processed in hit-test order: all parents are sorted after their children, so hover events
+    // are processed in child-parent order, which is the correct behavior.
+    std::set<Widget*> parents;
     if (target) {
-        std::set<Widget*> parents;
         target->bubble([&](Widget* w) BRISK_INLINE_LAMBDA -> bool {
             parents.insert(w);
             return true;
         });
-
-        for (const HitTestMap::HTEntry& entry : hitTest.list) {
-            // All parents are sorted after their children,
-            // so hover events are processed in child-parent order,
-            // which is the correct behavior.
-
-            if (Widget::Ptr ww = entry.widget.lock()) {
-                if (parents.find(ww.get()) != parents.end()) {
-                    // Widget is hovered
-                    if (!(ww->m_state && WidgetState::Hover)) {
-                        ww->toggleState(WidgetState::Hover, true);
-                        EventMouseEntered e;
-                        static_cast<EventMouse&>(e) = *lastMouseEvent;
-                        ww->processTemporaryEvent(Event(e));
-                    }
-                } else {
-                    if ((ww->m_state && WidgetState::Hover)) {
-                        ww->toggleState(WidgetState::Hover, false);
-                        EventMouseExited e;
-                        static_cast<EventMouse&>(e) = *lastMouseEvent;
-                        ww->processTemporaryEvent(Event(e));
-                    }
-                }
+    }
+    std::vector<std::pair<size_t, Widget::Ptr>> affected;
+    std::vector<std::weak_ptr<Widget>> stillHovered;
+    auto collect = [&](Widget* w) BRISK_INLINE_LAMBDA {
+        if (optional<size_t> index = hitTest.indexOf(w)) {
+            if (Widget::Ptr ww = hitTest.entries()[*index].widget.lock())
+                affected.emplace_back(*index, std::move(ww));
+        }
+    };
+    for (Widget* w : parents) {
+        collect(w);
+    }
+    for (const std::weak_ptr<Widget>& weak : hovered) {
+        if (Widget::Ptr ww = weak.lock()) {
+            if (!hitTest.indexOf(ww.get())) {
+                // Not hit-testable in this frame; keeps its state as before
+                stillHovered.push_back(weak);
+            } else if (parents.find(ww.get()) == parents.end()) {
+                collect(ww.get());
             }
         }
-    } else {
-        for (const HitTestMap::HTEntry& entry : hitTest.list) {
-            // All parents are sorted after their children,
-            // so hover events are processed in child-parent order,
-            // which is the correct behavior.
-
-            if (Widget::Ptr ww = entry.widget.lock()) {
-                if ((ww->m_state && WidgetState::Hover)) {
-                    ww->toggleState(WidgetState::Hover, false);
-                    EventMouseExited e;
-                    static_cast<EventMouse&>(e) = *lastMouseEvent;
-                    ww->processTemporaryEvent(Event(e));
-                }
+    }
+    std::sort(affected.begin(), affected.end(), [](const auto& x, const auto& y) BRISK_INLINE_LAMBDA {
+        return x.first < y.first;
+    });
+    affected.erase(std::unique(affected.begin(), affected.end(),
+                               [](const auto& x, const auto& y) BRISK_INLINE_LAMBDA {
+                                   return x.first == y.first;
+                               }),
+                   affected.end());
+
+    for (const auto& [index, ww] : affected) {
+        if (parents.find(ww.get()) != parents.end()) {
+            // Widget is hovered
+            stillHovered.push_back(ww);
+            if (!(ww->m_state && WidgetState::Hover)) {
+                ww->toggleState(WidgetState::Hover, true);
+                EventMouseEntered e;
+                static_cast<EventMouse&>(e) = *lastMouseEvent;
+                ww->processTemporaryEvent(Event(e));
+            }
+        } else {
+            if ((ww->m_state && WidgetState::Hover)) {
+                ww->toggleState(WidgetState::Hover, false);
+                EventMouseExited e;
+                static_cast<EventMouse&>(e) = *lastMouseEvent;
+                ww->processTemporaryEvent(Event(e));
             }
         }
     }
+    hovered = std::move(stillHovered);
 }
 
 void InputQueue::mouseLeave() {
@@ -619,7 +793,7 @@ void InputQueue::mouseLeave() {
 optional<PointF> InputQueue::mousePosFor(Widget* widget) const {
     if (!lastMouseEvent)
         return nullopt;
-    if (!widget->rect().contains(lastMouseEvent->point))
+    if (!widget->windowRect().contains(lastMouseEvent->point))
         return nullopt;
     return lastMouseEvent->point;
 }
@@ -627,7 +801,7 @@ optional<PointF> InputQueue::mousePosFor(Widget* widget) const {
 optional<PointF> InputQueue::mousePosForClient(Widget* widget) const {
     if (!lastMouseEvent)
         return nullopt;
-    Rectangle client = widget->clientRect();
+    Rectangle client = widget->clientRect().withOffset(widget->windowOffset());
     if (!client.contains(lastMouseEvent->point))
         return nullopt;
     return lastMouseEvent->point - PointF(client.p1);
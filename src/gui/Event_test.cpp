@@ -0,0 +1,211 @@
+/*
+ * Brisk
+ *
+ * Cross-platform application framework
+ * --------------------------------------------------------------
+ *
+ * Copyright (C) 2024 Brisk Developers
+ *
+ * This file is part of the Brisk library.
+ *
+ * Brisk is dual-licensed under the GNU General Public License, version 2 (GPL-2.0+),
+ * and a commercial license. You may use, modify, and distribute this software under
+ * the terms of the GPL-2.0+ license if you comply with its conditions.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * If you do not wish to be bound by the GPL-2.0+ license, you must purchase a commercial
+ * license. For commercial licensing options, please visit: https://brisklib.com
+ */
+#include <catch2/catch_all.hpp>
+#include "Catch2Utils.hpp"
+#include <brisk/gui/Event.hpp>
+#include <brisk/gui/GUI.hpp>
+#include <random>
+
+namespace Brisk {
+
+namespace {
+// Straightforward map kept sorted on insertion and scanned linearly
+struct ReferenceMap {
+    std::vector<HitTestMap::HTEntry> list;
+
+    void add(std::shared_ptr<Widget> w, int zindex, Rectangle rect, bool anywhere) {
+        if (rect.empty())
+            return;
+        auto it = std::lower_bound(list.begin(), list.end(), zindex,
+                                   [](const HitTestMap::HTEntry& e, int zindex) {
+                                       return e.zindex < zindex;
+                                   });
+        list.insert(it, HitTestMap::HTEntry{ std::move(w), zindex, rect, anywhere });
+    }
+
+    int indexAt(Point pt, int offset, bool respect_anywhere) const {
+        for (int i = std::max(0, offset); i < list.size(); i++) {
+            if (!list[i].widget.expired() &&
+                (list[i].rect.contains(pt) || (respect_anywhere && list[i].anywhere)))
+                return i;
+        }
+        return -1;
+    }
+};
+} // namespace
+
+TEST_CASE("HitTestMap matches linear scan") {
+    std::mt19937 rng(12345);
+    auto random = [&](int lo, int hi) {
+        return std::uniform_int_distribution<int>(lo, hi)(rng);
+    };
+    Widget::Ptr live = rcnew Widget{};
+    std::weak_ptr<Widget> dead;
+    {
+        Widget::Ptr temp = rcnew Widget{};
+        dead             = temp;
+    }
+
+    for (int n : { 0, 1, 7, 100, 2000 }) {
+        HitTestMap map;
+        ReferenceMap ref;
+        for (int i = 0; i < n; ++i) {
+            Rectangle rect;
+            if (random(0, 9) == 0) {
+                rect = Rectangle{ 0, 0, random(0, 1), random(0, 1) };
+            } else {
+                Point p = { random(-200, 1000), random(-200, 800) };
+                rect    = Rectangle{ p, Size{ random(1, 300), random(1, 300) } };
+            }
+            const int zindex    = random(-2, 2);
+            const bool anywhere = random(0, 49) == 0;
+            Widget::Ptr w       = random(0, 19) == 0 ? dead.lock() : live;
+            map.state.zindex    = zindex;
+            map.add(w, rect, anywhere);
+            ref.add(w, zindex, rect, anywhere);
+        }
+        map.build();
+        REQUIRE(map.entries().size() == ref.list.size());
+        for (size_t i = 0; i < ref.list.size(); ++i) {
+            CHECK(map.entries()[i].rect == ref.list[i].rect);
+            CHECK(map.entries()[i].zindex == ref.list[i].zindex);
+        }
+
+        for (int q = 0; q < 2000; ++q) {
+            Point pt              = { random(-300, 1400), random(-300, 1200) };
+            bool respect_anywhere = random(0, 1);
+            // Follow the pass-through chain the way event dispatch does
+            int offset = 0;
+            for (;;) {
+                int index = map.indexAt(pt, offset, respect_anywhere);
+                REQUIRE(index == ref.indexAt(pt, offset, respect_anywhere));
+                if (index < 0)
+                    break;
+                offset = index + 1;
+            }
+        }
+    }
+}
+
+TEST_CASE("HitTestMap priority") {
+    Widget::Ptr parent = rcnew Widget{};
+    Widget::Ptr child  = rcnew Widget{};
+    Widget::Ptr popup  = rcnew Widget{};
+    HitTestMap map;
+    map.add(parent, Rectangle{ 0, 0, 100, 100 }, false);
+    map.add(child, Rectangle{ 10, 10, 50, 50 }, false);
+    // The tree lowers the z-index of popups, and lower z-indices take precedence
+    map.state.zindex = -1;
+    map.add(popup, Rectangle{ 40, 40, 80, 80 }, true);
+    map.state.zindex = 0;
+
+    CHECK(map.get(20, 20, false) == child);
+    CHECK(map.get(45, 45, false) == popup);
+    CHECK(map.get(90, 90, false) == parent);
+    CHECK(map.get(200, 200, false) == nullptr);
+    CHECK(map.get(200, 200, true) == popup);
+    CHECK(map.indexOf(parent.get()).value_or(SIZE_MAX) == 2);
+    CHECK(map.indexOf(child.get()).value_or(SIZE_MAX) == 1);
+    CHECK(map.indexOf(popup.get()).value_or(SIZE_MAX) == 0);
+}
+
+TEST_CASE("InputQueue coalesces mouse events") {
+    InputQueue queue;
+    auto move = [&](PointF point, KeyModifiers mods = KeyModifiers::None) {
+        queue.addEvent(EventMouseMoved{ { { {}, mods }, point, nullopt } });
+    };
+    auto wheel = [&](float x, float y) {
+        if (y)
+            queue.addEvent(EventMouseYWheel{ { { {}, KeyModifiers::None }, PointF{ 5, 5 }, nullopt }, y });
+        if (x)
+            queue.addEvent(EventMouseXWheel{ { { {}, KeyModifiers::None }, PointF{ 5, 5 }, nullopt }, x });
+    };
+
+    for (int i = 0; i < 100; ++i) {
+        move(PointF(i, i));
+    }
+    queue.addEvent(EventMouseButtonPressed{
+        { { { {}, KeyModifiers::None }, PointF{ 99, 99 }, nullopt }, MouseButton::Left } });
+    move(PointF(100, 100));
+    move(PointF(101, 101));
+    move(PointF(102, 102), KeyModifiers::Shift);
+    for (int i = 0; i < 10; ++i) {
+        wheel(1.f, 0.5f);
+    }
+    move(PointF(103, 103));
+
+    REQUIRE(queue.events.size() == 7);
+    CHECK(queue.events[0].type() == EventType::MouseMoved);
+    optional<EventMouseMoved> first = queue.events[0].as<EventMouseMoved>();
+    CHECK(first->point == PointF(99, 99));
+    REQUIRE(first->history.size() == 99);
+    CHECK(first->history.front() == PointF(0, 0));
+    CHECK(first->history.back() == PointF(98, 98));
+
+    // Button transitions split runs of moves
+    CHECK(queue.events[1].type() == EventType::MouseButtonPressed);
+    CHECK(queue.events[2].as<EventMouseMoved>()->point == PointF(101, 101));
+    CHECK(queue.events[2].as<EventMouseMoved>()->history.size() == 1);
+
+    // So do modifier changes
+    CHECK(queue.events[3].as<EventMouseMoved>()->mods == KeyModifiers::Shift);
+    CHECK(queue.events[3].as<EventMouseMoved>()->history.empty());
+
+    // Interleaved wheel events accumulate per orientation
+    CHECK(queue.events[4].as<EventMouseYWheel>()->delta == 5.f);
+    CHECK(queue.events[5].as<EventMouseXWheel>()->delta == 10.f);
+    CHECK(queue.events[6].as<EventMouseMoved>()->history.empty());
+
+    queue.events.clear();
+    queue.coalesceMouseEvents = false;
+    for (int i = 0; i < 10; ++i) {
+        move(PointF(i, i));
+    }
+    CHECK(queue.events.size() == 10);
+}
+
+TEST_CASE("HitTestMap benchmark", "[.benchmark]") {
+    std::mt19937 rng(1);
+    auto random = [&](int lo, int hi) {
+        return std::uniform_int_distribution<int>(lo, hi)(rng);
+    };
+    Widget::Ptr live = rcnew Widget{};
+    std::vector<std::pair<Rectangle, int>> rects;
+    for (int i = 0; i < 50'000; ++i) {
+        Point p = { random(0, 3800), random(0, 2100) };
+        rects.emplace_back(Rectangle{ p, Size{ random(4, 40), random(4, 40) } }, random(0, 100) == 0);
+    }
+    HitTestMap map;
+    BENCHMARK("Build 50k") {
+        map.clear();
+        for (const auto& [rect, zindex] : rects) {
+            map.state.zindex = zindex;
+            map.add(live, rect, false);
+        }
+        map.build();
+    };
+    int x = 0;
+    BENCHMARK("Query 50k") {
+        x = (x + 37) % 3840;
+        return map.indexAt(Point{ x, (x * 7) % 2160 }, 0, true);
+    };
+}
+} // namespace Brisk
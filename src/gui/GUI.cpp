@@ -30,6 +30,7 @@
 #include <yoga/algorithm/CalculateLayout.h>
 #include <yoga/algorithm/BoundAxis.h>
 #include <brisk/gui/WidgetTree.hpp>
+#include <brisk/graphics/Renderer.hpp>
 
 #include <resources/Lucide.hpp>
 #include <resources/Lato-Black.hpp>
@@ -48,7 +49,7 @@ namespace yoga = facebook::yoga;
 
 namespace Internal {
 
-class LayoutEngine final : public yoga::Node, public yoga::Style {
+class LayoutEngine final : public yoga::Node, public yoga::Style, public ArenaAllocation {
 public:
     friend class Brisk::Widget;
 
@@ -57,6 +58,7 @@ public:
     LayoutEngine(Widget* widget) noexcept : m_widget(widget) {}
 
     yoga::LayoutResults m_layoutResults{};
+    RectangleF m_layoutRectangle{ 0, 0, 0, 0 }; // Rectangle passed to the last applyLayoutRecursively
     int16_t m_layoutLineIndex = 0;
     bool m_hasNewLayout : 1   = false;
     bool m_layoutDirty : 1    = false;
@@ -575,19 +577,24 @@ static bool fontsRegistered                   = false;
 void registerBuiltinFonts() {
     if (fontsRegistered)
         return;
-    fonts->addFont(internalLato, FontStyle::Normal, FontWeight::Regular, Lato_Medium(), false);
-    fonts->addFont(internalLato, FontStyle::Normal, FontWeight::Light, Lato_Light(), false);
-    fonts->addFont(internalLato, FontStyle::Normal, FontWeight::Bold, Lato_Black(), false);
+    registerBuiltinFonts(*fonts);
+    fontsRegistered = true;
+}
+
+void registerBuiltinFonts(FontManager& manager) {
+    // Resources are decompressed on the first call of their accessor, which is deferred to the first use
+    manager.addFont(internalLato, FontStyle::Normal, FontWeight::Regular, &Lato_Medium);
+    manager.addFont(internalLato, FontStyle::Normal, FontWeight::Light, &Lato_Light);
+    manager.addFont(internalLato, FontStyle::Normal, FontWeight::Bold, &Lato_Black);
 #ifdef BRISK_RESOURCE_GoNotoCurrent_Regular
-    fonts->addFont(internalGoNoto, FontStyle::Normal, FontWeight::Regular, GoNotoCurrent_Regular(), false);
+    manager.addFont(internalGoNoto, FontStyle::Normal, FontWeight::Regular, &GoNotoCurrent_Regular);
 #endif
-    fonts->addFont(internalLucide, FontStyle::Normal, FontWeight::Regular, Lucide(), false);
-    fonts->addFont(internalMonospace, FontStyle::Normal, FontWeight::Regular, SourceCodePro_Medium(), false);
+    manager.addFont(internalLucide, FontStyle::Normal, FontWeight::Regular, &Lucide);
+    manager.addFont(internalMonospace, FontStyle::Normal, FontWeight::Regular, &SourceCodePro_Medium);
 
-    fonts->addMergedFont(Lato, { internalLato, internalGoNoto, internalLucide });
-    fonts->addMergedFont(GoNoto, { internalGoNoto, internalLucide });
-    fonts->addMergedFont(Monospace, { internalMonospace, internalGoNoto, internalLucide });
-    fontsRegistered = true;
+    manager.addMergedFont(Lato, { internalLato, internalGoNoto, internalLucide });
+    manager.addMergedFont(GoNoto, { internalGoNoto, internalLucide });
+    manager.addMergedFont(Monospace, { internalMonospace, internalGoNoto, internalLucide });
 }
 
 Builder::Builder(Builder::PushFunc builder, BuilderKind kind) : builder(std::move(builder)), kind(kind) {}
@@ -619,7 +626,7 @@ Widget::~Widget() noexcept {
         w->parentChanged();
     }
 
-    for (WidgetGroup* g : m_groups) {
+    for (WidgetGroup* g : cold().groups) {
         std::erase(g->widgets, this);
     }
 
@@ -627,7 +634,8 @@ Widget::~Widget() noexcept {
 }
 
 void Widget::removeFromGroup(WidgetGroup* group) {
-    m_groups.erase(group);
+    if (Internal::WidgetCold* cold = m_cold.get())
+        cold->groups.erase(group);
 }
 
 void Widget::resetSelection() {
@@ -724,87 +732,97 @@ Size Widget::viewportSize() const noexcept {
 }
 
 /// Returns the number of changes
-int32_t Widget::applyLayoutRecursively(RectangleF rectangle) {
-    int32_t counter                = 0;
+int32_t Widget::applyLayoutRecursively(RectangleF rectangle, bool force) {
+    int32_t counter = 0;
 
-    m_layoutEngine->m_hasNewLayout = false;
     if (!m_hasLayout) {
+        m_layoutEngine->m_hasNewLayout = false;
         counter += m_previouslyHasLayout != m_hasLayout ? 1 : 0;
         m_previouslyHasLayout = m_hasLayout;
         return counter;
     }
     m_previouslyHasLayout = m_hasLayout;
-    auto& layout          = m_layoutEngine->getLayout();
+    // Yoga flags every node it has laid out in this pass. A subtree that yoga has skipped and whose
+    // origin has not moved keeps its rectangles from the previous pass.
+    const bool moved = assign(m_layoutEngine->m_layoutRectangle, rectangle);
+    if (!force && !moved && !m_layoutEngine->m_hasNewLayout) {
+        return counter;
+    }
+    m_layoutEngine->m_hasNewLayout = false;
+    if (m_tree)
+        ++m_tree->m_layoutStats.visited;
+
+    auto& layout = m_layoutEngine->getLayout();
     RectangleF rect;
-    if (true || m_layoutEngine->m_hasNewLayout) {
-        SizeF dimensions{ layout.dimension(yoga::Dimension::Width),
-                          layout.dimension(yoga::Dimension::Height) };
-        PointF newOffset;
-        Size viewportSize = this->viewportSize();
-        ResolveParameters params{ resolveFontHeight(), viewportSize };
-        if (m_placement != Placement::Normal) {
-            RectangleF referenceRectangle =
-                m_placement == Placement::Window ? RectangleF{ PointF(0, 0), viewportSize } : rectangle;
-            PointF parent_anchor =
-                resolveValue(m_absolutePosition, PointF{}, PointF(SizeF(referenceRectangle.size())), params);
-            PointF self_anchor = resolveValue(m_anchor, PointF{}, PointF(dimensions), params);
-            newOffset          = referenceRectangle.p1 + parent_anchor - self_anchor;
+    SizeF dimensions{ layout.dimension(yoga::Dimension::Width), layout.dimension(yoga::Dimension::Height) };
+    PointF newOffset;
+    Size viewportSize = this->viewportSize();
+    ResolveParameters params{ resolveFontHeight(), viewportSize };
+    // Window placement and viewport alignment are in window coordinates, which scrolled content is
+    // offset from. The tree places such widgets again when an ancestor scrolls
+    PointF origin{ 0, 0 };
+    if (isPlacedInWindow()) {
+        origin = PointF(windowOffset());
+        if (m_tree)
+            m_tree->m_windowPlaced.insert(this);
+    }
+    if (m_placement != Placement::Normal) {
+        RectangleF referenceRectangle =
+            m_placement == Placement::Window ? RectangleF{ -origin, viewportSize } : rectangle;
+        PointF parent_anchor =
+            resolveValue(m_absolutePosition, PointF{}, PointF(SizeF(referenceRectangle.size())), params);
+        PointF self_anchor = resolveValue(m_anchor, PointF{}, PointF(dimensions), params);
+        newOffset          = referenceRectangle.p1 + parent_anchor - self_anchor;
 
-        } else {
-            newOffset = rectangle.p1 + PointF(layout.position(yoga::PhysicalEdge::Left),
-                                              layout.position(yoga::PhysicalEdge::Top));
-        }
-        PointF translate = resolveValue(m_translate, PointF(), PointF(dimensions), params);
-        newOffset += translate;
-
-        if (m_alignToViewport && AlignToViewport::X) {
-            if (newOffset.x < 0) {
-                newOffset.x = 0;
-            } else if (newOffset.x + dimensions.x > viewportSize.x) {
-                newOffset.x = viewportSize.x - dimensions.x;
-            }
-        }
-        if (m_alignToViewport && AlignToViewport::Y) {
-            if (newOffset.y < 0) {
-                newOffset.y = 0;
-            } else if (newOffset.y + dimensions.y > viewportSize.y) {
-                newOffset.y = viewportSize.y - dimensions.y;
-            }
-        }
+    } else {
+        newOffset = rectangle.p1 + PointF(layout.position(yoga::PhysicalEdge::Left),
+                                          layout.position(yoga::PhysicalEdge::Top));
+    }
+    PointF translate = resolveValue(m_translate, PointF(), PointF(dimensions), params);
+    newOffset += translate;
 
-        rect.x1 = newOffset.x;
-        rect.y1 = newOffset.y;
-        rect.x2 = rect.x1 + dimensions.x;
-        rect.y2 = rect.y1 + dimensions.y;
-        if (assign(m_rect, roundRect(rect))) {
-            ++counter;
+    if (m_alignToViewport && AlignToViewport::X) {
+        if (newOffset.x + origin.x < 0) {
+            newOffset.x = -origin.x;
+        } else if (newOffset.x + origin.x + dimensions.x > viewportSize.x) {
+            newOffset.x = viewportSize.x - dimensions.x - origin.x;
         }
-        if (assign(m_computedBorderWidth, m_layoutEngine->computedBorder())) {
-            ++counter;
-        }
-        if (assign(m_computedPadding, m_layoutEngine->computedPadding())) {
-            ++counter;
-        }
-        if (assign(m_computedMargin, m_layoutEngine->computedMargin())) {
-            ++counter;
-        }
-        if (assign(m_clientRect,
-                   roundRect(rect.withPadding(m_computedBorderWidth).withPadding(m_computedPadding)))) {
-            ++counter;
+    }
+    if (m_alignToViewport && AlignToViewport::Y) {
+        if (newOffset.y + origin.y < 0) {
+            newOffset.y = -origin.y;
+        } else if (newOffset.y + origin.y + dimensions.y > viewportSize.y) {
+            newOffset.y = viewportSize.y - dimensions.y - origin.y;
         }
-    } else {
-        rect = m_rect;
     }
+
+    rect.x1 = newOffset.x;
+    rect.y1 = newOffset.y;
+    rect.x2 = rect.x1 + dimensions.x;
+    rect.y2 = rect.y1 + dimensions.y;
+    if (assign(m_rect, roundRect(rect))) {
+        ++counter;
+        if (m_tree)
+            ++m_tree->m_layoutStats.changed;
+    }
+    if (assign(m_computedBorderWidth, m_layoutEngine->computedBorder())) {
+        ++counter;
+    }
+    if (assign(m_computedPadding, m_layoutEngine->computedPadding())) {
+        ++counter;
+    }
+    if (assign(m_computedMargin, m_layoutEngine->computedMargin())) {
+        ++counter;
+    }
+    if (assign(m_clientRect,
+               roundRect(rect.withPadding(m_computedBorderWidth).withPadding(m_computedPadding)))) {
+        ++counter;
+    }
+    // Children are laid out in unscrolled coordinates, so scrolling does not move them
     Point bottomRight{ 0, 0 };
-    RectangleF rectOffset = rect.withOffset(m_childrenOffset);
     for (const Ptr& w : *this) {
-        if (w->m_ignoreChildrenOffset) {
-            counter += w->applyLayoutRecursively(rect);
-            bottomRight = max(bottomRight, w->m_rect.p2);
-        } else {
-            counter += w->applyLayoutRecursively(rectOffset);
-            bottomRight = max(bottomRight, w->m_rect.p2 - m_childrenOffset);
-        }
+        counter += w->applyLayoutRecursively(rect, force);
+        bottomRight = max(bottomRight, w->m_rect.p2);
     }
     if (assign(m_contentSize, Size((bottomRight - Point(rect.p1)).v))) {
         ++counter;
@@ -813,45 +831,50 @@ int32_t Widget::applyLayoutRecursively(RectangleF rectangle) {
 }
 
 bool Widget::setChildrenOffset(Point offset) {
-    Point difference = offset - m_childrenOffset;
-    if (difference == Point(0, 0))
+    if (!assign(m_childrenOffset, offset))
         return false;
-    m_childrenOffset = offset;
-    for (const Ptr& w : *this) {
-        if (!w->m_ignoreChildrenOffset)
-            w->reposition(difference);
+    // Hit-test rectangles are in window coordinates
+    if (m_tree) {
+        m_tree->requestUpdateGeometry();
+        m_tree->requestWindowPlacement();
     }
     return true;
 }
 
-void Widget::reposition(Point relativeOffset) {
-    m_rect       = m_rect.withOffset(relativeOffset);
-    m_clientRect = m_clientRect.withOffset(relativeOffset);
-    for (const Ptr& w : *this) {
-        w->reposition(relativeOffset);
-    }
-    if (m_tree)
-        m_tree->requestUpdateGeometry();
+bool Widget::isPlacedInWindow() const noexcept {
+    return m_placement == Placement::Window || m_alignToViewport != AlignToViewport::None;
 }
 
-static void show_debug_border(RawCanvas& canvas, Rectangle rect, double elapsed, const ColorF& color);
+int32_t Widget::placeInWindow() {
+    // Reuses the rectangle the parent was laid out with
+    return applyLayoutRecursively(m_layoutEngine->m_layoutRectangle, true);
+}
 
-void Widget::refreshTree() {
-    traverse(
-        [](const Ptr& current) -> bool {
-            BRISK_ASSERT(!current->m_inConstruction);
-            return true;
-        },
-        [](const Ptr& current) {
-            current->onRefresh();
-        });
+Point Widget::offsetOf(const Widget& child) const noexcept {
+    return child.m_ignoreChildrenOffset ? Point{ 0, 0 } : m_childrenOffset;
+}
+
+Point Widget::windowOffset() const noexcept {
+    Point offset{ 0, 0 };
+    for (const Widget* w = this; w->m_parent; w = w->m_parent) {
+        offset += w->m_parent->offsetOf(*w);
+    }
+    return offset;
+}
+
+Rectangle Widget::windowRect() const noexcept {
+    return m_rect.withOffset(windowOffset());
 }
 
+static void show_debug_border(RawCanvas& canvas, Rectangle rect, double elapsed, const ColorF& color);
+
 void Widget::updateLayout(Rectangle rectangle) {
     // Called by widget tree for the root widget only
+    // Viewport-relative placement depends on the viewport, so a resize revisits the whole tree
+    const bool resized = RectangleF(rectangle) != m_layoutEngine->m_layoutRectangle;
     if (yoga::calculateLayout(m_layoutEngine.get(), rectangle.width(), rectangle.height(),
                               yoga::Direction::LTR)) {
-        if (applyLayoutRecursively(rectangle)) {
+        if (applyLayoutRecursively(rectangle, resized)) {
             if (m_tree) {
                 m_tree->onLayoutUpdated();
                 m_tree->requestUpdateGeometry();
@@ -936,30 +959,88 @@ void Widget::apply(WidgetGroup* group) {
     BRISK_ASSERT(group);
 
     group->widgets.push_back(this);
-    m_groups.insert(group);
+    writableCold().groups.insert(group);
 
     if (m_tree) {
         m_tree->addGroup(group);
     }
 }
 
-void Widget::rebuildOne(Builder builder) {
+namespace Internal {
+/// Keyed children of the builder that is running, available for reuse
+struct KeyedChildren {
+    Widget* target    = nullptr;
+    uint32_t position = 0;
+    std::unordered_map<std::string, Widget::Ptr, StringHash, std::equal_to<>> previous;
+    std::vector<Widget::KeyedChild> added;
+    bool reused = false;
+};
+
+static thread_local KeyedChildren* currentKeyed = nullptr;
+} // namespace Internal
+
+void Widget::rebuildOne(Builder builder, Internal::KeyedChildren* previous) {
     const size_t position     = m_widgets.size();
     const size_t builderCount = m_builders.size();
 
+    Internal::KeyedChildren keyed;
+    if (!previous)
+        previous = &keyed;
+    previous->target   = this;
+    previous->position = uint32_t(position);
+
     if (builder.kind != BuilderKind::Delayed) {
+        Internal::KeyedChildren* saved = std::exchange(Internal::currentKeyed, previous);
+        SCOPE_EXIT {
+            Internal::currentKeyed = saved;
+        };
         builder.run(this);
     }
     BRISK_ASSERT(builderCount == m_builders.size());
     const size_t count = m_widgets.size() - position;
     if (builder.kind != BuilderKind::Once) {
-        m_builders.push_back(BuilderData{ std::move(builder), uint32_t(position), uint32_t(count) });
+        m_builders.push_back(BuilderData{ std::move(builder), uint32_t(position), uint32_t(count),
+                                          std::move(previous->added) });
+    }
+    if (previous->reused) {
+        requestUpdateLayout();
     }
     if (count) {
         childrenAdded();
     }
 }
 
+Widget* Widget::reuseKeyed(std::string_view key) {
+    Internal::KeyedChildren* keyed = Internal::currentKeyed;
+    if (!keyed || keyed->target != this)
+        return nullptr;
+    auto it = keyed->previous.find(key);
+    if (it == keyed->previous.end())
+        return nullptr;
+    // Already a child of this widget, so it only needs to be put in place
+    Widget* widget = it->second.get();
+    keyed->added.push_back(KeyedChild{ uint32_t(m_widgets.size() - keyed->position), it->first });
+    m_widgets.push_back(std::move(it->second));
+    keyed->previous.erase(it);
+    keyed->reused = true;
+    return widget;
+}
+
+Widget* Widget::addKeyed(std::string_view key, Ptr widget) {
+    Widget* raw                    = widget.get();
+    const size_t index             = m_widgets.size();
+    Internal::KeyedChildren* keyed = Internal::currentKeyed;
+    apply(std::move(widget));
+    if (keyed && keyed->target == this && m_widgets.size() == index + 1 && m_widgets.back().get() == raw) {
+        keyed->added.push_back(KeyedChild{ uint32_t(index - keyed->position), std::string(key) });
+    }
+    return raw;
+}
+
+Widget* Widget::addKeyed(std::string_view key, Widget* widget) {
+    return addKeyed(key, Internal::rcNew * widget);
+}
+
 void Widget::apply(Builder builder) {
     rebuildOne(std::move(builder));
 }
@@ -972,6 +1053,8 @@ void Widget::doRebuild() {
 
 void Widget::rebuild(bool force) {
     if (!m_builders.empty()) {
+        MemoryArena::Scope scope =
+            m_tree ? m_tree->arenaScope() : MemoryArena::Scope(MemoryArena::current());
         WidgetPtrs widgetsCopy;
         std::vector<BuilderData> buildersCopy;
 
@@ -980,14 +1063,33 @@ void Widget::rebuild(bool force) {
         size_t copied = 0;
 
         for (BuilderData& g : buildersCopy) {
-            if (!(g.builder.kind == BuilderKind::Delayed || force))
-                continue;
             m_widgets.insert(m_widgets.end(), std::make_move_iterator(widgetsCopy.begin() + copied),
                              std::make_move_iterator(widgetsCopy.begin() + g.position));
+            copied = g.position + g.count;
+            if (!(g.builder.kind == BuilderKind::Delayed || force)) {
+                // keep the builder and the widgets it has built
+                const uint32_t position = uint32_t(m_widgets.size());
+                m_widgets.insert(m_widgets.end(), std::make_move_iterator(widgetsCopy.begin() + g.position),
+                                 std::make_move_iterator(widgetsCopy.begin() + copied));
+                g.position = position;
+                m_builders.push_back(std::move(g));
+                continue;
+            }
+            // Keyed children are taken out of widgetsCopy so that the builder can reuse them
+            Internal::KeyedChildren keyed;
+            for (KeyedChild& k : g.keyed) {
+                if (k.index >= g.count)
+                    continue;
+                Ptr& widget = widgetsCopy[g.position + k.index];
+                if (widget && keyed.previous.try_emplace(std::move(k.key), widget).second)
+                    widget = nullptr;
+            }
             // reapply & store new BuilderData
             g.builder.kind = BuilderKind::Regular;
-            rebuildOne(g.builder);
-            copied = g.position + g.count;
+            rebuildOne(g.builder, &keyed);
+            for (auto& [key, widget] : keyed.previous) {
+                childRemoved(std::move(widget));
+            }
         }
         if (copied < widgetsCopy.size()) {
             m_widgets.insert(m_widgets.end(), std::make_move_iterator(widgetsCopy.begin() + copied),
@@ -1016,8 +1118,10 @@ void Widget::paint(Canvas& canvas) const {
 
 Drawable Widget::drawable(RectangleF scissors) const {
     return [w = shared_from_this(), scissors](Canvas& canvas) {
-        auto&& state    = canvas.raw().save();
-        state->scissors = scissors;
+        const PointF offset(w->windowOffset());
+        auto&& state = canvas.raw().save();
+        state->offset += offset;
+        state->scissors = scissors.withOffset(-offset);
         w->doPaint(canvas);
     };
 }
@@ -1045,15 +1149,15 @@ void Widget::doPaint(Canvas& canvas) const {
         } else if (m_clip == WidgetClip::None) {
             state->scissors = noScissors;
         }
-        if (m_painter)
-            m_painter.paint(canvas, *this);
+        if (const Painter& painter = cold().painter)
+            painter.paint(canvas, *this);
         else
             paint(canvas);
         paintChildren(canvas);
         postPaint(canvas);
     } else {
-        if (m_painter)
-            m_painter.paint(canvas, *this);
+        if (const Painter& painter = cold().painter)
+            painter.paint(canvas, *this);
         else
             paint(canvas);
         paintChildren(canvas);
@@ -1085,9 +1189,10 @@ void Widget::paintFocusFrame(Canvas& canvas_) const {
         if (!m_tree)
             return;
         float val = dp(remap(t, -1.0f, +1.0f, 1.8f, 3.0f));
-        m_tree->requestLayer([val, this](Canvas& canvas) {
-            canvas.raw().drawShadow(RectangleF(m_rect).withMargin(val, val),
-                                    std::copysign(std::min(RectangleF(m_rect).shortestSide() * 0.5f,
+        // Layers are painted in window coordinates
+        m_tree->requestLayer([val, this, rect = RectangleF(windowRect())](Canvas& canvas) {
+            canvas.raw().drawShadow(rect.withMargin(val, val),
+                                    std::copysign(std::min(rect.shortestSide() * 0.5f,
                                                            val + std::abs(m_borderRadius.resolved.max())),
                                                   m_borderRadius.resolved.max()),
                                     0.f, contourSize = val, contourColor = 0x03a1fc_rgb);
@@ -1096,28 +1201,30 @@ void Widget::paintFocusFrame(Canvas& canvas_) const {
 }
 
 void Widget::paintHint(Canvas& canvas_) const {
-    std::string hint = m_hint;
-    if (hint.empty() && !m_description.empty() && m_hoverTime >= 0.0 && frameStartTime - m_hoverTime >= 0.6) {
-        hint = m_description;
-        if (!m_hintShown) {
-            m_hintShown = true;
+    const Internal::WidgetCold& cold = this->cold();
+    std::string hint                 = cold.hint;
+    if (hint.empty() && !cold.description.empty() && m_hoverTime >= 0.0 &&
+        frameStartTime - m_hoverTime >= 0.6) {
+        hint = cold.description;
+        if (!cold.hintShown) {
+            cold.hintShown = true;
             requestHint();
         }
     }
 
-    if ((m_isHintExclusive || isHintCurrent()) && !hint.empty() && m_tree) {
-        m_tree->requestLayer([hint, this](Canvas& canvas_) {
+    if ((cold.isHintExclusive || isHintCurrent()) && !hint.empty() && m_tree) {
+        m_tree->requestLayer([hint, this, rect = windowRect()](Canvas& canvas_) {
             RawCanvas& canvas  = canvas_.raw();
 
             Font font          = Font{ DefaultFont, dp(FontSize::Normal - 1) };
             Size textSize      = fonts->bounds(font, utf8ToUtf32(hint)).size();
-            Point p            = m_rect.at(0.5f, 1.f);
+            Point p            = rect.at(0.5f, 1.f);
             Rectangle hintRect = p.alignedRect(textSize + Size{ 12_idp, 6_idp }, { 0.5f, 0.f });
             if (m_tree && !m_tree->viewportRectangle.empty()) {
                 Rectangle boundingRect = m_tree->viewportRectangle;
 
                 if (hintRect.y2 > boundingRect.y2) {
-                    p        = m_rect.at(0.5f, 0.f);
+                    p        = rect.at(0.5f, 0.f);
                     hintRect = p.alignedRect(textSize + Size{ 12_idp, 6_idp }, { 0.5f, 1.f });
                 }
 
@@ -1171,19 +1278,85 @@ void Widget::paintChildren(Canvas& canvas) const {
         newScissors = RectangleF(m_rect).intersection(newScissors);
     }
     state->scissors = newScissors;
+    if (WorkerPool* pool = m_tree ? m_tree->paintPool() : nullptr; pool && !Internal::layerSink) {
+        if (paintChildrenParallel(canvas, *pool, newScissors))
+            return;
+    }
     for (const Widget::Ptr& w : *this) {
         if (!w->m_visible || w->m_hidden)
             continue;
         if (m_tree && w->m_zorder != ZOrder::Normal) {
             m_tree->requestLayer(w->drawable(noScissors));
         } else {
-            if (!RectangleF(w->m_rect).intersection(newScissors).empty()) {
-                w->doPaint(canvas);
+            if (!RectangleF(w->m_rect.withOffset(offsetOf(*w))).intersection(newScissors).empty()) {
+                paintChild(canvas, *w);
             }
         }
     }
 }
 
+// Scrolled children keep their own coordinates; the canvas offset moves them into place
+void Widget::paintChild(Canvas& canvas, const Widget& child) const {
+    const Point offset = offsetOf(child);
+    if (offset == Point{ 0, 0 }) {
+        child.doPaint(canvas);
+        return;
+    }
+    auto&& state = canvas.raw().save();
+    state->offset += PointF(offset);
+    state->scissors = state->scissors.withOffset(-PointF(offset));
+    child.doPaint(canvas);
+}
+
+// Records the subtrees of the children on the pool, then issues the recordings and the requested layers
+// in the order in which sequential painting would produce them
+bool Widget::paintChildrenParallel(Canvas& canvas, WorkerPool& pool, RectangleF scissors) const {
+    struct Subtree {
+        Widget* widget = nullptr; // nullptr if the child is painted as a separate layer
+        RecordingContext recording;
+        std::vector<Drawable> layers;
+    };
+
+    std::vector<Subtree> subtrees;
+    size_t recorded = 0;
+    for (const Widget::Ptr& w : *this) {
+        if (!w->m_visible || w->m_hidden)
+            continue;
+        if (w->m_zorder != ZOrder::Normal) {
+            subtrees.emplace_back().layers.push_back(w->drawable(noScissors));
+        } else if (!RectangleF(w->m_rect.withOffset(offsetOf(*w))).intersection(scissors).empty()) {
+            subtrees.emplace_back().widget = w.get();
+            ++recorded;
+        }
+    }
+    if (recorded < 2)
+        return false;
+
+    InputQueue* queue = inputQueue.get(nullptr);
+    pool.parallelFor(subtrees.size(), [&](size_t index) {
+        Subtree& subtree = subtrees[index];
+        if (!subtree.widget)
+            return;
+        std::optional<InputQueueScope> queueScope;
+        if (inputQueue.get(nullptr) != queue)
+            queueScope.emplace(queue);
+        std::vector<Drawable>* savedSink = std::exchange(Internal::layerSink, &subtree.layers);
+        SCOPE_EXIT {
+            Internal::layerSink = savedSink;
+        };
+        Canvas recordingCanvas(subtree.recording, canvas);
+        paintChild(recordingCanvas, *subtree.widget);
+    });
+
+    for (Subtree& subtree : subtrees) {
+        subtree.recording.replay(canvas.raw().context());
+        for (Drawable& layer : subtree.layers) {
+            m_tree->requestLayer(std::move(layer));
+        }
+    }
+    return true;
+}
+
 void Widget::processTemporaryEvent(Event event) {
     return processEvent(event);
 }
@@ -1195,16 +1368,18 @@ void Widget::processEvent(Event& event) {
     if (event.type() == EventType::MouseExited) {
         m_mousePos  = nullopt;
         m_hoverTime = -1.0;
-        m_hintShown = false;
+        if (m_cold)
+            m_cold.get()->hintShown = false;
     } else if (event.type() == EventType::MouseEntered) {
         auto mouse = event.as<EventMouse>();
-        m_mousePos = mouse->point;
+        m_mousePos = mouse->point - PointF(windowOffset());
         if (m_hoverTime < 0.0) {
             m_hoverTime = frameStartTime;
-            m_hintShown = false;
+            if (m_cold)
+                m_cold.get()->hintShown = false;
         }
     } else if (auto mouse = event.as<EventMouse>()) {
-        m_mousePos = mouse->point;
+        m_mousePos = mouse->point - PointF(windowOffset());
     }
 
     if (auto focus = event.as<EventFocused>()) {
@@ -1221,7 +1396,7 @@ void Widget::processEvent(Event& event) {
         bubbleEvent(event, pressed ? WidgetState::Pressed : WidgetState::None,
                     released ? WidgetState::Pressed : WidgetState::None, false);
     } else {
-        this->onEvent(event);
+        deliverEvent(event);
     }
     if (m_autoMouseCapture) {
         if (pressed) {
@@ -1234,12 +1409,12 @@ void Widget::processEvent(Event& event) {
 
 void Widget::onEvent(Event& event) {
     if (event.doubleClicked()) {
-        if (m_onDoubleClick.trigger() > 0) {
+        if (m_cold && m_cold.get()->onDoubleClick.trigger() > 0) {
             event.stopPropagation();
         }
     }
     if (m_processClicks && event.pressed()) {
-        if (m_onClick.trigger() > 0) {
+        if (m_cold && m_cold.get()->onClick.trigger() > 0) {
             event.stopPropagation();
         }
     }
@@ -1255,17 +1430,33 @@ void Widget::onEvent(Event& event) {
         }
     }
 
-    if (m_delegate) {
-        m_delegate->delegatedEvent(this, event);
+    if (EventDelegate* delegate = cold().delegate) {
+        delegate->delegatedEvent(this, event);
     }
 }
 
+// Passes the event to onEvent with the points in the widget's own coordinates
+void Widget::deliverEvent(Event& event) {
+    const PointF offset(windowOffset());
+    if (offset == PointF{ 0, 0 }) {
+        onEvent(event);
+        return;
+    }
+    event.translate(-offset);
+    PointF savedOffset = std::exchange(inputQueue->eventOffset, offset);
+    SCOPE_EXIT {
+        inputQueue->eventOffset = savedOffset;
+        event.translate(offset);
+    };
+    onEvent(event);
+}
+
 void Widget::bubbleEvent(Event& event, WidgetState enable, WidgetState disable, bool includePopup) {
     bubble(
         [&](Widget* current) BRISK_INLINE_LAMBDA {
             current->setState((current->m_state | enable) & ~disable);
             if (event)
-                current->onEvent(event);
+                current->deliverEvent(event);
             return true;
         },
         includePopup);
@@ -1273,13 +1464,15 @@ void Widget::bubbleEvent(Event& event, WidgetState enable, WidgetState disable,
 
 void Widget::updateGeometry() {
     auto self            = shared_from_this();
-    Rectangle mouse_rect = m_rect;
+    // Hit-test rectangles are in window coordinates
+    const Point offset   = inputQueue->hitTest.state.offset;
+    Rectangle mouse_rect = m_rect.withOffset(offset);
 
     auto saved_state     = inputQueue->hitTest.state;
     if (m_zorder != ZOrder::Normal)
         inputQueue->hitTest.state.zindex--;
     if (m_zorder == ZOrder::Normal)
-        mouse_rect = m_rect.intersection(saved_state.scissors);
+        mouse_rect = mouse_rect.intersection(saved_state.scissors);
     inputQueue->hitTest.state.scissors = mouse_rect;
     inputQueue->hitTest.state.visible  = inputQueue->hitTest.state.visible && m_visible && !m_hidden;
     if (m_mouseInteraction == MouseInteraction::Enable)
@@ -1303,6 +1496,7 @@ void Widget::updateGeometry() {
     inputQueue->hitTest.state.inTabGroup = m_tabGroup;
     inputQueue->hitTest.add(self, mouse_rect, m_mouseAnywhere);
     for (const Ptr& w : *this) {
+        inputQueue->hitTest.state.offset = offset + offsetOf(*w);
         w->updateGeometry();
     }
     onLayoutUpdated();
@@ -1345,7 +1539,7 @@ static void assign_inherited(PropState state, T& target, T source, bool& changed
 template <typename T>
 static void assign_inherited(PropState state, Internal::Transition<T>& target, T source, bool& changed) {
     if (state && PropState::Inherited) {
-        target.set(source, false);
+        target.set(source);
     }
 }
 
@@ -1515,8 +1709,6 @@ Font Widget::font() const {
     };
 }
 
-void Widget::onRefresh() {}
-
 void Widget::onHidden() {}
 
 void Widget::onVisible() {}
@@ -1611,7 +1803,7 @@ void Widget::resolveProperties(PropFlags flags) {
         }
     }
     if (getPropState(color.index) && PropState::Inherited) {
-        m_color = getFallback(m_parent, &Widget::m_color, Palette::white);
+        transitionTo(m_color, getFallback(m_parent, &Widget::m_color, Palette::white), 0.f, nullptr);
     }
     if (getPropState(textAlign.index) && PropState::Inherited) {
         m_textAlign = getFallback(m_parent, &Widget::m_textAlign, TextAlign::Start);
@@ -1674,7 +1866,7 @@ void Widget::remove(Widget* widget) {
 }
 
 void Widget::append(Widget* widget) {
-    append(Widget::Ptr(widget));
+    append(Internal::rcNew * widget);
 }
 
 void Widget::apply(Widget::Ptr widget) {
@@ -1684,7 +1876,7 @@ void Widget::apply(Widget::Ptr widget) {
 
 void Widget::apply(Widget* widget) {
     if (widget)
-        append(Widget::Ptr(widget));
+        append(Internal::rcNew * widget);
 }
 
 const Widget::WidgetPtrs& Widget::widgets() const {
@@ -1709,6 +1901,20 @@ Widget::Ptr Widget::clone() {
     return result;
 }
 
+const Internal::WidgetCold Internal::WidgetCold::defaults{};
+
+void* Internal::WidgetCold::operator new(size_t size) {
+    void* ptr = MemoryArena::allocate(size);
+    bindings->registerRegion(
+        BindingAddress{ reinterpret_cast<uint8_t*>(ptr), reinterpret_cast<uint8_t*>(ptr) + size }, uiThread);
+    return ptr;
+}
+
+void Internal::WidgetCold::operator delete(void* ptr, size_t size) {
+    bindings->unregisterRegion(reinterpret_cast<uint8_t*>(ptr));
+    MemoryArena::deallocate(ptr, size);
+}
+
 Widget::Widget(const Widget&) = default;
 
 Widget::Widget(Construction construction) : m_layoutEngine{ this } {
@@ -1757,6 +1963,10 @@ bool Widget::isVisible() const noexcept {
 void Widget::setTree(WidgetTree* tree) {
     if (tree != m_tree) {
         if (m_tree) {
+            for (auto field : { &Widget::m_backgroundColor, &Widget::m_borderColor, &Widget::m_color,
+                                &Widget::m_shadowColor }) {
+                m_tree->m_animations.finish(this->*field);
+            }
             m_tree->detach(this);
         }
         m_tree = tree;
@@ -1849,18 +2059,16 @@ void Widget::requestRebuild() {
 
 void Widget::animationFrame() {
     m_animationRequested = false;
-    m_color.tick(m_colorTransition, m_colorEasing);
-    m_borderColor.tick(m_borderColorTransition, m_borderColorEasing);
-    m_backgroundColor.tick(m_backgroundColorTransition, m_backgroundColorEasing);
-    m_shadowColor.tick(shadowColorTransition, m_shadowColorEasing);
-
-    if (m_color.isActive() || m_borderColor.isActive() || m_backgroundColor.isActive() ||
-        m_shadowColor.isActive())
-        requestAnimationFrame();
-
     onAnimationFrame();
 }
 
+bool Widget::transitionTo(Internal::Transition<ColorF>& field, ColorF value, float duration,
+                          EasingFunction easing) {
+    if (!m_tree)
+        return field.set(value);
+    return m_tree->m_animations.set(field, value, frameStartTime, duration, easing);
+}
+
 void Widget::onAnimationFrame() {}
 
 Value<Trigger<>> Widget::trigRebuild() {
@@ -1946,8 +2154,9 @@ template <typename T>
 std::optional<T> Widget::getStyleVar(unsigned id) const {
     const Widget* self = this;
     do {
-        if (id < self->m_styleVars.size()) {
-            if (const T* val = std::get_if<T>(&self->m_styleVars[id])) {
+        const std::vector<StyleVarType>& styleVars = self->cold().styleVars;
+        if (id < styleVars.size()) {
+            if (const T* val = std::get_if<T>(&styleVars[id])) {
                 return *val;
             }
         }
@@ -2113,15 +2322,31 @@ BRISK_INLINE static const T& getterConvert(const Internal::Transition<T>& value)
 } // namespace Internal
 
 template <typename T>
-float Widget::* Widget::transitionField(Internal::Transition<T> Widget::* field) const noexcept {
+float Internal::WidgetCold::* Widget::transitionField(
+    Internal::Transition<T> Widget::* field) const noexcept {
+    if (field == &Widget::m_backgroundColor)
+        return &Internal::WidgetCold::backgroundColorTransition;
+    else if (field == &Widget::m_borderColor)
+        return &Internal::WidgetCold::borderColorTransition;
+    else if (field == &Widget::m_color)
+        return &Internal::WidgetCold::colorTransition;
+    else if (field == &Widget::m_shadowColor)
+        return &Internal::WidgetCold::shadowColorTransition;
+    else
+        return nullptr;
+}
+
+template <typename T>
+EasingFunction Internal::WidgetCold::* Widget::easingField(
+    Internal::Transition<T> Widget::* field) const noexcept {
     if (field == &Widget::m_backgroundColor)
-        return &Widget::m_backgroundColorTransition;
+        return &Internal::WidgetCold::backgroundColorEasing;
     else if (field == &Widget::m_borderColor)
-        return &Widget::m_borderColorTransition;
+        return &Internal::WidgetCold::borderColorEasing;
     else if (field == &Widget::m_color)
-        return &Widget::m_colorTransition;
+        return &Internal::WidgetCold::colorEasing;
     else if (field == &Widget::m_shadowColor)
-        return &Widget::m_shadowColorTransition;
+        return &Internal::WidgetCold::shadowColorEasing;
     else
         return nullptr;
 }
@@ -2154,24 +2379,46 @@ const InputT& resolveField(std::bool_constant<false>, const Internal::Resolve<In
     return field.value;
 }
 
+template <typename T>
+struct MemberOwner;
+
+template <typename T, typename Class>
+struct MemberOwner<T Class::*> {
+    using Type = Class;
+};
+
+// Fields of WidgetCold are read from the shared defaults and allocated on write or when their address is
+// taken for a binding
+template <auto field, typename U>
+BRISK_INLINE decltype(auto) widgetField(U& self) noexcept {
+    if constexpr (std::is_same_v<typename MemberOwner<decltype(field)>::Type, Internal::WidgetCold>) {
+        if constexpr (std::is_const_v<U>)
+            return (self.cold().*field);
+        else
+            return (self.writableCold().*field);
+    } else {
+        return (self.*field);
+    }
+}
+
 template <auto field1, typename U, bool resolved>
 decltype(auto) subField(std::bool_constant<resolved> cresolved, U&& self) noexcept {
-    return resolveField(cresolved, self.*field1);
+    return resolveField(cresolved, widgetField<field1>(self));
 }
 
 template <auto field1, auto field2, typename U>
 decltype(auto) subField(std::false_type, U&& self) noexcept {
-    return resolveField(std::false_type{}, self.*field1).*field2;
+    return resolveField(std::false_type{}, widgetField<field1>(self)).*field2;
 }
 
 template <auto field1, auto field2, auto, typename U>
 decltype(auto) subField(std::false_type, U&& self) noexcept {
-    return resolveField(std::false_type{}, self.*field1).*field2;
+    return resolveField(std::false_type{}, widgetField<field1>(self)).*field2;
 }
 
 template <auto field1, auto field2a, auto field2R, typename U>
 decltype(auto) subField(std::true_type, U&& self) noexcept {
-    return resolveField(std::true_type{}, self.*field1).*field2R;
+    return resolveField(std::true_type{}, widgetField<field1>(self)).*field2R;
 }
 } // namespace
 
@@ -2213,11 +2460,10 @@ void Widget::setter(T value) {
         field = value;
     } else {
         if constexpr (flags && Transition) {
-            if (!field.set(value, transitionAllowed() ? this->*(transitionField(fields...)) : 0.f))
+            const Internal::WidgetCold& cold = this->cold();
+            if (!transitionTo(field, value, transitionAllowed() ? cold.*(transitionField(fields...)) : 0.f,
+                              cold.*(easingField(fields...))))
                 return;
-            if (field.isActive()) {
-                requestAnimationFrame();
-            }
         } else {
             if (value == field) {
                 return; // Not changed
@@ -150,7 +150,10 @@ void GUIWindow::rebuild() {
 
 void GUIWindow::rebuildRoot() {
     BRISK_ASSERT(m_component);
-    m_tree.setRoot(Widget::Ptr(m_component->build()));
+    {
+        MemoryArena::Scope scope = m_tree.arenaScope();
+        m_tree.setRoot(Widget::Ptr(m_component->build()));
+    }
     BRISK_ASSERT(m_tree.root());
     m_backgroundColor = m_tree.root()->getStyleVar<ColorF>(windowColor.id).value_or(ColorF(0.f, 0.f));
 }
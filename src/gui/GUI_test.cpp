@@ -21,7 +21,428 @@
 #include <catch2/catch_all.hpp>
 #include "Catch2Utils.hpp"
 #include <brisk/gui/GUI.hpp>
+#include <brisk/gui/Styles.hpp>
 
 using namespace Brisk;
 
 TEST_CASE("Widget constructors") {}
+
+TEST_CASE("Incremental layout") {
+    // 10 rows of 10 leaves each
+    std::vector<RC<Widget>> leaves;
+    RC<Widget> root = rcnew Widget{ layout = Layout::Vertical, dimensions = { 400_px, 300_px } };
+    for (int r = 0; r < 10; ++r) {
+        RC<Widget> row = rcnew Widget{ layout = Layout::Horizontal };
+        for (int c = 0; c < 10; ++c) {
+            RC<Widget> leaf = rcnew Widget{ dimensions = { 20_px, 10_px } };
+            leaves.push_back(leaf);
+            row->apply(leaf);
+        }
+        root->apply(row);
+    }
+    HeadlessTree headless(root, { 400, 300 });
+    headless.frame();
+    CHECK(headless.tree.layoutStats().visited >= 111);
+    CHECK(leaves[99]->rect() == Rectangle{ 180, 90, 200, 100 });
+
+    headless.frame();
+    CHECK(headless.tree.layoutStats().visited == 0);
+
+    // Yoga relays out the path to the leaf and positions the direct children of that path
+    leaves[35]->width = 30_px;
+    headless.frame();
+    CHECK(headless.tree.layoutStats().visited <= 1 + 10 + 10);
+    CHECK(headless.tree.layoutStats().changed == 5);
+    CHECK(leaves[35]->rect() == Rectangle{ 100, 30, 130, 40 });
+    CHECK(leaves[39]->rect() == Rectangle{ 190, 30, 210, 40 });
+    CHECK(leaves[40]->rect() == Rectangle{ 0, 40, 20, 50 });
+
+    // Rows below a resized one move together with all their leaves
+    leaves[5]->height = 20_px;
+    headless.frame();
+    CHECK(leaves[5]->rect() == Rectangle{ 100, 0, 120, 20 });
+    CHECK(leaves[99]->rect() == Rectangle{ 180, 100, 200, 110 });
+}
+
+namespace {
+struct ColdProbe : public Widget {
+    using Widget::Widget;
+
+    bool hasCold() const noexcept {
+        return static_cast<bool>(m_cold);
+    }
+
+protected:
+    Ptr cloneThis() override {
+        BRISK_CLONE_IMPLEMENTATION;
+    }
+};
+} // namespace
+
+TEST_CASE("Widget cold data") {
+    RC<ColdProbe> w = rcnew ColdProbe{ dimensions = { 20_px, 10_px } };
+    CHECK(!w->hasCold());
+    CHECK(w->hint.get() == "");
+    CHECK(w->backgroundColorTransition.get() == 0.f);
+    CHECK(!w->getStyleVar<float>(styleVarCustomID));
+    CHECK(!w->hasCold());
+
+    w->hint = "Tooltip";
+    CHECK(w->hasCold());
+    CHECK(w->hint.get() == "Tooltip");
+    w->set(StyleVariableTag<float, styleVarCustomID>{}, 2.f);
+    CHECK(w->getStyleVar<float>(styleVarCustomID, 0.f) == 2.f);
+
+    // The cold block is a binding region of its own, so the properties stored there can be bound
+    std::vector<std::string> hints;
+    bindings->listen(Value{ &w->hint }, [&hints](std::string hint) {
+        hints.push_back(std::move(hint));
+    });
+    w->hint = "Changed";
+    CHECK(hints == std::vector<std::string>{ "Changed" });
+
+    RC<ColdProbe> copy = std::dynamic_pointer_cast<ColdProbe>(w->clone());
+    REQUIRE(copy);
+    CHECK(copy->hasCold());
+    CHECK(copy->hint.get() == "Changed");
+    CHECK(copy->getStyleVar<float>(styleVarCustomID, 0.f) == 2.f);
+    copy->hint = "Copy";
+    CHECK(w->hint.get() == "Changed");
+    CHECK(hints.size() == 1);
+
+    // Binding a property allocates the block, so the bound address stays valid
+    RC<ColdProbe> fresh = rcnew ColdProbe{};
+    bindings->listen(Value{ &fresh->painter }, [] {});
+    CHECK(fresh->hasCold());
+}
+
+TEST_CASE("Widget click handlers") {
+    struct Listener {
+        int clicks = 0;
+        BindingRegistration registration{ this, nullptr };
+    };
+
+    Listener listener;
+    RC<Widget> w = rcnew Widget{
+        dimensions = { 20_px, 10_px },
+        onClick    = listener.registration |
+                  [&listener] {
+                      ++listener.clicks;
+                  },
+    };
+
+    HeadlessTree headless(w, { 100, 100 });
+    headless.frame();
+    headless.queue.addEvent(EventMouseButtonPressed{
+        { { { {}, KeyModifiers::None }, PointF(5, 5), nullopt }, MouseButton::Left } });
+    headless.frame();
+    CHECK(listener.clicks == 1);
+}
+
+TEST_CASE("Widget colour transitions") {
+    RC<Widget> child = rcnew Widget{ backgroundColor = Palette::black, backgroundColorTransition = 100.f };
+    RC<Widget> root  = rcnew Widget{ child };
+    HeadlessTree headless(root, { 100, 100 });
+    headless.frame();
+    CHECK(!headless.tree.animations().active());
+
+    child->backgroundColor = Palette::white;
+    CHECK(headless.tree.animations().size() == 1);
+    CHECK(child->backgroundColor.get() == ColorF(Palette::white));
+    CHECK(child->backgroundColor.current() != ColorF(Palette::white));
+    headless.frame();
+    CHECK(headless.tree.animations().active());
+
+    // Without a transition duration the value changes immediately
+    child->borderColor = Palette::white;
+    CHECK(child->borderColor.current() == ColorF(Palette::white));
+    CHECK(headless.tree.animations().size() == 1);
+
+    // Detaching a widget from the tree completes its transitions
+    headless.tree.setRoot(nullptr);
+    CHECK(!headless.tree.animations().active());
+    CHECK(child->backgroundColor.current() == ColorF(Palette::white));
+}
+
+TEST_CASE("Widget traversal", "[.benchmark]") {
+    fmt::print("sizeof(Widget)         = {}\n", sizeof(Widget));
+    fmt::print("sizeof(WidgetCold)     = {}\n", sizeof(Internal::WidgetCold));
+
+    RC<Widget> root = rcnew Widget{ layout = Layout::Vertical, dimensions = { 1000_px, 1000_px } };
+    for (int r = 0; r < 100; ++r) {
+        RC<Widget> row = rcnew Widget{ layout = Layout::Horizontal };
+        for (int c = 0; c < 100; ++c) {
+            row->apply(rcnew Widget{ dimensions = { 10_px, 10_px } });
+        }
+        root->apply(row);
+    }
+    HeadlessTree headless(root, { 1000, 1000 });
+    headless.frame();
+
+    BENCHMARK("Sum rectangles of 10k widgets") {
+        int64_t sum = 0;
+        root->enumerate(
+            [&](Widget* w) {
+                sum += w->rect().x2 + w->rect().y2;
+            },
+            true);
+        return sum;
+    };
+}
+
+static RC<Widget> buildGrid(int rows, int columns) {
+    return rcnew Widget{
+        layout = Layout::Vertical,
+        Builder(
+            [rows, columns](Widget* target) {
+                for (int r = 0; r < rows; ++r) {
+                    Widget* row = new Widget{ layout = Layout::Horizontal };
+                    for (int c = 0; c < columns; ++c) {
+                        row->apply(new Widget{ dimensions = { 10_px, 10_px } });
+                    }
+                    target->apply(row);
+                }
+            },
+            BuilderKind::Regular),
+    };
+}
+
+TEST_CASE("Widget arena") {
+    RC<MemoryArena> arena     = rcnew MemoryArena();
+    RC<MemoryArena> treeArena = rcnew MemoryArena();
+    {
+        RC<Widget> root;
+        {
+            MemoryArena::Scope scope(arena.get());
+            root = buildGrid(10, 10);
+        }
+        // Widgets, layout engines and control blocks
+        CHECK(arena->statistics().liveBlocks >= 3 * 111);
+        HeadlessTree headless(std::move(root), { 100, 100 });
+        headless.frame();
+        Widget* rootWidget = headless.tree.root().get();
+        CHECK(rootWidget->widgets()[9]->widgets()[9]->rect() == Rectangle{ 90, 90, 100, 100 });
+
+        // Rebuilds allocate from the tree's arena
+        headless.tree.setArena(treeArena);
+        rootWidget->rebuild(true);
+        CHECK(treeArena->statistics().liveBlocks >= 3 * 110);
+        headless.frame();
+        CHECK(rootWidget->widgets()[9]->widgets()[9]->rect() == Rectangle{ 90, 90, 100, 100 });
+    }
+    CHECK(arena->statistics().liveBlocks == 0);
+    CHECK(treeArena->statistics().liveBlocks == 0);
+}
+
+TEST_CASE("Widget arena benchmark", "[.benchmark]") {
+    BENCHMARK("Build and destroy 10k widgets on the heap") {
+        return buildGrid(100, 100)->widgets().size();
+    };
+
+    BENCHMARK("Build and destroy 10k widgets in an arena") {
+        MemoryArena arena;
+        MemoryArena::Scope scope(&arena);
+        return buildGrid(100, 100)->widgets().size();
+    };
+
+    MemoryArena arena;
+    BENCHMARK("Rebuild 10k widgets in a reused arena") {
+        MemoryArena::Scope scope(&arena);
+        return buildGrid(100, 100)->widgets().size();
+    };
+}
+
+namespace {
+struct KeyedList {
+    std::vector<int> items;
+    int created = 0;
+
+    RC<Widget> build() {
+        return rcnew Widget{
+            layout = Layout::Vertical,
+            Builder(
+                [this](Widget* target) {
+                    for (int item : items) {
+                        target->applyKeyed(std::to_string(item), [&]() {
+                            ++created;
+                            return new Widget{ id = std::to_string(item), dimensions = { 10_px, 10_px } };
+                        });
+                    }
+                },
+                BuilderKind::Regular),
+        };
+    }
+
+    std::vector<std::string> ids(const RC<Widget>& root) const {
+        std::vector<std::string> result;
+        for (const RC<Widget>& w : root->widgets()) {
+            result.push_back(w->id.get());
+        }
+        return result;
+    }
+};
+} // namespace
+
+TEST_CASE("Keyed rebuild") {
+    KeyedList list{ { 1, 2, 3, 4, 5 } };
+    RC<Widget> root = list.build();
+    CHECK(list.created == 5);
+    CHECK(list.ids(root) == std::vector<std::string>{ "1", "2", "3", "4", "5" });
+    Widget* w3 = root->widgets()[2].get();
+
+    // Insert
+    list.items = { 0, 1, 2, 3, 4, 5, 6 };
+    root->rebuild(true);
+    CHECK(list.created == 7);
+    CHECK(list.ids(root) == std::vector<std::string>{ "0", "1", "2", "3", "4", "5", "6" });
+    CHECK(root->widgets()[3].get() == w3);
+
+    // Remove
+    list.items = { 0, 3, 6 };
+    root->rebuild(true);
+    CHECK(list.created == 7);
+    CHECK(list.ids(root) == std::vector<std::string>{ "0", "3", "6" });
+    CHECK(root->widgets()[1].get() == w3);
+
+    // Move
+    list.items = { 6, 3, 0 };
+    root->rebuild(true);
+    CHECK(list.created == 7);
+    CHECK(list.ids(root) == std::vector<std::string>{ "6", "3", "0" });
+    CHECK(root->widgets()[1].get() == w3);
+    CHECK(w3->parent() == root.get());
+
+    // Removed keys are created anew
+    list.items = { 6, 2, 3 };
+    root->rebuild(true);
+    CHECK(list.created == 8);
+    CHECK(list.ids(root) == std::vector<std::string>{ "6", "2", "3" });
+
+    // Duplicate keys
+    list.items = { 3, 3 };
+    root->rebuild(true);
+    CHECK(list.created == 9);
+    CHECK(list.ids(root) == std::vector<std::string>{ "3", "3" });
+    CHECK(root->widgets()[0].get() == w3);
+
+    list.items = {};
+    root->rebuild(true);
+    CHECK(root->widgets().empty());
+}
+
+TEST_CASE("Keyed rebuild layout") {
+    KeyedList list{ { 1, 2, 3 } };
+    HeadlessTree headless(list.build(), { 100, 100 });
+    headless.frame();
+    RC<Widget> root = headless.tree.root();
+    Widget* w1      = root->widgets()[0].get();
+    CHECK(w1->rect() == Rectangle{ 0, 0, 10, 10 });
+
+    list.items = { 3, 2, 1 };
+    root->rebuild(true);
+    headless.frame();
+    CHECK(root->widgets()[2].get() == w1);
+    CHECK(w1->rect() == Rectangle{ 0, 20, 10, 30 });
+}
+
+TEST_CASE("Keyed rebuild benchmark", "[.benchmark]") {
+    KeyedList list;
+    for (int i = 0; i < 10000; ++i) {
+        list.items.push_back(i);
+    }
+    RC<Widget> root = list.build();
+    int next        = 10000;
+
+    BENCHMARK("Insert one item into a keyed list of 10k") {
+        list.items.insert(list.items.begin() + 5000, next++);
+        list.items.pop_back();
+        root->rebuild(true);
+        return root->widgets().size();
+    };
+
+    BENCHMARK("Insert one item into a list of 10k, full rebuild") {
+        list.items.insert(list.items.begin() + 5000, next++);
+        list.items.pop_back();
+        RC<Widget> fresh = list.build();
+        return fresh->widgets().size();
+    };
+}
+
+static RC<Widget> buildPaintGrid(int columns, int rows) {
+    RC<Widget> root = rcnew Widget{ layout = Layout::Horizontal, backgroundColor = 0x202020_rgb };
+    for (int c = 0; c < columns; ++c) {
+        RC<Widget> column = rcnew Widget{ layout = Layout::Vertical, borderWidth = 1_px,
+                                          borderColor = 0x808080_rgb, clip = WidgetClip::All };
+        for (int r = 0; r < rows; ++r) {
+            std::string label = fmt::format("{}:{}", c, r);
+            column->apply(rcnew Widget{
+                dimensions      = { 40_px, 12_px },
+                backgroundColor = ColorF(c * 0.1f, r * 0.02f, 0.5f),
+                painter         = Painter([label](Canvas& canvas, const Widget& w) {
+                    boxPainter(canvas, w);
+                    canvas.raw().drawText(w.rect(), 0.f, 0.5f, label, Font{ DefaultFont, 10.f },
+                                                  Palette::white);
+                }),
+            });
+        }
+        // Painted as a separate layer
+        column->apply(rcnew Widget{ zorder = ZOrder::TopMost, dimensions = { 10_px, 10_px },
+                                    backgroundColor = 0xFF0000_rgb });
+        root->apply(column);
+    }
+    return root;
+}
+
+static void checkSameCommands(const RecordingContext& a, const RecordingContext& b) {
+    REQUIRE(a.commands().size() == b.commands().size());
+    for (size_t i = 0; i < a.commands().size(); ++i) {
+        const RecordingContext::Command& ca = a.commands()[i];
+        const RecordingContext::Command& cb = b.commands()[i];
+        CHECK(static_cast<const RenderState&>(ca.state) == static_cast<const RenderState&>(cb.state));
+        // Sprites are rasterized anew for every paint, so their contents are compared
+        REQUIRE(ca.state.sprites.size() == cb.state.sprites.size());
+        for (size_t j = 0; j < ca.state.sprites.size(); ++j) {
+            CHECK(ca.state.sprites[j]->size == cb.state.sprites[j]->size);
+            CHECK(std::ranges::equal(ca.state.sprites[j]->bytes(), cb.state.sprites[j]->bytes()));
+        }
+        CHECK(ca.state.gradientHandle == cb.state.gradientHandle);
+        CHECK(ca.state.imageHandle == cb.state.imageHandle);
+        CHECK(std::equal(a.data().begin() + ca.dataOffset, a.data().begin() + ca.dataOffset + ca.dataSize,
+                         b.data().begin() + cb.dataOffset, b.data().begin() + cb.dataOffset + cb.dataSize));
+    }
+}
+
+TEST_CASE("Parallel paint recording") {
+    HeadlessTree headless(buildPaintGrid(8, 30), { 400, 300 });
+    headless.frame();
+
+    RecordingContext sequential;
+    Canvas sequentialCanvas(sequential);
+    headless.tree.updateAndPaint(sequentialCanvas);
+    CHECK(sequential.commands().size() > 8 * 30);
+
+    for (size_t threads : { 1, 3, 8 }) {
+        WorkerPool pool(threads);
+        headless.tree.setPaintPool(&pool);
+        RecordingContext parallel;
+        Canvas parallelCanvas(parallel);
+        headless.tree.updateAndPaint(parallelCanvas);
+        checkSameCommands(sequential, parallel);
+        headless.tree.setPaintPool(nullptr);
+    }
+}
+
+TEST_CASE("Parallel paint benchmark", "[.benchmark]") {
+    HeadlessTree headless(buildPaintGrid(16, 100), { 1600, 1200 });
+    headless.frame();
+
+    BENCHMARK("Paint 1600 widgets sequentially") {
+        headless.frame();
+    };
+
+    headless.tree.setPaintPool(&workerPool());
+    BENCHMARK("Paint 1600 widgets in parallel") {
+        headless.frame();
+    };
+    headless.tree.setPaintPool(nullptr);
+}
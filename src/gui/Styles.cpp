@@ -63,21 +63,214 @@ void Rules::applyTo(Widget* widget) const {
     }
 }
 
+// Gathers the bits of `state` selected by `mask` into the low bits
+static uint32_t packState(WidgetState state, WidgetState mask) noexcept {
+    uint32_t result = 0;
+    uint32_t bit    = 1;
+    for (uint32_t m = +mask; m; m &= m - 1, bit <<= 1) {
+        if (+state & m & ~(m - 1))
+            result |= bit;
+    }
+    return result;
+}
+
+static WidgetState unpackState(uint32_t packed, WidgetState mask) noexcept {
+    uint32_t result = 0;
+    for (uint32_t m = +mask; m; m &= m - 1, packed >>= 1) {
+        if (packed & 1)
+            result |= m & ~(m - 1);
+    }
+    return static_cast<WidgetState>(result);
+}
+
+CompiledRules::CompiledRules(Rules rules) : rules(std::move(rules)) {
+    for (const Rule& r : this->rules.rules) {
+        m_stateMask |= r.state();
+    }
+    m_variants.reset(new std::atomic<const Variant*>[size_t(1) << std::popcount(+m_stateMask)]{});
+}
+
+CompiledRules::~CompiledRules() {
+    for (size_t packed = 0; packed < size_t(1) << std::popcount(+m_stateMask); ++packed) {
+        delete m_variants[packed].load(std::memory_order_relaxed);
+    }
+}
+
+const CompiledRules::Variant& CompiledRules::variant(uint32_t packed) const {
+    std::atomic<const Variant*>& slot = m_variants[packed];
+    if (const Variant* resolved = slot.load(std::memory_order_acquire)) [[likely]]
+        return *resolved;
+
+    const WidgetState state = unpackState(packed, m_stateMask);
+    auto resolved           = std::make_unique<Variant>();
+    for (const Rule& r : this->rules.rules) {
+        if ((state & r.state()) != r.state())
+            continue;
+        // Rules for the same property are adjacent unless properties share a name, and the later
+        // one wins, exactly as if all of them were applied in order
+        auto it = resolved->rbegin();
+        while (it != resolved->rend() && (*it)->name() == r.name() && (*it)->id() != r.id())
+            ++it;
+        if (it != resolved->rend() && (*it)->id() == r.id())
+            *it = &r;
+        else
+            resolved->push_back(&r);
+    }
+    // Rules may be shared between trees, so another thread may have resolved the same state meanwhile
+    const Variant* existing = nullptr;
+    if (!slot.compare_exchange_strong(existing, resolved.get(), std::memory_order_acq_rel))
+        return *existing;
+    return *resolved.release();
+}
+
+std::span<const Rule* const> CompiledRules::resolve(WidgetState state) const {
+    return variant(packState(state, m_stateMask));
+}
+
+std::string CompiledRules::key(const Rules& rules) {
+    std::string result(1, '\x1c');
+    for (const Rule& r : rules.rules) {
+        const void* storage = r.m_storage.get();
+        result.append(reinterpret_cast<const char*>(&r.m_property), sizeof(r.m_property));
+        result.append(reinterpret_cast<const char*>(&storage), sizeof(storage));
+        result.append(reinterpret_cast<const char*>(&r.m_state), sizeof(r.m_state));
+        result.append(reinterpret_cast<const char*>(&r.m_op), sizeof(r.m_op));
+    }
+    return result;
+}
+
+void CompiledRules::applyTo(Widget* widget) const {
+    Widget::StyleApplying styleApplying(widget);
+    for (const Rule* r : resolve(widget->state())) {
+        r->apply(widget);
+    }
+}
+
+namespace Internal {
+
+StylesheetIndex& StylesheetIndex::operator=(const StylesheetIndex&) noexcept {
+    std::lock_guard lk(mutex);
+    built = false;
+    return *this;
+}
+
+} // namespace Internal
+
+constexpr static size_t maxMatchedRulesCacheSize = 4096;
+
+void Stylesheet::buildIndex() const {
+    if (m_index.built && m_index.styleCount == size())
+        return;
+    for (Internal::StylesheetIndex::KeyMap& map : m_index.keyed) {
+        map.clear();
+    }
+    m_index.unkeyed.clear();
+    m_index.matched.clear();
+    for (uint32_t i = 0; i < size(); ++i) {
+        const Selectors::Keys& keys = (*this)[i].selector.keys();
+        if (keys.empty())
+            m_index.unkeyed.push_back(i);
+        for (const Selectors::Key& key : keys) {
+            std::vector<uint32_t>& list = m_index.keyed[+key.kind][std::string(key.value)];
+            if (list.empty() || list.back() != i)
+                list.push_back(i);
+        }
+    }
+    m_index.built      = true;
+    m_index.styleCount = size();
+}
+
 void Stylesheet::stylize(Widget* widget, bool isRoot) const {
+    std::shared_ptr<const CompiledRules> rules = match(widget, isRoot);
+    rules->applyTo(widget);
+    widget->m_reapplyStyle = [rules = std::move(rules)](Widget* self) {
+        rules->applyTo(self);
+    };
+}
+
+std::shared_ptr<const CompiledRules> Stylesheet::match(Widget* widget, bool isRoot) const {
+    // Everything selectors of Scope::Parent depend on
+    std::string key;
+    auto appendSignature = [&key](const Widget* w) {
+        key += w->m_type;
+        key += '\x1f';
+        key += w->m_id;
+        key += '\x1f';
+        key += w->m_role;
+        key += '\x1f';
+        for (const std::string& c : w->m_classes) {
+            key += c;
+            key += '\x1e';
+        }
+        const auto state = static_cast<std::underlying_type_t<WidgetState>>(w->m_state);
+        key.append(reinterpret_cast<const char*>(&state), sizeof(state));
+    };
+    key += isRoot ? 'R' : '-';
+    appendSignature(widget);
+    if (widget->m_parent) {
+        key += '\x1d';
+        appendSignature(widget->m_parent);
+    }
+
+    {
+        std::lock_guard lk(m_index.mutex);
+        buildIndex();
+        if (auto it = m_index.matched.find(key); it != m_index.matched.end())
+            return it->second;
+    }
+
     Rules rules;
+    Selectors::Scope scope = Selectors::Scope::Self;
     for (const auto& ss : inherited) {
         BRISK_ASSERT(ss);
-        ss->stylizeInternal(rules, widget, isRoot);
+        ss->stylizeInternal(rules, scope, widget, isRoot);
     }
-    stylizeInternal(rules, widget, isRoot);
-    rules.applyTo(widget);
-    widget->m_reapplyStyle = [rules = std::move(rules)](Widget* self) {
-        rules.applyTo(self);
-    };
+    stylizeInternal(rules, scope, widget, isRoot);
+
+    if (scope == Selectors::Scope::Tree) {
+        // Matching depends on ancestors beyond the parent, so the widget signature can't be the key.
+        // Widgets that matched the same rules share their compiled tables instead
+        key = CompiledRules::key(rules);
+        std::lock_guard lk(m_index.mutex);
+        if (auto it = m_index.matched.find(key); it != m_index.matched.end())
+            return it->second;
+    }
+    auto result = std::make_shared<const CompiledRules>(std::move(rules));
+    {
+        std::lock_guard lk(m_index.mutex);
+        if (m_index.matched.size() >= maxMatchedRulesCacheSize)
+            m_index.matched.clear();
+        m_index.matched.insert_or_assign(std::move(key), result);
+    }
+    return result;
 }
 
-void Stylesheet::stylizeInternal(Rules& rules, Widget* widget, bool isRoot) const {
-    for (const Style& style : *this) {
+void Stylesheet::stylizeInternal(Rules& rules, Selectors::Scope& scope, Widget* widget, bool isRoot) const {
+    using Selectors::KeyKind;
+    // Styles whose selectors can possibly match, in stylesheet order
+    SmallVector<uint32_t, 32> candidates;
+    {
+        std::lock_guard lk(m_index.mutex);
+        buildIndex();
+        auto addKeyed = [&](KeyKind kind, std::string_view value) BRISK_INLINE_LAMBDA {
+            const Internal::StylesheetIndex::KeyMap& map = m_index.keyed[+kind];
+            if (auto it = map.find(value); it != map.end())
+                candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+        };
+        candidates.assign(m_index.unkeyed.begin(), m_index.unkeyed.end());
+        addKeyed(KeyKind::Id, widget->m_id);
+        addKeyed(KeyKind::Type, widget->m_type);
+        addKeyed(KeyKind::Role, widget->m_role);
+        for (const std::string& c : widget->m_classes) {
+            addKeyed(KeyKind::Class, c);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    for (uint32_t index : candidates) {
+        const Style& style = (*this)[index];
+        scope              = std::max(scope, style.selector.scope());
         if (style.selector.matches(widget, isRoot ? MatchFlags::IsRoot : MatchFlags::None)) {
             rules.merge(style.rules);
         }
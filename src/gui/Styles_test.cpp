@@ -227,6 +227,76 @@ TEST_CASE("Styles") {
     CHECK(w2->backgroundColor.get() == ColorF(Palette::red));
 }
 
+TEST_CASE("CompiledRules") {
+    using enum WidgetState;
+    CompiledRules compiled(Rules{
+        shadowSize                    = 1,
+        shadowSize | Hover            = 2,
+        shadowSize | Hover | Pressed  = 3,
+        shadowSize | Disabled         = 4,
+        tabSize                       = 5,
+        tabSize | Selected            = 6,
+        opacity | Hover | Selected    = 0.5f,
+    });
+
+    auto effective = [&](WidgetState state) {
+        std::vector<std::string> result;
+        for (const Rule* r : compiled.resolve(state)) {
+            result.push_back(r->toString());
+        }
+        return fmt::format("{}", fmt::join(result, "; "));
+    };
+    CHECK(effective(None) == "shadowSize: 1px; tabSize: 5");
+    CHECK(effective(Focused) == "shadowSize: 1px; tabSize: 5");
+    CHECK(effective(Hover) == "shadowSize | Hover: 2px; tabSize: 5");
+    CHECK(effective(Pressed) == "shadowSize: 1px; tabSize: 5");
+    CHECK(effective(Hover | Pressed) == "shadowSize | Hover | Pressed: 3px; tabSize: 5");
+    CHECK(effective(Hover | Selected) == "opacity | Hover | Selected: 0.5; shadowSize | Hover: 2px; "
+                                         "tabSize | Selected: 6");
+    // Rules with more states win over rules with fewer
+    CHECK(effective(Hover | Disabled) == "shadowSize | Disabled: 4px; tabSize: 5");
+    CHECK(effective(Hover | Pressed | Disabled) == "shadowSize | Hover | Pressed: 3px; tabSize: 5");
+
+    Widget::Ptr w(new Widget{});
+    compiled.applyTo(w.get());
+    CHECK(w->shadowSize.get() == 1_px);
+    CHECK(w->tabSize.get() == 5);
+    unprotect(w)->setState(Hover | Selected);
+    compiled.applyTo(w.get());
+    CHECK(w->shadowSize.get() == 2_px);
+    CHECK(w->tabSize.get() == 6);
+    CHECK(w->opacity.get() == 0.5f);
+}
+
+TEST_CASE("Rules matched by selectors on siblings") {
+    using namespace Selectors;
+    RC<const Stylesheet> ss = rcnew Stylesheet{
+        Style{
+            Class{ "row" },
+            { tabSize = 5 },
+        },
+        Style{
+            First{},
+            { shadowSize = 2 },
+        },
+    };
+    Widget::Ptr parent = rcnew Widget{
+        rcnew Widget{ classes = { "row" } },
+        rcnew Widget{ classes = { "row" } },
+        rcnew Widget{ classes = { "row" } },
+    };
+    const Widget::WidgetPtrs& rows = parent->widgets();
+
+    std::shared_ptr<const CompiledRules> first  = ss->match(rows[0].get(), false);
+    std::shared_ptr<const CompiledRules> second = ss->match(rows[1].get(), false);
+    CHECK(first->rules.rules.size() == 2);
+    CHECK(second->rules.rules.size() == 1);
+    // The rows look the same, but only the rules they matched can identify the result
+    CHECK(first != second);
+    CHECK(ss->match(rows[2].get(), false) == second);
+    CHECK(ss->match(rows[0].get(), false) == first);
+}
+
 TEST_CASE("separate SizeL") {
 
     using namespace Selectors;
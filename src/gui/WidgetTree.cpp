@@ -29,6 +29,11 @@ WidgetGroup::~WidgetGroup() {
     }
 }
 
+WidgetTree::~WidgetTree() {
+    // Detach the widgets while the tree's members are alive, as widgets may outlive the tree
+    setRoot(nullptr);
+}
+
 void WidgetTree::setRoot(std::shared_ptr<Widget> root) {
     if (root != m_root) {
         if (m_root) {
@@ -53,6 +58,7 @@ void WidgetTree::onLayoutUpdated() {
 }
 
 void WidgetTree::processAnimation() {
+    m_animations.tick(frameStartTime);
     auto queue       = std::move(m_animationQueue);
     m_animationQueue = {};
     for (const auto& weak : queue) {
@@ -63,8 +69,9 @@ void WidgetTree::processAnimation() {
 }
 
 void WidgetTree::processRebuild() {
-    auto queue     = std::move(m_rebuildQueue);
-    m_rebuildQueue = {};
+    MemoryArena::Scope scope = arenaScope();
+    auto queue               = std::move(m_rebuildQueue);
+    m_rebuildQueue           = {};
     for (const auto& weak : queue) {
         if (auto strong = weak.lock()) {
             strong->doRebuild();
@@ -80,46 +87,72 @@ void WidgetTree::requestRebuild(std::weak_ptr<Widget> widget) {
     m_rebuildQueue.push_back(std::move(widget));
 }
 
+thread_local std::vector<Drawable>* Internal::layerSink = nullptr;
+
 void WidgetTree::requestLayer(Drawable drawable) {
-    m_layer.push_back(std::move(drawable));
+    if (Internal::layerSink) [[unlikely]]
+        Internal::layerSink->push_back(std::move(drawable));
+    else
+        m_layer.push_back(std::move(drawable));
 }
 
 uint32_t WidgetTree::layoutCounter() const noexcept {
     return m_layoutCounter;
 }
 
+const LayoutStats& WidgetTree::layoutStats() const noexcept {
+    return m_layoutStats;
+}
+
 std::shared_ptr<Widget> WidgetTree::root() const noexcept {
     return m_root;
 }
 
+const RC<MemoryArena>& WidgetTree::arena() const noexcept {
+    return m_arena;
+}
+
+void WidgetTree::setArena(RC<MemoryArena> arena) {
+    m_arena = std::move(arena);
+}
+
+MemoryArena::Scope WidgetTree::arenaScope() const noexcept {
+    return MemoryArena::Scope(m_arena ? m_arena.get() : MemoryArena::current());
+}
+
+const Internal::AnimationScheduler& WidgetTree::animations() const noexcept {
+    return m_animations;
+}
+
+WorkerPool* WidgetTree::paintPool() const noexcept {
+    return m_paintPool;
+}
+
+void WidgetTree::setPaintPool(WorkerPool* pool) {
+    m_paintPool = pool;
+}
+
 void WidgetTree::detach(Widget* widget) {
+    m_windowPlaced.erase(widget);
     onDetached(widget);
 }
 
 void WidgetTree::attach(Widget* widget) {
-    for (WidgetGroup* g : widget->m_groups) {
+    for (WidgetGroup* g : widget->cold().groups) {
         addGroup(g);
     }
     onAttached(widget);
 }
 
-constexpr double refreshInterval = 0.1; // in seconds
-
 void WidgetTree::updateAndPaint(Canvas& canvas) {
     if (!m_root)
         return;
     bindings->assign(frameStartTime, currentTime());
+    m_layoutStats = {};
     for (WidgetGroup* g : m_groups) {
         g->beforeFrame();
     }
 
-    if (frameStartTime >= m_refreshTime + refreshInterval) [[unlikely]] {
-        for (WidgetGroup* g : m_groups) {
-            g->beforeRefresh();
-        }
-        m_root->refreshTree();
-        m_refreshTime = frameStartTime;
-    }
     processAnimation();
     processRebuild();
 
@@ -128,10 +161,12 @@ void WidgetTree::updateAndPaint(Canvas& canvas) {
     }
 
     m_root->updateLayout(viewportRectangle);
+    updateWindowPlacement();
 
     if (m_updateGeometryRequested) {
         inputQueue->reset();
         m_root->updateGeometry();
+        inputQueue->hitTest.build();
         m_updateGeometryRequested = false;
     }
     inputQueue->processEvents();
@@ -142,7 +177,10 @@ void WidgetTree::updateAndPaint(Canvas& canvas) {
         g->beforeLayout(m_root->isLayoutDirty());
     }
 
-    m_root->updateLayout(viewportRectangle);
+    // Event handlers and restyling may have changed the layout since the first pass
+    if (m_root->isLayoutDirty())
+        m_root->updateLayout(viewportRectangle);
+    updateWindowPlacement();
 
     for (WidgetGroup* g : m_groups) {
         g->beforePaint();
@@ -168,7 +206,7 @@ void WidgetTree::updateAndPaint(Canvas& canvas) {
 
     if (Internal::debugBoundaries) {
         std::optional<Rectangle> rect = inputQueue->getAtMouse<Rectangle>([](Widget* w) {
-            return w->rect();
+            return w->windowRect();
         });
         if (rect) {
             canvas.raw().drawRectangle(*rect, 0.f, 0.f, fillColor = 0x102040'40_rgba, strokeWidth = 0.f);
@@ -184,6 +222,30 @@ void WidgetTree::requestUpdateGeometry() {
     m_updateGeometryRequested = true;
 }
 
+void WidgetTree::requestWindowPlacement() {
+    if (!m_windowPlaced.empty())
+        m_windowPlacementRequested = true;
+}
+
+void WidgetTree::updateWindowPlacement() {
+    if (!m_windowPlacementRequested)
+        return;
+    m_windowPlacementRequested = false;
+    std::erase_if(m_windowPlaced, [](Widget* w) {
+        return !w->isPlacedInWindow();
+    });
+    // Scrolling doesn't run a layout pass, so only these widgets are placed again
+    bool changed = false;
+    for (Widget* w : m_windowPlaced) {
+        if (w->placeInWindow())
+            changed = true;
+    }
+    if (changed) {
+        onLayoutUpdated();
+        requestUpdateGeometry();
+    }
+}
+
 void WidgetTree::addGroup(WidgetGroup* group) {
     m_groups.insert(group);
 }
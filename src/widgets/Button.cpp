@@ -23,19 +23,22 @@
 namespace Brisk {
 
 void Button::doClick() {
-    m_onClick.trigger();
+    if (Internal::WidgetCold* cold = m_cold.get())
+        cold->onClick.trigger();
     onClicked();
 }
 
 void Button::onClicked() {}
 
-void Button::onRefresh() {
+void Button::onAnimationFrame() {
+    // Frames are requested only while the button is held down with autorepeat enabled
     if (m_repeatState) {
         int repeats = std::floor((currentTime() - m_repeatState->startTime) / m_repeatInterval);
         if (repeats > m_repeatState->repeats) {
             m_repeatState->repeats = repeats;
             doClick();
         }
+        requestAnimationFrame();
     }
 }
 
@@ -46,6 +49,7 @@ void Button::onEvent(Event& event) {
             focus();
             if (std::isfinite(m_repeatDelay) && std::isfinite(m_repeatInterval)) {
                 m_repeatState = { currentTime() + m_repeatDelay, 0 };
+                requestAnimationFrame();
             }
             if (m_clickEvent == ButtonClickEvent::MouseDown) {
                 doClick();
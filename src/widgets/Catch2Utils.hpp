@@ -20,4 +20,4 @@
  */
 #pragma once
 
-#include "../graphics/Catch2Utils.hpp"
+#include "../gui/Catch2Utils.hpp"
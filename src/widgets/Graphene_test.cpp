@@ -0,0 +1,188 @@
+/*
+ * Brisk
+ *
+ * Cross-platform application framework
+ * --------------------------------------------------------------
+ *
+ * Copyright (C) 2024 Brisk Developers
+ *
+ * This file is part of the Brisk library.
+ *
+ * Brisk is dual-licensed under the GNU General Public License, version 2 (GPL-2.0+),
+ * and a commercial license. You may use, modify, and distribute this software under
+ * the terms of the GPL-2.0+ license if you comply with its conditions.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * If you do not wish to be bound by the GPL-2.0+ license, you must purchase a commercial
+ * license. For commercial licensing options, please visit: https://brisklib.com
+ */
+#include <catch2/catch_all.hpp>
+#include "Catch2Utils.hpp"
+#include <brisk/graphics/Palette.hpp>
+#include <brisk/widgets/Widgets.hpp>
+#include <brisk/widgets/Graphene.hpp>
+#include <brisk/widgets/ListBox.hpp>
+
+namespace Brisk {
+
+// Linear scan over all styles, as done before stylesheets were indexed
+static Rules referenceMatch(const Stylesheet& ss, Widget* widget, bool isRoot) {
+    Rules rules;
+    auto scan = [&](const Stylesheet& s) {
+        for (const Style& style : s) {
+            if (style.selector.matches(widget, isRoot ? MatchFlags::IsRoot : MatchFlags::None))
+                rules.merge(style.rules);
+        }
+    };
+    for (const auto& inherited : ss.inherited) {
+        scan(*inherited);
+    }
+    scan(ss);
+    return rules;
+}
+
+static Widget::Ptr grapheneSample() {
+    return rcnew Widget{
+        rcnew Widget{
+            classes = { "toolbar" },
+            rcnew Button{ rcnew Text{ "OK" }, classes = { "flat" } },
+            rcnew Button{ rcnew Text{ "Cancel" }, classes = { "flat" } },
+            rcnew Button{ rcnew Text{ "Apply" }, classes = { "slim", "square" } },
+        },
+        rcnew CheckBox{ rcnew Text{ "Check" } },
+        rcnew Switch{ rcnew Text{ "Switch" } },
+        rcnew RadioButton{ rcnew Text{ "Radio" } },
+        rcnew SpinBox{},
+        rcnew Slider{},
+        rcnew Knob{},
+        rcnew ComboBox{ rcnew ItemList{ rcnew Text{ "First" }, rcnew Text{ "Second" } } },
+        rcnew TextEditor{ Value<std::string>::constant("text") },
+        rcnew Hyperlink{ "https://brisklib.com", rcnew Text{ "Link" } },
+        rcnew ColorView{ Palette::Standard::red },
+        rcnew ColorView{ Palette::Standard::red, classes = { "large" } },
+        rcnew ItemList{ rcnew Item{ rcnew Text{ "Item" } }, rcnew Item{ rcnew Text{ "Item" } } },
+        rcnew ListBox{ rcnew Text{ "One" }, rcnew Text{ "Two" } },
+        rcnew Widget{ role = "context", classes = { "dialog-body" } },
+        rcnew Widget{ classes = { "hotkeyhint" } },
+    };
+}
+
+static void forEachWidget(Widget* widget, const function<void(Widget*)>& fn) {
+    fn(widget);
+    for (const Widget::Ptr& w : *widget) {
+        forEachWidget(w.get(), fn);
+    }
+}
+
+TEST_CASE("Indexed stylesheet matching") {
+    RC<const Stylesheet> ss = Graphene::stylesheet();
+    Widget::Ptr root        = grapheneSample();
+    int count               = 0;
+    // The second pass is served from the cache of matched rules
+    for (int pass = 0; pass < 2; ++pass) {
+        forEachWidget(root.get(), [&](Widget* w) {
+            const bool isRoot = w == root.get();
+            CHECK(fmt::to_string(ss->match(w, isRoot)->rules) ==
+                  fmt::to_string(referenceMatch(*ss, w, isRoot)));
+            ++count;
+        });
+    }
+    CHECK(count > 40);
+
+    // Identical siblings share one result
+    const Widget::Ptr& toolbar = root->widgets().front();
+    CHECK(ss->match(toolbar->widgets()[0].get(), false) == ss->match(toolbar->widgets()[1].get(), false));
+    CHECK(ss->match(toolbar->widgets()[0].get(), false) != ss->match(toolbar->widgets()[2].get(), false));
+}
+
+TEST_CASE("Compiled stylesheet rules") {
+    RC<const Stylesheet> ss = Graphene::stylesheet();
+    Widget::Ptr root        = grapheneSample();
+    forEachWidget(root.get(), [&](Widget* w) {
+        std::shared_ptr<const CompiledRules> compiled = ss->match(w, w == root.get());
+        for (int s = 0; s < +WidgetState::Last * 2; ++s) {
+            const WidgetState state = static_cast<WidgetState>(s);
+            // Applying every rule in order with state checks leaves the last matching rule in effect
+            std::map<const void*, const Rule*> expected;
+            for (const Rule& r : compiled->rules.rules) {
+                if ((state & r.state()) == r.state())
+                    expected[r.id()] = &r;
+            }
+            std::map<const void*, const Rule*> resolved;
+            for (const Rule* r : compiled->resolve(state)) {
+                CHECK(resolved.emplace(r->id(), r).second);
+            }
+            CHECK(resolved == expected);
+        }
+    });
+}
+
+TEST_CASE("Stylesheet benchmark", "[.benchmark]") {
+    RC<const Stylesheet> ss = Graphene::stylesheet();
+    Widget::Ptr root        = rcnew Widget{};
+    for (int i = 0; i < 10'000 / 8; ++i) {
+        root->apply(rcnew Widget{
+            rcnew Button{ rcnew Text{ "OK" } },
+            rcnew CheckBox{ rcnew Text{ "Check" } },
+            rcnew Item{ rcnew Text{ "Item" }, classes = { "flat" } },
+        });
+    }
+    std::vector<Widget*> widgets;
+    forEachWidget(root.get(), [&](Widget* w) {
+        widgets.push_back(w);
+    });
+
+    BENCHMARK("Linear scan") {
+        for (Widget* w : widgets) {
+            referenceMatch(*ss, w, w == root.get());
+        }
+    };
+    BENCHMARK("Indexed") {
+        for (Widget* w : widgets) {
+            ss->match(w, w == root.get());
+        }
+    };
+
+    std::vector<std::shared_ptr<const CompiledRules>> matched;
+    for (Widget* w : widgets) {
+        matched.push_back(ss->match(w, w == root.get()));
+    }
+    BENCHMARK("Restyle, merged rules") {
+        for (size_t i = 0; i < widgets.size(); ++i) {
+            matched[i]->rules.applyTo(widgets[i]);
+        }
+    };
+    BENCHMARK("Restyle, compiled rules") {
+        for (size_t i = 0; i < widgets.size(); ++i) {
+            matched[i]->applyTo(widgets[i]);
+        }
+    };
+}
+
+TEST_CASE("Startup benchmark", "[.benchmark]") {
+    // Every run starts with a new font manager, as a newly launched application does. Embedded fonts are
+    // decompressed once per process, so only the first run includes that
+    static std::recursive_mutex mutex;
+    auto initFonts = [] {
+        fonts.emplace(&mutex, 3, 5000);
+        registerBuiltinFonts(*fonts);
+    };
+    auto firstFrame = [] {
+        Widget::Ptr root = grapheneSample();
+        root->stylesheet = Graphene::stylesheet();
+        HeadlessTree headless(std::move(root), Size{ 800, 600 });
+        headless.frame();
+    };
+
+    // The difference between the two is the cost of the first frame
+    BENCHMARK("Font initialization") {
+        initFonts();
+    };
+    BENCHMARK("Font initialization and first frame") {
+        initFonts();
+        firstFrame();
+    };
+}
+} // namespace Brisk
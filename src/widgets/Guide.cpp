@@ -28,8 +28,9 @@ void Guide::paint(Canvas& canvas_) const {
         return;
     for (auto& f : m_focus) {
         Widget::Ptr w = m_tree->root()->findById(f.id);
-        PointF src    = m_rect.at(f.sourceAnchor);
-        PointF tgt    = w->rect().at(f.targetAnchor);
+        // The line is painted as a layer, in window coordinates
+        PointF src    = windowRect().at(f.sourceAnchor);
+        PointF tgt    = w->windowRect().at(f.targetAnchor);
 
         if (m_tree) {
             m_tree->requestLayer([this, src, tgt](Canvas& canvas_) {
@@ -19,9 +19,86 @@
  * license. For commercial licensing options, please visit: https://brisklib.com
  */
 #include <brisk/widgets/ImageView.hpp>
+#include <brisk/graphics/ImageCache.hpp>
+#include <brisk/core/Log.hpp>
+#include <brisk/core/Threading.hpp>
 
 namespace Brisk {
 
+namespace Internal {
+struct ImageDecodeTask {
+    uint64_t source;
+    RC<const bytes> encoded;
+    Size minSize;
+    std::atomic_bool done{ false };
+    expected<RC<Image>, ImageIOError> result = unexpected(ImageIOError::CodecError);
+};
+} // namespace Internal
+
+// Images are decoded this much larger than the widget, so small resizes don't require another decode
+constexpr static float decodeMargin = 1.25f;
+
+const ImageHandle& ImageView::texture() const noexcept {
+    return m_texture;
+}
+
+void ImageView::onLayoutUpdated() {
+    if (m_decoding) {
+        // A clone may share a decode that its original has started
+        requestAnimationFrame();
+        return;
+    }
+    decodeIfTooSmall();
+}
+
+void ImageView::decodeIfTooSmall() {
+    if (!m_encoded || m_fullSize || !isVisible() || m_rect.area() <= 0)
+        return;
+    const Size size = m_rect.size();
+    if (size.width <= m_decodedFor.width && size.height <= m_decodedFor.height)
+        return;
+    m_decodedFor =
+        Size(int(std::ceil(size.width * decodeMargin)), int(std::ceil(size.height * decodeMargin)));
+    if (RC<Image> cached = imageCache().find(m_source, m_decodedFor, ImageFormat::RGBA)) {
+        setTexture(std::move(cached));
+        return;
+    }
+    m_decoding   = rcnew Internal::ImageDecodeTask{ m_source, m_encoded, m_decodedFor };
+    workerPool().submit([weak = std::weak_ptr(m_decoding)]() {
+        RC<Internal::ImageDecodeTask> task = weak.lock();
+        if (!task)
+            return; // The widget has been destroyed
+        task->result = imageCache().decode(task->source, *task->encoded, task->minSize, ImageFormat::RGBA);
+        task->done.store(true, std::memory_order_release);
+    });
+    requestAnimationFrame();
+}
+
+void ImageView::setTexture(RC<Image> image) {
+    m_texture  = std::move(image);
+    m_fullSize = m_texture->width() < m_decodedFor.width || m_texture->height() < m_decodedFor.height;
+}
+
+void ImageView::onAnimationFrame() {
+    // Frames are requested only while a decode is running
+    if (!m_decoding)
+        return;
+    if (!m_decoding->done.load(std::memory_order_acquire)) {
+        requestAnimationFrame();
+        return;
+    }
+    if (m_decoding->result) {
+        // The task may be shared with clones, each of them takes its own reference
+        setTexture(*m_decoding->result);
+    } else {
+        LOG_WARN(widgets, "ImageView: unable to decode the image");
+        m_encoded = nullptr;
+    }
+    m_decoding = nullptr;
+    // The widget may have grown while the image was being decoded
+    decodeIfTooSmall();
+}
+
 void ImageView::paint(Canvas& canvas) const {
     paintBackground(canvas, m_rect);
     Size size;
@@ -59,4 +136,10 @@ ImageView::ImageView(Construction construction, ImageHandle texture, ArgumentsVi
     : Widget(construction, nullptr), m_texture(std::move(texture)) {
     args.apply(this);
 }
+
+ImageView::ImageView(Construction construction, bytes_view image, ArgumentsView<ImageView> args)
+    : Widget(construction, nullptr), m_encoded(rcnew bytes(image.begin(), image.end())),
+      m_source(imageSourceId(image)) {
+    args.apply(this);
+}
 } // namespace Brisk
@@ -40,7 +40,8 @@ void Item::onEvent(Event& event) {
             checked = !checked;
         }
         onClicked();
-        m_onClick.trigger();
+        if (Internal::WidgetCold* cold = m_cold.get())
+            cold->onClick.trigger();
         if (m_closesPopup) {
             closeNearestPopup();
         }
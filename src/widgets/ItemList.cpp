@@ -20,11 +20,17 @@
  */
 #include <brisk/widgets/ItemList.hpp>
 #include <brisk/widgets/Item.hpp>
+#include <brisk/widgets/VirtualList.hpp>
 
 namespace Brisk {
 
 void ItemList::close(Widget* sender) {
-    if (auto index = indexOf(sender)) {
+    optional<size_t> index;
+    if (VirtualList* list = dynamic_cast<VirtualList*>(sender->parent()))
+        index = list->itemIndex(sender);
+    else
+        index = indexOf(sender);
+    if (index) {
         if (m_onItemClick)
             m_onItemClick(*index);
     }
@@ -50,6 +56,9 @@ void ItemList::append(Widget::Ptr widget) {
     if (Item* it = dynamic_cast<Item*>(widget.get())) {
         it->dynamicFocus = true;
         Base::append(std::move(widget));
+    } else if (dynamic_cast<VirtualList*>(widget.get())) {
+        // Rows of a VirtualList are created by its model
+        Base::append(std::move(widget));
     } else {
         Base::append(new Item{ std::move(widget), dynamicFocus = true });
     }
@@ -121,7 +121,7 @@ void Knob::paint(Canvas& canvas_) const {
 
 Knob::Knob(Construction construction, ArgumentsView<Knob> args) : Base(construction, nullptr) {
     m_tabStop         = true;
-    m_isHintExclusive = true;
+    writableCold().isHintExclusive = true;
     args.apply(this);
 }
 
@@ -27,23 +27,41 @@ void ListBox::onEvent(Event& event) {
 }
 
 void ListBox::onChanged() {
+    if (auto list = virtualList()) {
+        if (m_value >= 0)
+            list->revealItem(std::round(m_value));
+    }
     if (auto selected = findSelected()) {
         selected->isSelected();
     }
 }
 
+std::shared_ptr<VirtualList> ListBox::virtualList() const {
+    for (const Widget::Ptr& w : widgets()) {
+        if (auto list = std::dynamic_pointer_cast<VirtualList>(w))
+            return list;
+    }
+    return nullptr;
+}
+
 std::shared_ptr<Item> ListBox::findSelected() const {
     if (!m_constructed)
         return nullptr;
+    int value = std::round(m_value);
+    if (auto list = virtualList()) {
+        if (value < 0)
+            return nullptr;
+        return std::dynamic_pointer_cast<Item>(list->rowFor(value));
+    }
     auto& widgets = this->widgets();
-    int value     = std::round(m_value);
     if (value < 0 || value >= widgets.size())
         return nullptr;
     return std::dynamic_pointer_cast<Item>(widgets[value]);
 }
 
 void ListBox::append(Widget::Ptr widget) {
-    if (dynamic_cast<Item*>(widget.get()))
+    // A VirtualList supplies its own rows
+    if (dynamic_cast<Item*>(widget.get()) || dynamic_cast<VirtualList*>(widget.get()))
         Base::append(std::move(widget));
     else
         Base::append(new Item{ std::move(widget) });
@@ -59,11 +59,27 @@ Widget::Ptr NotificationView::cloneThis() {
     BRISK_CLONE_IMPLEMENTATION;
 }
 
-void NotificationContainer::onRefresh() {
-    removeIf([](Widget* w) {
+void NotificationContainer::onAnimationFrame() {
+    AutoScrollable::onAnimationFrame();
+    bool pending = false;
+    removeIf([&pending](Widget* w) {
         auto* notification = dynamic_cast<NotificationView*>(w);
-        return notification && notification->expired();
+        if (!notification)
+            return false;
+        if (notification->expired())
+            return true;
+        pending = true;
+        return false;
     });
+    // Keep checking for expiry only while notifications are shown
+    if (pending)
+        requestAnimationFrame();
+}
+
+void NotificationContainer::onVisible() {
+    AutoScrollable::onVisible();
+    // Notifications may have been received before the container was shown
+    requestAnimationFrame();
 }
 
 Widget::Ptr NotificationContainer::cloneThis() {
@@ -72,6 +88,7 @@ Widget::Ptr NotificationContainer::cloneThis() {
 
 void NotificationContainer::receive(RC<NotificationView> view) {
     apply(std::move(view));
+    requestAnimationFrame();
 }
 
 void Notifications::setReceiver(Callback<RC<NotificationView>> receiver) {
@@ -28,10 +28,20 @@ std::shared_ptr<PopupBox> PopupButton::popupBox() const {
 
 void PopupButton::onChildAdded(Widget* w) {
     Button::onChildAdded(w);
-    auto popupBox = this->popupBox();
+    // Subscribe once per popup, not for every child added
+    PopupBox* popupBox = dynamic_cast<PopupBox*>(w);
     if (!popupBox)
         return;
     popupBox->visible = false;
+    toggleState(WidgetState::Selected, false);
+    // Follow the popup's visibility instead of polling it
+    bindings->listen(Value{ &popupBox->visible },
+                     WithLifetime<Callback<bool>>{
+                         [this](bool visible) {
+                             toggleState(WidgetState::Selected, visible);
+                         },
+                         toBindingAddress(this),
+                     });
 }
 
 void PopupButton::onClicked() {
@@ -42,11 +52,6 @@ void PopupButton::onClicked() {
         popupBox->visible = true;
 }
 
-void PopupButton::onRefresh() {
-    auto popupBox = this->popupBox();
-    toggleState(WidgetState::Selected, popupBox && popupBox->visible.get());
-}
-
 void PopupButton::close() {
     auto popupBox = this->popupBox();
     if (!popupBox)
@@ -123,8 +123,8 @@ bool ScrollBox::scrollable() const {
 
 void ScrollBox::revealChild(Widget* child) {
     if (scrollable()) {
-        Rectangle containerRect = m_rect;
-        Rectangle childRect     = child->rect();
+        Rectangle containerRect = windowRect();
+        Rectangle childRect     = child->windowRect();
         int32_t offset          = childRect.p1[+m_orientation] - containerRect.p1[+m_orientation];
         if (offset < 0) {
             setScrollOffset(std::clamp(m_position + offset, 0.f, static_cast<float>(m_scrollSize)));
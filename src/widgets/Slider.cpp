@@ -94,7 +94,7 @@ void Slider::onEvent(Event& event) {
             normalizedValue = std::clamp(newValue, 0.f, 1.f);
             startModifying();
             if (m_hintFormatter)
-                m_hint = m_hintFormatter(m_value);
+                writableCold().hint = m_hintFormatter(m_value);
             event.stopPropagation();
             break;
         case DragEvent::Dropped:
@@ -112,7 +112,7 @@ bool Slider::isHorizontal() const {
 
 Slider::Slider(Construction construction, ArgumentsView<Slider> args) : Base(construction, nullptr) {
     m_tabStop         = true;
-    m_isHintExclusive = true;
+    writableCold().isHintExclusive = true;
     args.apply(this);
 }
 
@@ -19,6 +19,7 @@
  * license. For commercial licensing options, please visit: https://brisklib.com
  */
 #include <brisk/widgets/Table.hpp>
+#include <brisk/widgets/VirtualList.hpp>
 
 namespace Brisk {
 void Table::onEvent(Event& event) {
@@ -29,18 +30,28 @@ void Table::onEvent(Event& event) {
     }
 }
 
+void Table::assignColumns(Widget* row) {
+    int i = 0;
+    for (const Widget::Ptr& w : *row) {
+        if (TableCell* cell = dynamic_cast<TableCell*>(w.get())) {
+            if (!cell->m_widthGroupSet && i < columns.size()) {
+                cell->apply(&columns[i++]);
+                cell->m_widthGroupSet = true;
+            }
+        }
+    }
+}
+
 void Table::childrenAdded() {
     Widget::childrenAdded();
     for (const Widget::Ptr& w1 : *this) {
         if (TableRow* row = dynamic_cast<TableRow*>(w1.get())) {
-            int i = 0;
-            for (const Widget::Ptr& w2 : *row) {
-                if (TableCell* cell = dynamic_cast<TableCell*>(w2.get())) {
-                    if (!cell->m_widthGroupSet && i < columns.size()) {
-                        cell->apply(&columns[i++]);
-                        cell->m_widthGroupSet = true;
-                    }
-                }
+            assignColumns(row);
+        } else if (VirtualList* list = dynamic_cast<VirtualList*>(w1.get())) {
+            // Rows materialized by a VirtualList share the table columns
+            for (const Widget::Ptr& w2 : *list) {
+                if (TableRow* row = dynamic_cast<TableRow*>(w2.get()))
+                    assignColumns(row);
             }
         }
     }
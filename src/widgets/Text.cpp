@@ -45,6 +45,8 @@ void Text::onChanged() {
         font.fontSize = font.fontSize = calcFontSizeFor(m_text);
     }
     if (m_cache.invalidate(CacheKey{ font, m_text })) {
+        m_textSize.invalidate(m_cache.key());
+        ++m_textVersion;
         if (m_textAutoSize == TextAutoSize::None) {
             requestUpdateLayout();
         }
@@ -56,7 +58,7 @@ float Text::calcFontSizeFor(const std::string& m_text) const {
     const float refFontSize = 32.f;
     Font refFont            = font();
     refFont.fontSize        = refFontSize;
-    SizeF sz                = fonts->bounds(refFont, utf8ToUtf32(m_text))
+    SizeF sz                = fonts->measure(refFont, utf8ToUtf32(m_text))
                    .size()
                    .flippedIf(toOrientation(m_rotation) == Orientation::Vertical);
     if (sz.width != 0 && sz.height != 0) {
@@ -85,7 +87,7 @@ SizeF Text::measure(AvailableSize size) const {
     if (m_textAutoSize != TextAutoSize::None) {
         return SizeF{ 1.f, 1.f };
     }
-    SizeF result = m_cache->textSize;
+    SizeF result = m_textSize.value();
     if (toOrientation(m_rotation) == Orientation::Vertical) {
         result = result.flipped();
     }
@@ -102,7 +104,6 @@ void Text::paint(Canvas& canvas) const {
             state.intersectScissors(m_rect);
         RectangleF inner = m_clientRect;
         ColorF color     = m_color.current.multiplyAlpha(m_opacity);
-        auto prerendered = m_cache->prerendered;
 
         if (m_rotation != Rotation::NoRotation) {
             RectangleF rotated = RectangleF{ 0, 0, inner.width(), inner.height() }.flippedIf(
@@ -115,16 +116,28 @@ void Text::paint(Canvas& canvas) const {
                                 .translate(-inner.center().x, -inner.center().y)
                                 .rotate90(-static_cast<int>(m_rotation))
                                 .translate(rotated.center().x, rotated.center().y);
-            prerendered.alignLines(rotated, toFloatAlign(m_textAlign), toFloatAlign(m_textVerticalAlign));
             state->scissors = invm.transform(state->scissors);
-            canvas.raw().drawText(prerendered, fillColor = color, coordMatrix = m);
+            canvas.raw().drawText(preparedText(rotated), fillColor = color, coordMatrix = m);
         } else {
-            prerendered.alignLines(inner, toFloatAlign(m_textAlign), toFloatAlign(m_textVerticalAlign));
-            canvas.raw().drawText(prerendered, fillColor = color);
+            // Moving the widget by whole pixels keeps the cached geometry valid
+            PointF origin{ std::floor(inner.x1), std::floor(inner.y1) };
+            canvas.raw().drawText(preparedText(inner.withOffset(-origin.x, -origin.y)), fillColor = color,
+                                  coordMatrix = Matrix2D::translation(origin.x, origin.y));
         }
     }
 }
 
+const PreparedText& Text::preparedText(RectangleF rect) const {
+    GeometryKey key{ m_textVersion, rect, toFloatAlign(m_textAlign), toFloatAlign(m_textVerticalAlign) };
+    if (!m_geometry || key != m_geometryKey) {
+        PrerenderedText prerendered = m_cache->prerendered;
+        prerendered.alignLines(rect, key.alignX, key.alignY);
+        m_geometry    = prepareText(prerendered);
+        m_geometryKey = key;
+    }
+    return *m_geometry;
+}
+
 optional<std::string> Text::textContent() const {
     return m_text;
 }
@@ -134,10 +147,13 @@ void Text::onFontChanged() {
 }
 
 Text::Cached Text::updateCache(const CacheKey& key) {
-    auto prerendered = fonts->prerender(key.font, key.text);
-    SizeF textSize   = prerendered.bounds().size();
-    textSize         = max(textSize, SizeF{ 0, fonts->metrics(key.font).vertBounds() });
-    return { textSize, std::move(prerendered) };
+    return { fonts->prerender(key.font, key.text) };
+}
+
+SizeF Text::updateTextSize(const CacheKey& key) {
+    // Equal to the bounds of the prerendered text
+    SizeF textSize = fonts->measure(key.font, key.text).size();
+    return max(textSize, SizeF{ 0, fonts->metrics(key.font).vertBounds() });
 }
 
 void BackStrikedText::paint(Canvas& canvas) const {
@@ -145,7 +161,7 @@ void BackStrikedText::paint(Canvas& canvas) const {
                           font(), m_color.current);
     const int p         = 10_idp;
     const float x_align = toFloatAlign(m_textAlign);
-    const int tw        = m_cache->textSize.x;
+    const int tw        = m_textSize->x;
     const Point c       = m_rect.withPadding(tw / 2, 0).at(x_align, 0.5f);
     Rectangle r1{ m_rect.x1 + p, c.y, c.x - tw / 2 - p, c.y + 1_idp };
     Rectangle r2{ c.x + tw / 2 + p, c.y, m_rect.x2 - p, c.y + 1_idp };
@@ -97,14 +97,14 @@ void ValueWidget::startModifying() {
         return;
     m_modifying = true;
     if (m_hintFormatter)
-        m_hint = m_hintFormatter(m_value);
+        writableCold().hint = m_hintFormatter(m_value);
 }
 
 void ValueWidget::stopModifying() {
     if (!m_modifying)
         return;
-    m_modifying = false;
-    m_hint      = {};
+    m_modifying         = false;
+    writableCold().hint = {};
 }
 
 } // namespace Brisk
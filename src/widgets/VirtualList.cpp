@@ -0,0 +1,226 @@
+/*
+ * Brisk
+ *
+ * Cross-platform application framework
+ * --------------------------------------------------------------
+ *
+ * Copyright (C) 2024 Brisk Developers
+ *
+ * This file is part of the Brisk library.
+ *
+ * Brisk is dual-licensed under the GNU General Public License, version 2 (GPL-2.0+),
+ * and a commercial license. You may use, modify, and distribute this software under
+ * the terms of the GPL-2.0+ license if you comply with its conditions.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * If you do not wish to be bound by the GPL-2.0+ license, you must purchase a commercial
+ * license. For commercial licensing options, please visit: https://brisklib.com
+ */
+#include <brisk/widgets/VirtualList.hpp>
+
+namespace Brisk {
+
+VirtualList::VirtualList(Construction construction, Orientation orientation, RC<ListModel> model,
+                         ArgumentsView<VirtualList> args)
+    : ScrollBox(construction, orientation, nullptr), m_model(std::move(model)) {
+    args.apply(this);
+    reset();
+}
+
+Widget::Ptr VirtualList::cloneThis() {
+    BRISK_CLONE_IMPLEMENTATION;
+}
+
+void VirtualList::onModelChanged() {
+    reset();
+}
+
+void VirtualList::reset() {
+    m_offsets.clear();
+    m_uniformExtent = 0;
+    m_count         = m_model ? m_model->count() : 0;
+    if (m_count > 0) {
+        if (m_model->uniformExtent()) {
+            m_uniformExtent = m_model->extent(0);
+        } else {
+            m_offsets.resize(m_count + 1);
+            m_offsets[0] = 0;
+            for (size_t i = 0; i < m_count; ++i) {
+                m_offsets[i + 1] = m_offsets[i] + m_model->extent(i);
+            }
+        }
+    }
+    m_dirty = true;
+    if (m_constructed)
+        onLayoutUpdated();
+}
+
+double VirtualList::itemStart(size_t index) const {
+    if (m_offsets.empty())
+        return index * m_uniformExtent;
+    return m_offsets[std::min(index, m_count)];
+}
+
+size_t VirtualList::itemAt(double position) const {
+    if (m_count == 0 || position <= 0)
+        return 0;
+    if (m_offsets.empty()) {
+        if (m_uniformExtent <= 0)
+            return 0;
+        return std::min(m_count - 1, static_cast<size_t>(position / m_uniformExtent));
+    }
+    auto it = std::upper_bound(m_offsets.begin(), m_offsets.end(), position);
+    return std::min(m_count - 1, static_cast<size_t>(it - m_offsets.begin()) - 1);
+}
+
+void VirtualList::onLayoutUpdated() {
+    auto scrollBar           = this->scrollBar();
+    scrollBar->step          = dp(30);
+    const double contentSize = itemStart(m_count) * pixelRatio();
+    const int availableSize  = m_rect.size()[+m_orientation];
+    if (contentSize > availableSize) {
+        m_scrollSize        = contentSize - availableSize;
+        scrollBar->maximum  = m_scrollSize;
+        scrollBar->pageStep = availableSize;
+        scrollBar->visible  = true;
+    } else {
+        scrollBar->visible  = false;
+        scrollBar->pageStep = 0;
+        scrollBar->maximum  = 0;
+        m_scrollSize        = 0;
+    }
+    if (m_position > m_scrollSize)
+        bindings->assign(m_position, m_scrollSize);
+    updateOffsets();
+}
+
+void VirtualList::updateOffsets() {
+    updateRows();
+    Point p{ 0, 0 };
+    p[+m_orientation] = -static_cast<int>(std::lround(m_position - m_anchor));
+    setChildrenOffset(p);
+}
+
+void VirtualList::placeRow(Widget* row, size_t index, double scale) {
+    const bool h       = m_orientation == Orientation::Horizontal;
+    const float start  = itemStart(index) * scale - m_anchor;
+    const float extent = (itemStart(index + 1) - itemStart(index)) * scale;
+    row->absolutePosition =
+        PointL{ Length(0.f, LengthUnit::DevicePixels), Length(start, LengthUnit::DevicePixels) }.flippedIf(h);
+    row->dimensions = SizeL{ 100_perc, Length(extent, LengthUnit::DevicePixels) }.flippedIf(h);
+}
+
+void VirtualList::updateRows() {
+    const double scale = pixelRatio();
+    size_t first       = 0;
+    size_t last        = 0;
+    if (m_count > 0) {
+        const double position = m_position / scale;
+        const double viewport = m_rect.size()[+m_orientation] / scale;
+        const size_t overscan = std::max(m_overscan, 0);
+        first                 = itemAt(position);
+        last                  = itemAt(position + viewport) + 1;
+        first                 = first > overscan ? first - overscan : 0;
+        last                  = std::min(m_count, last + overscan);
+    }
+    if (!m_dirty && first == m_first && last == m_last)
+        return;
+
+    // Release rows bound to items that have left the range
+    SmallVector<size_t, 16> spare;
+    for (size_t slot = 0; slot < m_slots.size(); ++slot) {
+        const size_t index = m_slots[slot];
+        if (m_dirty || index == unbound || index < first || index >= last) {
+            m_slots[slot] = unbound;
+            spare.push_back(slot);
+        }
+    }
+
+    // Bind items that have entered the range, reusing released rows first
+    m_anchor         = itemStart(first) * scale;
+    size_t nextSpare = 0;
+    for (size_t index = first; index < last; ++index) {
+        if (!m_dirty && index >= m_first && index < m_last)
+            continue;
+        Widget* row;
+        if (nextSpare < spare.size()) {
+            const size_t slot = spare[nextSpare++];
+            row               = widgets()[m_slotsBegin + slot].get();
+            m_slots[slot]     = index;
+        } else {
+            Widget::Ptr newRow = m_model->create();
+            newRow->placement  = Placement::Absolute;
+            if (m_slots.empty())
+                m_slotsBegin = widgets().size();
+            row = newRow.get();
+            m_slots.push_back(index);
+            append(std::move(newRow));
+        }
+        m_model->bind(row, index);
+        row->visible = true;
+    }
+    for (; nextSpare < spare.size(); ++nextSpare) {
+        widgets()[m_slotsBegin + spare[nextSpare]]->visible = false;
+    }
+
+    // The anchor has moved, so every bound row needs a new position
+    for (size_t slot = 0; slot < m_slots.size(); ++slot) {
+        if (m_slots[slot] != unbound)
+            placeRow(widgets()[m_slotsBegin + slot].get(), m_slots[slot], scale);
+    }
+    m_first = first;
+    m_last  = last;
+    m_dirty = false;
+}
+
+void VirtualList::childrenAdded() {
+    Base::childrenAdded();
+    // Rows are logically children of the enclosing widget (a Table assigns column groups to them)
+    if (m_parent)
+        m_parent->childrenAdded();
+}
+
+void VirtualList::scrollToItem(size_t index) {
+    setScrollOffset(std::clamp(static_cast<float>(itemStart(index) * pixelRatio()), 0.f, m_scrollSize));
+}
+
+void VirtualList::revealItem(size_t index) {
+    const double scale   = pixelRatio();
+    const float start    = itemStart(index) * scale;
+    const float end      = itemStart(index + 1) * scale;
+    const float viewport = m_rect.size()[+m_orientation];
+    if (start < m_position)
+        setScrollOffset(std::clamp(start, 0.f, m_scrollSize));
+    else if (end > m_position + viewport)
+        setScrollOffset(std::clamp(end - viewport, 0.f, m_scrollSize));
+}
+
+Widget::Ptr VirtualList::rowFor(size_t index) const {
+    if (m_dirty || index < m_first || index >= m_last)
+        return nullptr;
+    for (size_t slot = 0; slot < m_slots.size(); ++slot) {
+        if (m_slots[slot] == index)
+            return widgets()[m_slotsBegin + slot];
+    }
+    return nullptr;
+}
+
+optional<size_t> VirtualList::itemIndex(const Widget* row) const {
+    for (size_t slot = 0; slot < m_slots.size(); ++slot) {
+        if (m_slots[slot] != unbound && widgets()[m_slotsBegin + slot].get() == row)
+            return m_slots[slot];
+    }
+    return nullopt;
+}
+
+std::pair<size_t, size_t> VirtualList::materializedRange() const noexcept {
+    return { m_first, m_last };
+}
+
+size_t VirtualList::rowCount() const noexcept {
+    return m_slots.size();
+}
+
+} // namespace Brisk
@@ -0,0 +1,158 @@
+/*
+ * Brisk
+ *
+ * Cross-platform application framework
+ * --------------------------------------------------------------
+ *
+ * Copyright (C) 2024 Brisk Developers
+ *
+ * This file is part of the Brisk library.
+ *
+ * Brisk is dual-licensed under the GNU General Public License, version 2 (GPL-2.0+),
+ * and a commercial license. You may use, modify, and distribute this software under
+ * the terms of the GPL-2.0+ license if you comply with its conditions.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ * If you do not wish to be bound by the GPL-2.0+ license, you must purchase a commercial
+ * license. For commercial licensing options, please visit: https://brisklib.com
+ */
+#include <brisk/widgets/VirtualList.hpp>
+#include <brisk/graphics/Palette.hpp>
+#include <catch2/catch_all.hpp>
+#include "Catch2Utils.hpp"
+
+namespace Brisk {
+
+namespace {
+struct VariableModel final : public ListModel {
+    std::map<const Widget*, size_t> bound;
+
+    size_t count() const final {
+        return 1000;
+    }
+
+    float extent(size_t index) const final {
+        return 10 + index % 3 * 5;
+    }
+
+    Widget::Ptr create() final {
+        return rcnew Widget{};
+    }
+
+    void bind(Widget* row, size_t index) final {
+        bound[row] = index;
+    }
+};
+} // namespace
+
+TEST_CASE("VirtualList") {
+    constexpr size_t numItems = 1'000'000;
+    constexpr int rowHeight   = 20;
+    constexpr int listHeight  = 400;
+    std::map<const Widget*, size_t> bound;
+    int created = 0;
+    auto model  = rcnew UniformListModel(
+        numItems, rowHeight,
+        [&]() -> Widget::Ptr {
+            ++created;
+            return rcnew Widget{};
+        },
+        [&](Widget* row, size_t index) {
+            bound[row] = index;
+        });
+    auto list = rcnew VirtualList{ model, dimensions = { 300_px, Length(listHeight) }, overscan = 2 };
+    HeadlessTree headless(list, { 300, listHeight });
+    headless.frame();
+
+    // Viewport rows, one partially visible row and the overscan on both sides
+    constexpr size_t maxRows = listHeight / rowHeight + 1 + 2 * 2;
+
+    auto checkRows = [&](size_t top) {
+        auto [first, last] = list->materializedRange();
+        CHECK(first <= top);
+        CHECK(last - first <= maxRows);
+        CHECK(list->rowCount() <= maxRows);
+        for (size_t i = first; i < last; ++i) {
+            Widget::Ptr row = list->rowFor(i);
+            REQUIRE(row);
+            CHECK(bound[row.get()] == i);
+            CHECK(list->itemIndex(row.get()).value_or(SIZE_MAX) == i);
+            CHECK(row->windowRect().y1 == list->rect().y1 + static_cast<int>(i - top) * rowHeight);
+            CHECK(row->windowRect().height() == rowHeight);
+        }
+    };
+    checkRows(0);
+
+    for (size_t top = 0; top < numItems - listHeight / rowHeight; top += 9973) {
+        list->scrollToItem(top);
+        headless.frame();
+        checkRows(top);
+    }
+    CHECK(created <= maxRows);
+
+    list->scrollToItem(numItems - 1);
+    headless.frame();
+    CHECK(list->materializedRange().second == numItems);
+    CHECK(list->rowFor(numItems - 1)->windowRect().y2 == list->rect().y2);
+
+    model->setCount(10);
+    list->reset();
+    headless.frame();
+    CHECK(list->materializedRange() == std::pair<size_t, size_t>{ 0, 10 });
+    CHECK(list->rowFor(9)->windowRect().y1 == list->rect().y1 + 9 * rowHeight);
+    CHECK(created <= maxRows);
+}
+
+TEST_CASE("VirtualList variable extents") {
+    auto model = rcnew VariableModel();
+    auto list  = rcnew VirtualList{ model, dimensions = { 300_px, 200_px } };
+    HeadlessTree headless(list, { 300, 200 });
+    headless.frame();
+
+    list->scrollToItem(500);
+    headless.frame();
+    int start = 0;
+    for (size_t i = 0; i < 500; ++i)
+        start += model->extent(i);
+    auto [first, last] = list->materializedRange();
+    REQUIRE(first < 500);
+    REQUIRE(last > 500);
+    int y = list->rect().y1 - start;
+    for (size_t i = 0; i < last; ++i) {
+        if (i >= first) {
+            Widget::Ptr row = list->rowFor(i);
+            REQUIRE(row);
+            CHECK(model->bound[row.get()] == i);
+            CHECK(row->windowRect().y1 == y);
+            CHECK(row->windowRect().height() == model->extent(i));
+        }
+        y += model->extent(i);
+    }
+}
+
+TEST_CASE("VirtualList benchmark", "[.benchmark]") {
+    auto model = rcnew UniformListModel(
+        1'000'000, 20.f,
+        []() -> Widget::Ptr {
+            return rcnew Widget{ backgroundColor = Palette::Standard::blue };
+        },
+        [](Widget* row, size_t index) {
+            row->backgroundColor = index % 2 ? Palette::Standard::blue : Palette::Standard::green;
+        });
+    auto list = rcnew VirtualList{ model, dimensions = { 800_px, 600_px } };
+    HeadlessTree headless(list, { 800, 600 });
+    headless.frame();
+
+    size_t top = 0;
+    BENCHMARK("Scroll frame") {
+        top = (top + 7) % 999'000;
+        list->scrollToItem(top);
+        headless.frame();
+    };
+    BENCHMARK("Static frame") {
+        headless.frame();
+    };
+}
+} // namespace Brisk
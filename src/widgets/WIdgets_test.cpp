@@ -19,6 +19,12 @@
  * license. For commercial licensing options, please visit: https://brisklib.com
  */
 #include <brisk/widgets/Text.hpp>
+#include <brisk/widgets/PopupButton.hpp>
+#include <brisk/widgets/PopupBox.hpp>
+#include <brisk/widgets/ScrollBox.hpp>
+#include <brisk/widgets/ImageView.hpp>
+#include <brisk/graphics/ImageCache.hpp>
+#include <brisk/core/Threading.hpp>
 #include <catch2/catch_all.hpp>
 #include "Catch2Utils.hpp"
 
@@ -31,4 +37,353 @@ TEST_CASE("Text") {
 
     CHECK(w->text.get() == "Initialize");
 }
+
+namespace {
+struct AutoSizedText : public Text {
+    using Text::Text;
+
+    float autoFontSize() const {
+        return m_cache.key().font.fontSize;
+    }
+};
+} // namespace
+
+TEST_CASE("Text measurement") {
+    RC<Widget> root = rcnew Widget{ layout = Layout::Horizontal, alignItems = AlignItems::FlexStart };
+
+    RC<Text> label           = rcnew Text{ "Measured label" };
+    RC<AutoSizedText> fitted = rcnew AutoSizedText{
+        "Fitted label text",
+        textAutoSize = TextAutoSize::FitWidth,
+        dimensions   = { 200_px, 100_px },
+    };
+    root->apply(label);
+    root->apply(fitted);
+    HeadlessTree headless(root, { 1000, 500 });
+    headless.frame();
+    headless.frame();
+
+    // Layout measures without prerendering, to the same size as the prerendered text
+    const RectangleF bounds = fonts->bounds(label->font(), "Measured label");
+    CHECK(label->rect().width() == Catch::Approx(bounds.width()).margin(1));
+
+    // The font size is chosen so that the text fills the width
+    Font refFont           = fitted->font();
+    refFont.fontSize       = 32.f;
+    const float refWidth   = fonts->bounds(refFont, "Fitted label text").width();
+    const float fitToWidth = 32.f * fitted->clientRect().width() / refWidth;
+    CHECK(fitted->autoFontSize() == Catch::Approx(std::clamp(fitToWidth, dp(6.f), dp(96.f))).epsilon(0.001));
+}
+
+namespace {
+// Calls of every widget hook that could do per-widget work outside of layout and paint
+int widgetCallbacks = 0;
+
+struct CountingButton : public Button {
+    using Button::Button;
+
+    void onAnimationFrame() override {
+        ++widgetCallbacks;
+        Button::onAnimationFrame();
+    }
+
+    void onLayoutUpdated() override {
+        ++widgetCallbacks;
+        Button::onLayoutUpdated();
+    }
+
+    void onEvent(Event& event) override {
+        ++widgetCallbacks;
+        Button::onEvent(event);
+    }
+
+    void onStateChanged(WidgetState oldState, WidgetState newState) override {
+        ++widgetCallbacks;
+        Button::onStateChanged(oldState, newState);
+    }
+
+    void onFontChanged() override {
+        ++widgetCallbacks;
+        Button::onFontChanged();
+    }
+
+    void onVisible() override {
+        ++widgetCallbacks;
+        Button::onVisible();
+    }
+
+    void onHidden() override {
+        ++widgetCallbacks;
+        Button::onHidden();
+    }
+};
+} // namespace
+
+TEST_CASE("Idle tree refresh") {
+    RC<Widget> root = rcnew Widget{ layout = Layout::Vertical };
+    for (int r = 0; r < 100; ++r) {
+        Widget* row = new Widget{ layout = Layout::Horizontal };
+        for (int c = 0; c < 100; ++c) {
+            row->apply(new CountingButton{ dimensions = { 4_px, 4_px } });
+        }
+        root->apply(row);
+    }
+    RC<PopupBox> popup          = rcnew PopupBox{};
+    RC<PopupButton> popupButton = rcnew PopupButton{ popup };
+    root->apply(popupButton);
+
+    HeadlessTree headless(root, { 1000, 1000 });
+    headless.frame();
+    headless.frame();
+
+    // Nothing changes, so idle frames neither lay out nor call into the widgets
+    widgetCallbacks = 0;
+    for (int i = 0; i < 3; ++i) {
+        headless.frame();
+        CHECK(headless.tree.layoutStats().visited == 0);
+    }
+    CHECK(widgetCallbacks == 0);
+    CHECK(!headless.tree.animations().active());
+
+    // The popup button follows its popup through a subscription
+    CHECK(!popupButton->isSelected());
+    popup->visible = true;
+    CHECK(popupButton->isSelected());
+    popup->visible = false;
+    CHECK(!popupButton->isSelected());
+
+    // Other children don't add subscriptions
+    const size_t handlers = bindings->numHandlers();
+    for (int i = 0; i < 5; ++i) {
+        popupButton->apply(rcnew Widget{});
+    }
+    CHECK(bindings->numHandlers() == handlers);
+}
+
+namespace {
+struct PressRecorder : public Widget {
+    using Widget::Widget;
+    std::vector<PointF> presses;
+
+    void onEvent(Event& event) override {
+        Widget::onEvent(event);
+        if (auto pressed = event.as<EventMouseButtonPressed>())
+            presses.push_back(pressed->point);
+    }
+};
+
+void press(InputQueue& queue, PointF point) {
+    queue.addEvent(
+        EventMouseButtonPressed{ { { { {}, KeyModifiers::None }, point, nullopt }, MouseButton::Left } });
+}
+} // namespace
+
+TEST_CASE("ScrollBox offset transform") {
+    constexpr int rowHeight = 20;
+    RC<VScrollBox> scroll   = rcnew VScrollBox{ dimensions = { 200_px, 400_px } };
+    RC<Widget> content      = rcnew Widget{ layout = Layout::Vertical };
+    std::vector<RC<PressRecorder>> rows;
+    for (int i = 0; i < 100; ++i) {
+        rows.push_back(rcnew PressRecorder{ dimensions = { 200_px, Length(rowHeight) }, tabStop = true });
+        content->apply(rows.back());
+    }
+    scroll->apply(content);
+    HeadlessTree headless(scroll, { 200, 400 });
+    headless.frame();
+    headless.frame();
+    REQUIRE(scroll->scrollable());
+    CHECK(rows[1]->rect().y1 == rowHeight);
+    CHECK(inputQueue->hitTest.get(PointF(10, 25), true) == rows[1]);
+
+    // Scrolling changes neither the rectangles nor the layout of the content
+    scroll->scrollBar()->value = 1000.f;
+    headless.frame();
+    CHECK(headless.tree.layoutStats().visited == 0);
+    CHECK(rows[50]->rect().y1 == 50 * rowHeight);
+    CHECK(rows[50]->windowRect().y1 == 0);
+    CHECK(rows[51]->windowOffset() == Point{ 0, -1000 });
+    CHECK(scroll->scrollBar()->windowOffset() == Point{ 0, 0 });
+
+    // Hit-testing and events use the scrolled position; handlers see their own coordinates
+    CHECK(inputQueue->hitTest.get(PointF(10, 25), true) == rows[51]);
+    press(headless.queue, PointF(10, 25));
+    headless.frame();
+    REQUIRE(rows[51]->presses.size() == 1);
+    CHECK(rows[51]->presses.front() == PointF(10, 1025));
+    CHECK(rows[51]->rect().contains(Point(rows[51]->presses.front())));
+    CHECK(rows[1]->presses.empty());
+
+    // Keyboard focus reveals the row, and the focus frame follows its window rectangle
+    rows[90]->focus(true);
+    headless.frame();
+    headless.frame();
+    CHECK(rows[90]->isKeyFocused());
+    CHECK(rows[90]->rect().y1 == 90 * rowHeight);
+    CHECK(rows[90]->windowRect().y2 == 400);
+    CHECK(inputQueue->hitTest.get(PointF(10, 390), true) == rows[90]);
+
+    rows[0]->focus(true);
+    headless.frame();
+    headless.frame();
+    CHECK(rows[0]->windowRect().y1 == 0);
+    CHECK(inputQueue->hitTest.get(PointF(10, 5), true) == rows[0]);
+}
+
+TEST_CASE("Viewport-aligned popup in a scrolled container") {
+    RC<VScrollBox> scroll = rcnew VScrollBox{ dimensions = { 200_px, 400_px } };
+    RC<Widget> content    = rcnew Widget{ layout = Layout::Vertical };
+    RC<PopupBox> popup    = rcnew PopupBox{ dimensions = { 100_px, 100_px } };
+    for (int i = 0; i < 100; ++i) {
+        RC<Widget> row = rcnew Widget{ dimensions = { 200_px, 20_px } };
+        if (i == 30)
+            row->apply(popup);
+        content->apply(row);
+    }
+    scroll->apply(content);
+    HeadlessTree headless(scroll, { 200, 400 });
+    headless.frame();
+    headless.frame();
+    REQUIRE(scroll->scrollable());
+    // The row is below the viewport, so the popup is kept at its bottom edge
+    CHECK(popup->windowRect().y1 == 300);
+
+    // Once scrolled into view, the popup follows its row
+    scroll->scrollBar()->value = 500.f;
+    headless.frame();
+    CHECK(popup->windowRect().y1 == 100);
+
+    // Scrolled past the row, the popup is kept at the top edge
+    scroll->scrollBar()->value = 1000.f;
+    headless.frame();
+    CHECK(popup->windowRect().y1 == 0);
+}
+
+// Runs frames until the predicate is true or the time runs out
+template <typename Fn>
+static bool framesUntil(HeadlessTree& t, Fn&& fn, double timeout = 10.0) {
+    const double start = currentTime();
+    while (!fn()) {
+        if (currentTime() - start > timeout)
+            return false;
+        t.frame();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+TEST_CASE("ImageView async decode") {
+    const fs::path testdata = fs::path(PROJECT_SOURCE_DIR) / "src" / "graphics" / "testdata";
+    auto jpeg               = readBytes(testdata / "16616460-rgb.jpg");
+    REQUIRE(!!jpeg);
+    auto png = readBytes(testdata / "16616460-rgba.png");
+    REQUIRE(!!png);
+
+    RC<Widget> root      = rcnew Widget{ layout = Layout::Horizontal };
+    RC<ImageView> photo  = rcnew ImageView{ *jpeg, dimensions = { 80_px, 60_px } };
+    RC<ImageView> icon   = rcnew ImageView{ *png, dimensions = { 400_px, 300_px } };
+    RC<ImageView> hidden = rcnew ImageView{ *png, dimensions = { 80_px, 60_px }, visible = false };
+    RC<ImageView> twin   = rcnew ImageView{ *jpeg, dimensions = { 80_px, 60_px } };
+    root->apply(photo);
+    root->apply(icon);
+    root->apply(hidden);
+    root->apply(twin);
+    HeadlessTree t(root, { 1000, 500 });
+
+    // The image is decoded on a worker after layout, the widget paints its background meanwhile
+    REQUIRE(framesUntil(t, [&]() {
+        return photo->texture() && icon->texture() && twin->texture();
+    }));
+    // Scaled to the displayed size plus margin, preserving the aspect ratio
+    CHECK(photo->texture()->size() == Size{ 113, 75 });
+    // Never upscaled
+    CHECK(icon->texture()->size() == Size{ 320, 213 });
+    CHECK(!hidden->texture());
+    // Decoded once and shared through the image cache
+    CHECK(twin->texture() == photo->texture());
+
+    // Growing beyond the decoded size decodes again, the previous texture is shown meanwhile
+    ImageHandle previous = photo->texture();
+    photo->dimensions    = { 160_px, 120_px };
+    t.frame();
+    CHECK(photo->texture());
+    REQUIRE(framesUntil(t, [&]() {
+        return photo->texture() != previous;
+    }));
+    CHECK(photo->texture()->size() == Size{ 225, 150 });
+
+    // Removing widgets with pending decodes is safe
+    for (int i = 0; i < 20; ++i) {
+        root->apply(rcnew ImageView{ *jpeg, dimensions = { 40_px, 30_px } });
+    }
+    t.frame();
+    root->clear();
+    for (int i = 0; i < 5; ++i) {
+        t.frame();
+    }
+}
+
+TEST_CASE("ImageView resized while decoding") {
+    const fs::path testdata = fs::path(PROJECT_SOURCE_DIR) / "src" / "graphics" / "testdata";
+    auto jpeg               = readBytes(testdata / "16616460-rgb.jpg");
+    REQUIRE(!!jpeg);
+    // Images decoded by other tests would be found without a decode
+    imageCache().clear();
+
+    // Keep the workers busy, so the decode stays pending until the widgets have changed
+    const size_t threads = workerPool().threadCount();
+    REQUIRE(threads > 0);
+    std::atomic_size_t started{ 0 };
+    std::atomic_bool release{ false };
+    for (size_t i = 0; i < threads; ++i) {
+        workerPool().submit([&]() {
+            ++started;
+            while (!release)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        });
+    }
+    while (started < threads)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    RC<Widget> root     = rcnew Widget{ layout = Layout::Horizontal };
+    RC<ImageView> photo = rcnew ImageView{ *jpeg, dimensions = { 80_px, 60_px } };
+    root->apply(photo);
+    HeadlessTree t(root, { 1000, 500 });
+    t.frame();
+    // The clone shares the pending decode
+    RC<ImageView> clone = std::dynamic_pointer_cast<ImageView>(photo->clone());
+    REQUIRE(clone);
+    root->apply(clone);
+    photo->dimensions = { 160_px, 120_px };
+    t.frame();
+    CHECK(!photo->texture());
+    release = true;
+
+    // Both widgets receive the shared result, and the grown widget decodes again for its new size
+    REQUIRE(framesUntil(t, [&]() {
+        return clone->texture() && photo->texture() && photo->texture()->size() == Size{ 225, 150 };
+    }));
+    CHECK(clone->texture()->size() == Size{ 113, 75 });
+}
+
+TEST_CASE("ScrollBox benchmark", "[.benchmark]") {
+    RC<VScrollBox> scroll = rcnew VScrollBox{ dimensions = { 200_px, 600_px } };
+    RC<Widget> content    = rcnew Widget{ layout = Layout::Vertical };
+    for (int i = 0; i < 10000; ++i) {
+        content->apply(rcnew Widget{ dimensions = { 200_px, 20_px } });
+    }
+    scroll->apply(content);
+    HeadlessTree headless(scroll, { 200, 600 });
+    headless.frame();
+
+    float position = 0;
+    BENCHMARK("Scroll step in a 10k-child container") {
+        position                   = std::fmod(position + 37.f, 190000.f);
+        scroll->scrollBar()->value = position;
+    };
+    BENCHMARK("Scroll frame in a 10k-child container") {
+        position                   = std::fmod(position + 37.f, 190000.f);
+        scroll->scrollBar()->value = position;
+        headless.frame();
+    };
+}
 } // namespace Brisk